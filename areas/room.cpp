@@ -76,6 +76,7 @@ void Player::addToSameRoom(Creature* target) {
 void Player::finishAddPlayer(BaseRoom* room) {
 
     setFleeing(false);
+    stateChanged(CHANGE_ROOM);
 
     wake("You awaken suddenly!");
     interruptDelayedActions();
@@ -290,6 +291,7 @@ int Player::doDeleteFromRoom(BaseRoom* room, bool delPortal) {
 
     currentLocation.mapmarker.reset();
     currentLocation.room.clear();
+    stateChanged(CHANGE_ROOM);
 
     if(delPortal && flagIsSet(P_PORTAL) && Move::deletePortal(room, getName()))
         i |= DEL_PORTAL_DESTROYED;
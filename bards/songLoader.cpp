@@ -168,6 +168,7 @@ bool Config::loadSongs() {
     );
 
 
+    indexCommands();
     return true;
 }
 
@@ -182,4 +183,5 @@ void Config::clearSongs() {
         }
     }
     songs.clear();
+    indexCommands();
 }
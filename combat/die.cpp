@@ -1376,22 +1376,22 @@ void Player::loseExperience(Monster *killer) {
         // Under level 10, 10% exp loss
         xploss = ((float)experience / 10.0);
         statistics.experienceLost((long)xploss);
-        experience -= (long)xploss;
+        setExperience(experience - (long)xploss);
 
     } else {
         // Level 10 and over, 2% exp loss with a minimum of 10k
         xploss = MAX<long>((long)( (float)experience * 0.02), 10000);
         statistics.experienceLost((long)xploss);
-        experience -= (long)xploss;
+        setExperience(experience - (long)xploss);
     }
     print("You have lost %ld experience.\n", (long)xploss);
     n = level - exp_to_lev(experience);
 
     if(n > 1) {
         if(level < (MAXALVL+2))
-            experience = Config::expNeeded(level-2);
+            setExperience(Config::expNeeded(level-2));
         else
-            experience = (long)((Config::expNeeded(MAXALVL)*(level-2)));
+            setExperience((long)((Config::expNeeded(MAXALVL)*(level-2))));
     }
 
     checkLevel();
@@ -2153,9 +2153,9 @@ void Player::die(DeathType dt) {
 
     if(n > 1) {
         if(level < (MAXALVL+2))
-            experience = Config::expNeeded(level-2);
+            setExperience(Config::expNeeded(level-2));
         else
-            experience = (long)((Config::expNeeded(MAXALVL)*(level-2)));
+            setExperience((long)((Config::expNeeded(MAXALVL)*(level-2))));
     }
 
 
@@ -365,6 +365,7 @@ Creature* Creature::addTarget(Creature* toTarget) {
 
     toTarget->addTargetingThis(this);
     myTarget = toTarget;
+    stateChanged(CHANGE_TARGET);
 
     Player* ply = getAsPlayer();
     if(ply) {
@@ -406,6 +407,7 @@ void Creature::clearTarget(bool clearTargetsList) {
         myTarget->clearTargetingThis(this);
 
     myTarget = nullptr;
+    stateChanged(CHANGE_TARGET);
 }
 
 //*********************************************************************
@@ -0,0 +1,268 @@
+/*
+ * channelIndex.cpp
+ *   Who hears each global channel, and its compiled display format
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <functional>                           // for less
+
+#include <boost/algorithm/string/replace.hpp>   // for replace_all
+
+#include "channelIndex.hpp"         // for ChannelIndex, ChannelFormat, ChannelListener
+#include "communication.hpp"        // for channelInfo
+#include "mudObjects/players.hpp"   // for Player
+#include "proto.hpp"                // for watchingEaves, getCustomColorToken
+#include "socket.hpp"               // for Socket
+
+#define MARKER_IC_NAME      "*IC-NAME*"
+#define MARKER_OOC_NAME     "*OOC-NAME*"
+#define MARKER_TEXT         "*TEXT*"
+
+//*********************************************************************
+//                      ChannelListener
+//*********************************************************************
+
+ChannelListener::ChannelListener(Player* pPlayer): player(pPlayer), name(pPlayer->getName()), effectStamp(~0UL) {
+}
+
+Player* ChannelListener::getPlayer() const {
+    return(player);
+}
+
+const std::string& ChannelListener::getName() const {
+    return(name);
+}
+
+bool ChannelListener::isDeaf() {
+    refresh();
+    return(deaf);
+}
+
+bool ChannelListener::canComprehend() {
+    refresh();
+    return(comprehends);
+}
+
+void ChannelListener::refresh() {
+    if(effectStamp == player->effects.getStamp())
+        return;
+    effectStamp = player->effects.getStamp();
+    deaf = player->isEffected("deafness");
+    comprehends = player->isEffected("comprehend-languages");
+}
+
+//*********************************************************************
+//                      ChannelFormat
+//*********************************************************************
+
+ChannelFormat::ChannelFormat(const channelInfo* chan): format(chan->displayFmt) {
+    color = getCustomColorToken(chan->color);
+
+    // Split in the order the markers used to be replaced, so a format that
+    // runs two markers together comes apart the same way
+    parts.push_back({PART_LITERAL, format});
+    split(MARKER_IC_NAME, PART_IC_NAME);
+    split(MARKER_OOC_NAME, PART_OOC_NAME);
+    split(MARKER_TEXT, PART_TEXT);
+}
+
+void ChannelFormat::split(const std::string& marker, PartType type) {
+    // Replacing a marker never looked inside anything an earlier one put in,
+    // but it could find a marker that a name completed: "*TE" + name + ...
+    // If a literal just before a name ends with the start of this marker,
+    // don't trust the parts.
+    for(size_t i = 0; i + 1 < parts.size(); i++) {
+        if(parts[i].type != PART_LITERAL || parts[i+1].type == PART_LITERAL)
+            continue;
+        const std::string& text = parts[i].text;
+        for(size_t star = text.find('*'); star != std::string::npos; star = text.find('*', star + 1)) {
+            if(text.size() - star < marker.size() && marker.compare(0, text.size() - star, text, star) == 0)
+                compiled = false;
+        }
+    }
+
+    std::vector<Part> result;
+    for(Part& part : parts) {
+        if(part.type != PART_LITERAL) {
+            result.push_back(std::move(part));
+            continue;
+        }
+        size_t start = 0, found;
+        while((found = part.text.find(marker, start)) != std::string::npos) {
+            if(found > start)
+                result.push_back({PART_LITERAL, part.text.substr(start, found - start)});
+            result.push_back({type, ""});
+            start = found + marker.size();
+        }
+        if(start < part.text.size())
+            result.push_back({PART_LITERAL, part.text.substr(start)});
+    }
+    parts.swap(result);
+}
+
+CustomColor ChannelFormat::getColor() const {
+    return(color);
+}
+
+//*********************************************************************
+//                      render
+//*********************************************************************
+
+std::string ChannelFormat::render(const std::string& icName, const std::string& oocName, const std::string& text) const {
+    // A name with a * in it might hold a marker of its own
+    if(!compiled || icName.find('*') != std::string::npos || oocName.find('*') != std::string::npos) {
+        std::string toPrint = format;
+        boost::replace_all(toPrint, MARKER_IC_NAME, icName);
+        boost::replace_all(toPrint, MARKER_OOC_NAME, oocName);
+        boost::replace_all(toPrint, MARKER_TEXT, text);
+        return(toPrint);
+    }
+
+    std::string toPrint;
+    for(const Part& part : parts) {
+        switch(part.type) {
+            case PART_LITERAL:  toPrint += part.text; break;
+            case PART_IC_NAME:  toPrint += icName;    break;
+            case PART_OOC_NAME: toPrint += oocName;   break;
+            case PART_TEXT:     toPrint += text;      break;
+        }
+    }
+    return(toPrint);
+}
+
+//*********************************************************************
+//                      ListenerOrder
+//*********************************************************************
+
+bool ChannelIndex::ListenerOrder::operator()(const ChannelListener* a, const ChannelListener* b) const {
+    if(a->getName() != b->getName())
+        return(a->getName() < b->getName());
+    return(std::less<const ChannelListener*>()(a, b));
+}
+
+//*********************************************************************
+//                      Audience
+//*********************************************************************
+
+bool ChannelIndex::Audience::hears(Player* player) const {
+    Socket* sock = player->getSock();
+    return( (!canHear || canHear(sock)) &&
+            (!flag || player->flagIsSet(flag)) &&
+            (!notFlag || !player->flagIsSet(notFlag)) );
+}
+
+//*********************************************************************
+//                      add
+//*********************************************************************
+
+void ChannelIndex::add(Player* player) {
+    auto it = members.try_emplace(player, player).first;
+    place(&it->second);
+}
+
+//*********************************************************************
+//                      remove
+//*********************************************************************
+
+void ChannelIndex::remove(Player* player) {
+    auto it = members.find(player);
+    if(it == members.end())
+        return;
+    ChannelListener* listener = &it->second;
+    for(Audience& audience : audiences)
+        audience.listeners.erase(listener);
+    eavesdroppers.erase(listener);
+    members.erase(it);
+}
+
+//*********************************************************************
+//                      update
+//*********************************************************************
+
+void ChannelIndex::update(Player* player) {
+    auto it = members.find(player);
+    if(it != members.end())
+        place(&it->second);
+}
+
+//*********************************************************************
+//                      place
+//*********************************************************************
+// Puts a listener in every set they belong in, and takes them out of the rest
+
+void ChannelIndex::place(ChannelListener* listener) {
+    Player* player = listener->getPlayer();
+    Socket* sock = player->getSock();
+    bool connected = sock && sock->isConnected();
+
+    for(Audience& audience : audiences) {
+        if(connected && audience.hears(player))
+            audience.listeners.insert(listener);
+        else
+            audience.listeners.erase(listener);
+    }
+
+    if(connected && watchingEaves(sock))
+        eavesdroppers.insert(listener);
+    else
+        eavesdroppers.erase(listener);
+}
+
+//*********************************************************************
+//                      getAudience
+//*********************************************************************
+
+ChannelIndex::Audience& ChannelIndex::getAudience(const channelInfo* chan) {
+    auto it = channelAudience.find(chan);
+    if(it != channelAudience.end())
+        return(audiences[it->second]);
+
+    for(size_t i = 0; i < audiences.size(); i++) {
+        Audience& audience = audiences[i];
+        if(audience.canHear == chan->canHear && audience.flag == chan->flag && audience.notFlag == chan->not_flag) {
+            channelAudience[chan] = i;
+            return(audience);
+        }
+    }
+
+    // First time anyone's used a channel with these rules
+    channelAudience[chan] = audiences.size();
+    Audience& audience = audiences.emplace_back(Audience{chan->canHear, chan->flag, chan->not_flag, {}});
+    for(auto& [player, listener] : members) {
+        Socket* sock = player->getSock();
+        if(sock && sock->isConnected() && audience.hears(player))
+            audience.listeners.insert(&listener);
+    }
+    return(audience);
+}
+
+const ChannelIndex::ListenerSet& ChannelIndex::getListeners(const channelInfo* chan) {
+    return(getAudience(chan).listeners);
+}
+
+const ChannelIndex::ListenerSet& ChannelIndex::getEavesdroppers() const {
+    return(eavesdroppers);
+}
+
+//*********************************************************************
+//                      getFormat
+//*********************************************************************
+
+const ChannelFormat& ChannelIndex::getFormat(const channelInfo* chan) {
+    auto it = formats.find(chan);
+    if(it == formats.end())
+        it = formats.try_emplace(chan, chan).first;
+    return(it->second);
+}
@@ -24,6 +24,8 @@
 #include <boost/token_functions.hpp>             // for char_separator
 #include <boost/token_iterator.hpp>              // for token_iterator
 #include <boost/tokenizer.hpp>                   // for tokenizer
+#include <algorithm>                             // for max
+#include <chrono>                                // for steady_clock
 #include <cstdio>                                // for snprintf, sprintf
 #include <fstream>                               // for ofstream, operator<<
 #include <iomanip>                               // for operator<<, setw
@@ -34,7 +36,9 @@
 #include <string>                                // for string, allocator
 #include <string_view>                           // for string_view
 #include <utility>                               // for pair
+#include <vector>                                // for vector
 
+#include "allocStats.hpp"                        // for getAllocCount
 #include "cmd.hpp"                               // for cmd, CMD_NOT_UNIQUE
 #include "commands.hpp"                          // for cmdAction, channel
 #include "config.hpp"                            // for Config, PlyCommandSet
@@ -287,6 +291,8 @@ bool Config::initCommands() {
     staffCommands.emplace("*log", 100, dmLog, isCt, "");
     staffCommands.emplace("*list", 100, dmList, isCt, "");
     staffCommands.emplace("*info", 100, dmInfo, isCt, "Show game info (includes some memory).");
+    staffCommands.emplace("*profile", 100, dmProfile, isDm, "Show where the main loop spends its time.");
+    staffCommands.emplace("*cmdstats", 100, dmCmdStats, isDm, "Show what each command costs in time and memory.");
     staffCommands.emplace("*md5", 100, dmMd5, isCt, "Show md5 of input string.");
     staffCommands.emplace("*ids", 100, dmIds, isDm, "Shows registered ids.");
     staffCommands.emplace("*status", 80, dmStat, nullptr, "Show info about a room/player/object/monster.");
@@ -830,6 +836,7 @@ bool Config::initCommands() {
     writeCommandFile(CreatureClass::DUNGEONMASTER, Path::DMHelp, "dmcommands");
     writeCommandFile(CreatureClass::BUILDER, Path::BuilderHelp, "bhcommands");
 
+    indexCommands();
     return (true);
 }
 
@@ -837,6 +844,51 @@ void Config::clearCommands() {
     staffCommands.clear();
     playerCommands.clear();
     generalCommands.clear();
+    indexCommands();
+}
+
+//**********************************************************************
+//                      indexCommands
+//**********************************************************************
+// Rebuilds the prefix tries getCommand, getSpell and getSong resolve against.
+// Must be called whenever one of the command, social, skill, spell or song sets
+// changes, since the tries point into them.
+
+void Config::indexCommands() {
+    commandGeneration++;
+
+    commandTrie.clear();
+    commandTrie.insertAll(COMMAND_GENERAL, generalCommands);
+    commandTrie.insertAll(COMMAND_SKILL, skillCommands);
+    commandTrie.insertAll(COMMAND_PLAYER, playerCommands);
+    commandTrie.insertAll(COMMAND_STAFF, staffCommands);
+    commandTrie.insertAll(COMMAND_SOCIAL, socials);
+
+    spellTrie.clear();
+    spellTrie.insertAll(0, spells);
+
+    songTrie.clear();
+    songTrie.insertAll(0, songs);
+}
+
+unsigned long Config::getCommandGeneration() const {
+    return(commandGeneration);
+}
+
+//**********************************************************************
+//                      getCommandList
+//**********************************************************************
+// Every command a creature can run, for *cmdstats
+
+std::vector<const Command*> Config::getCommandList() const {
+    std::vector<const Command*> list;
+    list.reserve(generalCommands.size() + skillCommands.size() + playerCommands.size() + staffCommands.size() + socials.size());
+    for(const auto& command : generalCommands) list.push_back(&command);
+    for(const auto& command : skillCommands) list.push_back(&command);
+    for(const auto& command : playerCommands) list.push_back(&command);
+    for(const auto& command : staffCommands) list.push_back(&command);
+    for(const auto& command : socials) list.push_back(&command);
+    return(list);
 }
 
 bool MudMethod::exactMatch(const std::string& toMatch) const {
@@ -860,102 +912,32 @@ void MysticMethod::parseName() {
 //                      getCommand
 //*********************************************************************
 
-// bestMethod is a reference to a pointer
-template<class Type, class Type2>
-void examineList(std::set<Type, namableCmp>& mySet, const std::string &str, int& match, bool& found, const Type2*& bestMethod) {
-    if(str.length() == 0)
-        return;
-
-    const Type2* curMethod = nullptr;
-
-    // Narrow down the range of the map we'll be looking at
-    auto it = mySet.lower_bound({str});
-    auto endIt = mySet.upper_bound({std::string(1, char(str.at(0) + 1))});
-
-    while(it != endIt) {
-        curMethod = &(*it++);
-
-        if(curMethod->exactMatch(str)) {
-            // Full match, stop here
-            bestMethod = curMethod;
-            found = true;
-            match = 1;
-            //std::clog << "Found an exact match!\n";
-            break;
-        } else if(curMethod->partialMatch(str)) {
-            // Partial Match, see how good of a match
-            if(bestMethod == nullptr) {
-                // No best match yet, this is our new best match
-                bestMethod = curMethod;
-                match = 1;
-                //std::clog << "First Match: " << bestMethod->getStr() << "'\n";
-            } else {
-                // Already have a best match, compare it to this to see which is better
-
-                // Lower priority always wins
-                if(curMethod->priority < bestMethod->priority) {
-                    // New winner
-                    bestMethod = curMethod;
-                    match = 1;
-                    //std::clog << "New Best Match: " << bestMethod->getStr() << "'\n";
-                } else if(curMethod->priority == bestMethod->priority) {
-                    // Same priority, check % of match
-                    int curLen = curMethod->name.length();
-                    int bestLen = bestMethod->name.length();
-
-                    if(curLen < bestLen) {
-                        // Current command's length is lower, so we match a higher percentage of it.
-                        // It is the new winner
-                        //std::clog << "New Best Match: " << bestMethod->getStr() << "'\n";
-                        bestMethod = curMethod;
-                        match = 1;
-                    } else if(curLen == bestLen) {
-                        // Drats we have a tie
-                        match++;
-                        //std::clog << "Tied!\n";
-                    } else {
-                        // Best command still wins, do nothing
-                    }
-                }
-            }
-        }
-    }
+static int matchToRet(int match) {
+    if(!match)
+        return(CMD_NOT_FOUND);
+    else if(match > 1)
+        return(CMD_NOT_UNIQUE);
+    return(0);
 }
 
 void getCommand(Creature *user, cmd* cmnd) {
-    std::string str = "";
-    // Match - Partial matches
-    int     match=0;
-    // Found - Exact match
-    bool    found=false;
-//  int     i=0;
-
     Player* pUser = user->getAsPlayer();
-    str = cmnd->str[0];
-
-    //std::clog << "Looking for a match for '" << str << "'\n";
-
-    examineList<CrtCommand, Command>(gConfig->generalCommands, str, match, found, cmnd->myCommand);
-    if(!found)
-        examineList<SkillCommand, Command>(gConfig->skillCommands, str, match, found, cmnd->myCommand);
-    // If we're a player, examine a few extra lists
-    if(!found && pUser) {
-        if(!found) // No exact match so far, check player list
-            examineList<PlyCommand, Command>(gConfig->playerCommands, str, match, found, cmnd->myCommand);
-        if(!found && pUser->isStaff()) // Still no exact match, check staff commands
-            examineList<PlyCommand, Command>(gConfig->staffCommands, str, match, found, cmnd->myCommand);
+
+    // Players see a few extra lists; command auth is still checked below
+    CommandTrie::ListMask lists;
+    lists.set(COMMAND_GENERAL).set(COMMAND_SKILL).set(COMMAND_SOCIAL);
+    if(pUser) {
+        lists.set(COMMAND_PLAYER);
+        if(pUser->isStaff())
+            lists.set(COMMAND_STAFF);
     }
-    if(!found)
-        examineList<SocialCommand, Command>(gConfig->socials, str, match, found, cmnd->myCommand);
 
-    if(!match)
-        cmnd->ret = CMD_NOT_FOUND;
-    else if(match > 1)
-        cmnd->ret = CMD_NOT_UNIQUE;
-    else if(cmnd->myCommand->auth && !cmnd->myCommand->auth(user))
+    auto result = gConfig->commandTrie.find(cmnd->str[0], lists);
+    cmnd->myCommand = result.method;
+
+    cmnd->ret = matchToRet(result.match);
+    if(!cmnd->ret && cmnd->myCommand->auth && !cmnd->myCommand->auth(user))
         cmnd->ret = CMD_NOT_AUTH;
-    else
-        cmnd->ret = 0;
 }
 
 
@@ -965,21 +947,9 @@ void getCommand(Creature *user, cmd* cmnd) {
 //*********************************************************************
 
 const Spell *Config::getSpell(const std::string &id, int& ret) {
-    const Spell *toReturn = nullptr;
-    int match = 0;
-    bool found = false;
-
-    examineList<Spell, Spell>(spells, id, match, found, toReturn);
-
-    if(!match)
-        ret = CMD_NOT_FOUND;
-    else if(match > 1)
-        ret = CMD_NOT_UNIQUE;
-    else
-        ret = 0;
-
-
-    return(toReturn);
+    auto result = spellTrie.find(id, 1);
+    ret = matchToRet(result.match);
+    return(result.method);
 }
 
 //*********************************************************************
@@ -987,30 +957,13 @@ const Spell *Config::getSpell(const std::string &id, int& ret) {
 //*********************************************************************
 
 const Song *Config::getSong(const std::string &pName) {
-    const Song *toReturn = nullptr;
-    int match = 0;
-    bool found = false;
-
-    examineList<Song, Song>(songs, pName, match, found, toReturn);
-
-    return(toReturn);
+    return(songTrie.find(pName, 1).method);
 }
 
 const Song *Config::getSong(const std::string &name, int& ret){
-    const Song *toReturn = nullptr;
-    int match = 0;
-    bool found = false;
-
-    examineList<Song, Song>(songs, name, match, found, toReturn);
-
-    if(!match)
-        ret = CMD_NOT_FOUND;
-    else if(match > 1)
-        ret = CMD_NOT_UNIQUE;
-    else
-        ret = 0;
-
-    return(toReturn);
+    auto result = songTrie.find(name, 1);
+    ret = matchToRet(result.match);
+    return(result.method);
 }
 
 //*********************************************************************
@@ -1091,7 +1044,24 @@ int cmdProcess(Creature *user, cmd* cmnd, Creature* pet) {
         return(0);
     }
 
-    cmnd->ret = cmnd->myCommand->execute(user, cmnd);
+    const Command* command = cmnd->myCommand;
+    unsigned long generation = gConfig->getCommandGeneration();
+    AllocCount allocBefore = getAllocCount();
+    auto start = std::chrono::steady_clock::now();
+
+    cmnd->ret = command->execute(user, cmnd);
+
+    // Skip it if the command reloaded the command sets: it's been freed
+    if(generation == gConfig->getCommandGeneration()) {
+        long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        AllocCount allocAfter = getAllocCount();
+        CommandStats& stats = command->stats;
+        stats.calls++;
+        stats.totalTime += elapsed;
+        stats.maxTime = std::max(stats.maxTime, elapsed);
+        stats.bytes += allocAfter.bytes - allocBefore.bytes;
+        stats.allocations += allocAfter.count - allocBefore.count;
+    }
 
     return(cmnd->ret);
 }
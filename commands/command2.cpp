@@ -536,6 +536,7 @@ int cmdBreak(Player* player, cmd* cmnd) {
         object->setName(std::string(item) + object->getName());
 
         strncpy(object->key[2],"broken",20);
+        object->keysChanged();
 
 
         if(object->getType() == ObjectType::CONTAINER) {
@@ -32,6 +32,7 @@
 #include <string_view>                           // for operator<<, string_view
 #include <utility>                               // for pair
 
+#include "channelIndex.hpp"                      // for ChannelIndex, ChannelListener
 #include "clans.hpp"                             // for Clan
 #include "cmd.hpp"                               // for cmd
 #include "color.hpp"                             // for escapeColor
@@ -1040,74 +1041,90 @@ channelPtr getChannelByDiscordChannel(const unsigned long discordChannelID) {
 
 void sendGlobalComm(const Player *player, const std::string &text, const std::string &extra, unsigned int check,
                     const channelInfo *chan, const std::string &etxt, const std::string &oocName, const std::string &icName) {
-    // more complicated checks go here
-    Socket* sock=nullptr;
-    for(const auto& [pId, ply] : gServer->players) {
-        sock = ply->getSock();
-        if(!sock->isConnected())
-            continue;
-
-        // no gagging staff!
-        if(player && ply->isGagging(player->getName()) && !player->isCt())
-            continue;
-        // deaf people can always hear staff and themselves
-        if(ply->isEffected("deafness") && player && !player->isStaff() && ply != player)
-            continue;
+    // only people who satisfy the basic canHear rules are in here
+    const ChannelIndex::ListenerSet& listeners = gServer->channels.getListeners(chan);
+    const ChannelIndex::ListenerSet& eavesdroppers = gServer->channels.getEavesdroppers();
+    const ChannelFormat& format = gServer->channels.getFormat(chan);
+
+    bool eaves = chan->eaves && !(chan->type == COM_CLASS && check == static_cast<int>(CreatureClass::DUNGEONMASTER));
+    // no gagging staff!
+    bool gaggable = player && !player->isCt();
+    // deaf people can always hear staff and themselves
+    bool deafening = player && !player->isStaff();
+
+    // Everyone who sees the same name tags and understands the same way sees the same line
+    std::string lines[2][2];
+    bool rendered[2][2] = {};
+
+    auto hear = [&](ChannelListener* listener) {
+        Player* ply = listener->getPlayer();
+
+        if(gaggable && ply->isGagging(player->getName()))
+            return;
+        if(deafening && ply != player && listener->isDeaf())
+            return;
+        // they must also satisfy any special conditions here
+        if( (chan->type == COM_CLASS && static_cast<int>(ply->getClass()) != check) ||
+            (chan->type == COM_RACE && ply->getDisplayRace() != check) ||
+            (chan->type == COM_CLAN && (ply->getDeity() ? ply->getDeityClan() : ply->getClan()) != check) )
+            return;
+
+        std::string color = format.getColor() != MAX_CUSTOM_COLOR ?
+            ply->getCustomColor(format.getColor(), true) : ply->customColorize(chan->color);
 
-        // must satisfy all the basic canHear rules to hear this channel
-        if( (   (!chan->canHear || chan->canHear(sock)) &&
-                (!chan->flag || ply->flagIsSet(chan->flag)) &&
-                (!chan->not_flag || !ply->flagIsSet(chan->not_flag)) )
-            && ( // they must also satisfy any special conditions here
-                (chan->type != COM_CLASS || static_cast<int>(ply->getClass()) == check) &&
-                (chan->type != COM_RACE || ply->getDisplayRace() == check) &&
-                (chan->type != COM_CLAN || (ply->getDeity() ? ply->getDeityClan() : ply->getClan()) == check) ) )
-        {
-            if(!extra.empty())
-                *ply << ColorOn << ply->customColorize(chan->color) << extra << ColorOff;
+        if(!extra.empty())
+            *ply << ColorOn << color << extra << ColorOff;
 
-            std::string toPrint = chan->displayFmt;
-            std::string prompt;
+        bool prompt = player && boost::icontains(ply->getSock()->getTermType(), "MUDLET");
+        bool understands = ply->isStaff() || !player
+                || (player->current_language && listener->canComprehend())
+                || ply->languageIsKnown(player->current_language);
 
-            if(boost::icontains(ply->getSock()->getTermType(), "MUDLET"))
-                prompt = " PROMPT";
+        std::string& toPrint = lines[prompt][understands];
+        if(!rendered[prompt][understands]) {
+            rendered[prompt][understands] = true;
 
             std::string oocNameRep;
             std::string icNameRep;
 
             if(player) {
-                icNameRep = mxpTag(std::string("player name='") + player->getName() + "'" + prompt) + icName + mxpTag("/player");
-                oocNameRep = mxpTag(std::string("player name='") + player->getName() + "'" + prompt) + oocName + mxpTag("/player");
+                std::string tag = mxpTag(std::string("player name='") + player->getName() + "'" + (prompt ? " PROMPT" : ""));
+                icNameRep = tag + icName + mxpTag("/player");
+                oocNameRep = tag + oocName + mxpTag("/player");
             } else {
                 icNameRep = icName;
                 oocNameRep = oocName;
             }
-            boost::replace_all(toPrint, "*IC-NAME*", icNameRep);
-            boost::replace_all(toPrint, "*OOC-NAME*", oocNameRep);
-
-            if(ply->isStaff() || !player
-                || (player->current_language && ply->isEffected("comprehend-languages"))
-                || ply->languageIsKnown(player->current_language))
-            {
-                // Listern speaks this language
-                boost::replace_all(toPrint, "*TEXT*", text);
-            } else {
-                // Listern doesn't speak this language
-                boost::replace_all(toPrint, "*TEXT*", "<something incomprehensible>");
-            }
 
+            // Listener doesn't speak this language
+            toPrint = format.render(icNameRep, oocNameRep, understands ? text : "<something incomprehensible>");
 
             if(player && player->current_language != LCOMMON)
                 toPrint += std::string(" in ") + get_language_adj(player->current_language) + ".";
-
-            *ply << ColorOn << ply->customColorize(chan->color) << toPrint << "\n" << ColorOff;
         }
 
+        *ply << ColorOn << color << toPrint << "\n" << ColorOff;
+    };
+
+    // Walk both sets together, in name order, so anyone in both gets the message before the eaves line
+    ChannelIndex::ListenerSet::key_compare before;
+    auto listener = listeners.begin();
+    auto eavesdropper = eaves ? eavesdroppers.begin() : eavesdroppers.end();
+    while(listener != listeners.end() || eavesdropper != eavesdroppers.end()) {
+        ChannelListener* next;
+        if(eavesdropper == eavesdroppers.end() || (listener != listeners.end() && !before(*eavesdropper, *listener)))
+            next = *listener;
+        else
+            next = *eavesdropper;
 
+        if(listener != listeners.end() && *listener == next) {
+            hear(next);
+            ++listener;
+        }
         // even if they fail the check, it might still show up on eaves
-        if( chan->eaves && watchingEaves(sock) &&
-            !(chan->type == COM_CLASS && check == static_cast<int>(CreatureClass::DUNGEONMASTER))) {
-            ply->printColor("^E%s", etxt.c_str());
+        if(eavesdropper != eavesdroppers.end() && *eavesdropper == next) {
+            next->getPlayer()->printColor("^E%s", etxt.c_str());
+            ++eavesdropper;
         }
     }
 }
@@ -41,6 +41,7 @@
 
 void Config::clearSocials() {
     socials.clear();
+    indexCommands();
 }
 
 bool SocialCommand::getWakeTarget() const {
@@ -389,6 +389,8 @@ bool Effects::removePoison() {
         } else
             eIt++;
     }
+    if(removed)
+        rebuildEffectBits();
     return(removed);
 }
 
@@ -490,6 +492,8 @@ bool Effects::removeDisease() {
         } else
             eIt++;
     }
+    if(removed)
+        rebuildEffectBits();
     return(removed);
 }
 
@@ -517,6 +521,8 @@ bool Effects::removeCurse() {
         } else
             eIt++;
     }
+    if(removed)
+        rebuildEffectBits();
     return(removed);
 }
 
@@ -771,13 +777,13 @@ bool Creature::sunlightDamage() {
 void Creature::makeWerewolf() {
     addPermEffect("lycanthropy");
     if(!knowsSkill("maul"))
-        skills["maul"] = new Skill("maul", 1);
+        insertSkill(new Skill("maul", 1));
     if(!knowsSkill("frenzy"))
-        skills["frenzy"] = new Skill("frenzy", 1);
+        insertSkill(new Skill("frenzy", 1));
     if(!knowsSkill("howl"))
-        skills["howl"] = new Skill("howl", 1);
+        insertSkill(new Skill("howl", 1));
     if(!knowsSkill("claw"))
-        skills["claw"] = new Skill("claw", level * 5);
+        insertSkill(new Skill("claw", level * 5));
 }
 
 //***********************************************************************
@@ -1419,7 +1419,7 @@ bool Creature::doFlee(bool magicTerror) {
             n = level * 8;
             n = MIN<long>(experience, n);
             print("You lose %d experience for your cowardly retreat.\n", n);
-            experience -= n;
+            setExperience(experience - n);
         }
 
         if(exit->doEffectDamage(this))
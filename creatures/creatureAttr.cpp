@@ -52,12 +52,14 @@
 #include "mudObjects/players.hpp"              // for Player, Player::QuestC...
 #include "mudObjects/rooms.hpp"                // for BaseRoom
 #include "mudObjects/uniqueRooms.hpp"          // for UniqueRoom
+#include "pool.hpp"                            // for TypePool
 #include "proto.hpp"                           // for zero, broadcast, get_c...
 #include "quests.hpp"                          // for QuestCompleted, QuestC...
 #include "raceData.hpp"                        // for RaceData
 #include "range.hpp"                           // for Range
 #include "random.hpp"                          // for Random
 #include "realm.hpp"                           // for Realm, MAX_REALM, MIN_...
+#include "server.hpp"                          // for Server, gServer
 #include "size.hpp"                            // for Size, NO_SIZE, MAX_SIZE
 #include "skills.hpp"                          // for Skill
 #include "specials.hpp"                        // for SpecialAttack
@@ -163,7 +165,10 @@ void Creature::subExperience(unsigned long e) {
 //                      setExperience
 //*********************************************************************
 
-void Creature::setExperience(unsigned long e) { experience = MIN<unsigned long>(2100000000, e); }
+void Creature::setExperience(unsigned long e) {
+    experience = MIN<unsigned long>(2100000000, e);
+    stateChanged(CHANGE_EXPERIENCE);
+}
 
 //*********************************************************************
 //                      setClass
@@ -195,11 +200,18 @@ void Creature::setClass(CreatureClass c) {
     }
 
     cClass = c;
+    if(isPlayer())
+        gServer->channels.update(getAsPlayer());
 }
 
 void Creature::setClan(unsigned short c) { clan = c; }
 
-void Creature::setLevel(unsigned short l, bool isDm) { level = MAX(1, MIN<int>(l, isDm ? 127 : MAXALVL)); }
+void Creature::setLevel(unsigned short l, bool isDm) {
+    level = MAX(1, MIN<int>(l, isDm ? 127 : MAXALVL));
+    // Experience needed and armor absorption both depend on level
+    stateChanged(CHANGE_EXPERIENCE);
+    stateChanged(CHANGE_ARMOR);
+}
 
 void Creature::setAlignment(short a) { alignment = MAX<short>(-1000, MIN<short>(1000, a)); }
 
@@ -207,11 +219,29 @@ void Creature::setAlignment(short a) { alignment = MAX<short>(-1000, MIN<short>(
 void Creature::subAlignment(unsigned short a) { setAlignment(alignment - a); }
 
 
-void Creature::setArmor(unsigned int a) { armor = MAX<int>(MIN(a, MAX_ARMOR), 0); }
+void Creature::setArmor(unsigned int a) {
+    armor = MAX<int>(MIN(a, MAX_ARMOR), 0);
+    stateChanged(CHANGE_ARMOR);
+}
 
 
 void Creature::setAttackPower(unsigned int a) { attackPower = MIN<int>(1500, a); }
 
+//*********************************************************************
+//                      stateChanged
+//*********************************************************************
+
+void Creature::stateChanged(StateChange change) { changes[change]++; }
+
+unsigned long Creature::getChanges(unsigned int mask) const {
+    unsigned long total = 0;
+    for(int i = 0; i < CHANGE_COUNT; i++) {
+        if(mask & CHANGE_MASK(i))
+            total += changes[i];
+    }
+    return(total);
+}
+
 
 void Creature::setDeity(unsigned short d) { deity = MIN<unsigned short>(d, DEITY_COUNT-1); }
 
@@ -382,7 +412,7 @@ void Player::setTickDamage(unsigned short t) { tickDmg = t; }
 void Player::setWarnings(unsigned short w) { warnings = w; }
 void Player::addWarnings(unsigned short w) { setWarnings(w + warnings); }
 void Player::subWarnings(unsigned short w) { setWarnings(w > warnings ? 0 : warnings - w); }
-void Player::setWimpy(unsigned short w) { wimpy = w; }
+void Player::setWimpy(unsigned short w) { wimpy = w; stateChanged(CHANGE_WIMPY); }
 void Player::setActualLevel(unsigned short l) { actual_level = MAX<unsigned short>(1, MIN<unsigned short>(l, MAXALVL)); }
 void Player::setSecondClass(CreatureClass c) { cClass2 = c; }
 void Player::setGuild(unsigned short g) { guild = g; }
@@ -517,6 +547,9 @@ void Creature::crtReset() {
 
     hp.setName("Hp");
     mp.setName("Mp");
+    hp.watchChanges(&changes[CHANGE_HEALTH]);
+    mp.watchChanges(&changes[CHANGE_MANA]);
+    coins.watchChanges(&changes[CHANGE_MONEY]);
 
     if(getAsPlayer()) {
         getAsPlayer()->focus.setName("Focus");
@@ -616,6 +649,7 @@ void Player::reset() {
     barkskin = 0;
     weaponTrains = 0;
     bank.zero();
+    bank.watchChanges(&changes[CHANGE_BANK]);
     created = 0;
 
     oldCreated = surname = lastCommand = lastCommunicate = password = title = tempTitle = "";
@@ -771,7 +805,7 @@ void Creature::CopyCommon(const Creature& cr) {
         crSkill = (*csIt).second;
         skill = new Skill;
         (*skill) = (*crSkill);
-        skills[crSkill->getName()] = skill;
+        insertSkill(skill);
     }
 
     effects.copy(&cr.effects, this);
@@ -1074,13 +1108,7 @@ void Creature::crtDestroy() {
 
     factions.clear();
 
-    Skill* skill;
-    std::map<std::string, Skill*>::iterator csIt;
-    for(csIt = skills.begin() ; csIt != skills.end() ; csIt++) {
-        skill = (*csIt).second;
-        delete skill;
-    }
-    skills.clear();
+    clearSkills();
 
     effects.removeAll();
     minions.clear();
@@ -1114,6 +1142,23 @@ Monster::~Monster() {
     }
 }
 
+//*********************************************************************
+//                      operator new / delete
+//*********************************************************************
+
+static TypePool* getMonsterPool() {
+    static TypePool* pool = TypePool::getPool("Monster", sizeof(Monster));
+    return(pool);
+}
+
+void* Monster::operator new(std::size_t size) {
+    return(getMonsterPool()->allocate(size));
+}
+
+void Monster::operator delete(void* ptr, std::size_t size) {
+    getMonsterPool()->deallocate(ptr, size);
+}
+
 //*********************************************************************
 //                      Player
 //*********************************************************************
@@ -1122,6 +1167,9 @@ Player::~Player() {
     crtDestroy();
     int i = 0;
 
+    // Should already be gone with gServer->clearPlayer, but never leave it pointing at us
+    gServer->channels.remove(this);
+
     if(birthday) {
         delete birthday;
         birthday = nullptr;
@@ -1140,6 +1188,7 @@ Player::~Player() {
     for(auto qc : questsCompleted) {
         delete qc.second;
     }
+    delete questIndex;
 
     questsInProgress.clear();
     questsCompleted.clear();
@@ -1224,9 +1273,12 @@ bool Creature::mFlagIsSet(int flag) const {
 //*********************************************************************
 
 void Creature::setFlag(int flag) {
+    bool changed = !flagIsSet(flag);
     flags[flag/8] |= 1<<(flag%8);
     if(flag == P_NO_TRACK_STATS && isPlayer())
         getAsPlayer()->statistics.track = false;
+    if(changed && isPlayer())
+        gServer->channels.update(getAsPlayer());
 }
 void Creature::pSetFlag(int flag) {
     if(!isPlayer()) return;
@@ -1243,9 +1295,12 @@ void Creature::mSetFlag(int flag) {
 //*********************************************************************
 
 void Creature::clearFlag(int flag) {
+    bool changed = flagIsSet(flag);
     flags[flag/8] &= ~(1<<(flag%8));
     if(flag == P_NO_TRACK_STATS && isPlayer())
         getAsPlayer()->statistics.track = true;
+    if(changed && isPlayer())
+        gServer->channels.update(getAsPlayer());
 }
 
 void Creature::pClearFlag(int flag) {
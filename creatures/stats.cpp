@@ -19,7 +19,9 @@
 #include <fmt/format.h>              // for format
 #include <cmath>                     // for ceil, floor, round
 #include <ctime>                     // for time
-#include <map>                       // for allocator, operator==, _Rb_tree_...
+#include <algorithm>                 // for sort
+#include <deque>                     // for deque
+#include <unordered_map>             // for unordered_map
 #include <ostream>                   // for operator<<, basic_ostream, char_...
 #include <string>                    // for operator==, string, basic_string
 #include <string_view>               // for operator==, string_view, basic_s...
@@ -44,14 +46,63 @@
 //#####################################################################
 // Stat Modifier
 //#####################################################################
+
+//*********************************************************************
+//                      modifier ids
+//*********************************************************************
+
+namespace {
+    struct ModifierRegistry {
+        std::deque<std::string> names;
+        std::unordered_map<std::string_view, ModifierId> ids;
+
+        ModifierRegistry() {
+            // Must match the order of the MODIFIER_ enum
+            for(std::string_view builtIn : { "CurModifier", "DmSet", "Rounding", "ConBonus", "IntBonus" })
+                intern(builtIn);
+        }
+        ModifierId intern(std::string_view pName) {
+            auto it = ids.find(pName);
+            if(it != ids.end())
+                return(it->second);
+            auto newId = (ModifierId)names.size();
+            // deque never moves its elements, so the view stays valid
+            ids.emplace(names.emplace_back(pName), newId);
+            return(newId);
+        }
+    };
+
+    ModifierRegistry& modifierRegistry() {
+        static ModifierRegistry registry;
+        return(registry);
+    }
+}
+
+ModifierId StatModifier::getModifierId(std::string_view pName) {
+    return(modifierRegistry().intern(pName));
+}
+
+const std::string& StatModifier::getModifierName(ModifierId pId) {
+    return(modifierRegistry().names.at(pId));
+}
+
 StatModifier::StatModifier() {
     name = "none";
+    id = getModifierId(name);
     modAmt = 0;
     modType = MOD_NONE;
 }
 
 StatModifier::StatModifier(std::string_view pName, int pModAmt, ModifierType pModType) {
     name = pName;
+    id = getModifierId(name);
+    modAmt = pModAmt;
+    modType = pModType;
+}
+
+StatModifier::StatModifier(ModifierId pId, int pModAmt, ModifierType pModType) {
+    name = getModifierName(pId);
+    id = pId;
     modAmt = pModAmt;
     modType = pModType;
 }
@@ -70,6 +121,9 @@ void StatModifier::setType(ModifierType newType) {
 std::string StatModifier::getName() {
     return(name);
 }
+ModifierId StatModifier::getId() const {
+    return(id);
+}
 int StatModifier::getModAmt() {
     return(modAmt);
 }
@@ -103,19 +157,25 @@ double getIntBonusPercentage(unsigned int pInt) {
 void Stat::reCalc() {
     if(!dirty) return;
 
+    // Hp and Mp get a bonus from con/int on top of everything else; leave it
+    // out of the sum and work it out again below
+    ModifierId bonusId = MODIFIER_BUILTIN_COUNT;
     if(influencedBy) {
-        if(name == "Hp")
-            setModifier("ConBonus", 0, MOD_MAX);
-        else if(name == "Mp")
-            setModifier("IntBonus", 0, MOD_MAX);
+        if(type == STAT_HP)
+            bonusId = MODIFIER_CON_BONUS;
+        else if(type == STAT_MP)
+            bonusId = MODIFIER_INT_BONUS;
     }
 
     cur = initial;
     max = initial;
+    int rounding = 0;
+
+    for(StatModifier* mod : modifiers) {
+        ModifierId modId = mod->getId();
+        if(modId == bonusId) continue;
+        if(modId == MODIFIER_ROUNDING) rounding = mod->getModAmt();
 
-    for(const ModifierMap::value_type& p : modifiers) {
-        StatModifier *mod = p.second;
-        if(!mod) continue;
         switch(mod->getModType()) {
         case MOD_MAX:
             max += mod->getModAmt();
@@ -132,40 +192,40 @@ void Stat::reCalc() {
         }
     }
 
+    if(bonusId != MODIFIER_BUILTIN_COUNT) {
+        double percentage = type == STAT_HP ?
+            getConBonusPercentage(influencedBy->getCur()) :
+            getIntBonusPercentage(influencedBy->getCur());
+        int bonus = (int)((double)(max-rounding) * percentage);
+        setModifier(bonusId, bonus, MOD_MAX);
 
-    if(influencedBy && name == "Hp") {
-        double percentage = getConBonusPercentage(influencedBy->getCur());
-        int rounding = this->getModifierAmt("Rounding");
-        int conBonus = (int)((double)(max-rounding) * percentage);
-        setModifier("ConBonus", conBonus, MOD_MAX);
-
-        max += conBonus;
-    }
-    if(influencedBy && name == "Mp") {
-        double percentage = getIntBonusPercentage(influencedBy->getCur());
-        int rounding = this->getModifierAmt("Rounding");
-        int intBonus = (int)((double)(max-rounding) * percentage);
-        setModifier("IntBonus", intBonus, MOD_MAX);
-
-        max += intBonus;
+        max += bonus;
     }
 
     if(cur > max) {
-        adjustModifier("CurModifier", max - cur);
+        adjustModifier(MODIFIER_CUR, max - cur);
         cur -= (cur - max);
     }
     dirty = false;
 }
+StatModifier* Stat::getModifier(ModifierId pId) {
+    for(StatModifier* mod : modifiers) {
+        if(mod->getId() == pId)
+            return(mod);
+    }
+    return(nullptr);
+}
 StatModifier* Stat::getModifier(const std::string &pName) {
-    auto it = modifiers.find(pName);
-    if(it == modifiers.end()) return(nullptr);
-    else                      return(it->second);
+    return(getModifier(StatModifier::getModifierId(pName)));
 }
-int Stat::getModifierAmt(const std::string &pName) {
-    StatModifier* mod = getModifier(pName);
+int Stat::getModifierAmt(ModifierId pId) {
+    StatModifier* mod = getModifier(pId);
     if(mod) return(mod->getModAmt());
     else    return(0);
 }
+int Stat::getModifierAmt(const std::string &pName) {
+    return(getModifierAmt(StatModifier::getModifierId(pName)));
+}
 Stat* Creature::getStat(std::string_view statName) {
     if     (statName == "strength")            return(&strength);
     else if(statName == "dexterity")           return(&dexterity);
@@ -208,17 +268,18 @@ bool Creature::setStatDirty(std::string_view statName) {
 bool Stat::addModifier(StatModifier* toAdd) {
     if(!toAdd) return(false);
 
-    if(getModifier(toAdd->getName()) != nullptr) {
+    if(getModifier(toAdd->getId()) != nullptr) {
         std::clog << "Not adding modifer " << toAdd->getName() << std::endl;
         delete toAdd;
         return(false);
     }
-    modifiers.insert(ModifierMap::value_type(toAdd->getName(), toAdd));
+    modifiers.push_back(toAdd);
     setDirty();
     return(true);
 }
 void Stat::setDirty() {
     dirty = true;
+    changes.changed();
     if(influences) influences->setDirty();
 }
 bool Stat::addModifier(const std::string &pName, int modAmt, ModifierType modType) {
@@ -226,48 +287,56 @@ bool Stat::addModifier(const std::string &pName, int modAmt, ModifierType modTyp
     return(addModifier(new StatModifier(pName, modAmt, modType)));
 }
 
+bool Stat::removeModifier(ModifierId pId) {
+    for(auto it = modifiers.begin() ; it != modifiers.end() ; it++) {
+        if((*it)->getId() != pId)
+            continue;
+        delete *it;
+        modifiers.erase(it);
+        setDirty();
+        return(true);
+    }
+    return(false);
+}
 bool Stat::removeModifier(const std::string &pName) {
-    auto it = modifiers.find(pName);
-    if(it == modifiers.end()) return(false);
-
-    delete it->second;
-    modifiers.erase(it);
-    setDirty();
-    return(true);
+    return(removeModifier(StatModifier::getModifierId(pName)));
 }
 void Stat::clearModifiers() {
-    auto it = modifiers.begin();
-
-    while(it != modifiers.end()) {
-        delete it->second;
-        modifiers.erase(it++);
-    }
+    for(StatModifier* mod : modifiers)
+        delete mod;
+    modifiers.clear();
 }
-bool Stat::adjustModifier(const std::string &pName, int modAmt, ModifierType modType) {
-    StatModifier* mod = getModifier(pName);
+bool Stat::adjustModifier(ModifierId pId, int modAmt, ModifierType modType) {
+    StatModifier* mod = getModifier(pId);
     if(!mod) {
         if(modAmt == 0) return(true);
-        mod = new StatModifier(pName, 0, modType);
-        modifiers.insert(ModifierMap::value_type(pName, mod));
+        mod = new StatModifier(pId, 0, modType);
+        modifiers.push_back(mod);
     }
     mod->adjust(modAmt);
 
-    if(mod->getModAmt() == 0) return(removeModifier(pName));
+    if(mod->getModAmt() == 0) return(removeModifier(pId));
     else mod->setType(modType);
 
     setDirty();
     return(true);
 }
+bool Stat::adjustModifier(const std::string &pName, int modAmt, ModifierType modType) {
+    return(adjustModifier(StatModifier::getModifierId(pName), modAmt, modType));
+}
 
-bool Stat::setModifier(const std::string &pName, int newAmt, ModifierType modType) {
-    StatModifier* mod = getModifier(pName);
+bool Stat::setModifier(ModifierId pId, int newAmt, ModifierType modType) {
+    StatModifier* mod = getModifier(pId);
     if(newAmt == 0) {
         if(!mod) return(true);
-        else return(removeModifier(pName));
+        else return(removeModifier(pId));
     }
     if(!mod) {
-        mod = new StatModifier(pName, 0, modType);
-        modifiers.insert(ModifierMap::value_type(pName, mod));
+        mod = new StatModifier(pId, 0, modType);
+        modifiers.push_back(mod);
+    } else if(mod->getModAmt() == newAmt && mod->getModType() == modType) {
+        // reCalc sets the con/int bonus every time; nothing changed, so nothing to redo
+        return(true);
     }
     mod->set(newAmt);
     mod->setType(modType);
@@ -275,11 +344,29 @@ bool Stat::setModifier(const std::string &pName, int newAmt, ModifierType modTyp
     return(true);
 
 }
+bool Stat::setModifier(const std::string &pName, int newAmt, ModifierType modType) {
+    return(setModifier(StatModifier::getModifierId(pName), newAmt, modType));
+}
+
+//*********************************************************************
+//                      getSortedModifiers
+//*********************************************************************
+// Modifiers in name order, for anything a person or a file will see
+
+StatModifierList Stat::getSortedModifiers() const {
+    StatModifierList sorted = modifiers;
+    alphanum_less<std::string> less;
+    std::sort(sorted.begin(), sorted.end(), [&less](StatModifier* a, StatModifier* b) {
+        return(less(a->getName(), b->getName()));
+    });
+    return(sorted);
+}
 
 //*********************************************************************
 //                      Stat
 //*********************************************************************
 Stat::Stat() {
+     type = STAT_NONE;
      cur = max = initial = 0;
      dirty = true;
      influences = influencedBy = nullptr;
@@ -287,6 +374,7 @@ Stat::Stat() {
 
 StatModifier::StatModifier(StatModifier &sm) {
     name = sm.name;
+    id = sm.id;
     modAmt = sm.modAmt;
     modType = sm.modType;
 }
@@ -298,30 +386,38 @@ Stat& Stat::operator=(const Stat& st) {
     return(*this);
 }
 void Stat::doCopy(const Stat& st) {
-    StatModifier* mod = nullptr;
-    for(const ModifierMap::value_type& p : st.modifiers) {
-        mod = new StatModifier();
-        (*mod) = (*p.second);
-        modifiers.insert(ModifierMap::value_type(mod->getName(), mod));
-    }
+    for(StatModifier* mod : st.modifiers)
+        modifiers.push_back(new StatModifier(*mod));
     name = st.name;
+    type = st.type;
     cur = st.cur;
     max = st.max;
     initial = st.initial;
     dirty = st.dirty;
     influences = nullptr;
     influencedBy = nullptr;
+    changes.changed();
 }
 
 Stat::~Stat() {
-    for(const ModifierMap::value_type& p : modifiers) {
-        delete p.second;
-    }
-    modifiers.clear();
+    clearModifiers();
 }
 
 void Stat::setName(std::string_view pName) {
     name = pName;
+    if(name == "Strength")           type = STAT_STRENGTH;
+    else if(name == "Dexterity")     type = STAT_DEXTERITY;
+    else if(name == "Constitution")  type = STAT_CONSTITUTION;
+    else if(name == "Intelligence")  type = STAT_INTELLIGENCE;
+    else if(name == "Piety")         type = STAT_PIETY;
+    else if(name == "Hp")            type = STAT_HP;
+    else if(name == "Mp")            type = STAT_MP;
+    else if(name == "Focus")         type = STAT_FOCUS;
+    else                             type = STAT_NONE;
+}
+
+StatType Stat::getType() const {
+    return(type);
 }
 
 //*********************************************************************
@@ -341,7 +437,7 @@ unsigned int Stat::adjust(int amt) {
 unsigned int Stat::increase(unsigned int amt) {
     int increaseAmt = MAX<int>(0, MIN(amt, getMax() - getCur()));
         
-    adjustModifier("CurModifier", increaseAmt);
+    adjustModifier(MODIFIER_CUR, increaseAmt);
     
     return(increaseAmt);
 }
@@ -354,7 +450,7 @@ unsigned int Stat::increase(unsigned int amt) {
 unsigned int Stat::decrease(unsigned int amt) {
     int decreaseAmt = MIN(amt, getCur());
     
-    adjustModifier("CurModifier", -decreaseAmt);
+    adjustModifier(MODIFIER_CUR, -decreaseAmt);
     
     return(decreaseAmt);
 }
@@ -399,24 +495,20 @@ double round(double r) {
 void Stat::setMax(unsigned int newMax, bool allowZero) {
     newMax = MAX<int>(allowZero ? 0 : 1, MIN<int>(newMax, 30000));
 
-    int dmSet = getModifierAmt("DmSet");
-    int rounding = getModifierAmt("Rounding");
+    int dmSet = getModifierAmt(MODIFIER_DM_SET);
+    int rounding = getModifierAmt(MODIFIER_ROUNDING);
     int adjustment = 0;
-    bool setHp = false, setMp = false;
-    if(name == "Hp")
-        setHp = true;
-    else if(name == "Mp")
-        setMp = true;
+    bool setHp = type == STAT_HP, setMp = type == STAT_MP;
 
     if((setHp || setMp) && influencedBy) {
         double percentage =  0;
         int bonus = 0;
         if(setHp) {
-            bonus = getModifierAmt("ConBonus");
+            bonus = getModifierAmt(MODIFIER_CON_BONUS);
             percentage = getConBonusPercentage(influencedBy->getCur());
         }
         if(setMp) {
-            bonus = getModifierAmt("IntBonus");
+            bonus = getModifierAmt(MODIFIER_INT_BONUS);
             percentage = getIntBonusPercentage(influencedBy->getCur());
         }
 
@@ -433,18 +525,18 @@ void Stat::setMax(unsigned int newMax, bool allowZero) {
         // Calculated max based on new adjustment, without any rounding modifier
         int adjMax = (int)((curMax + adjustment) * (1.0+percentage));
 
-        this->setModifier("DmSet", adjustment, MOD_MAX);
+        this->setModifier(MODIFIER_DM_SET, adjustment, MOD_MAX);
 
         // Due to rounding with doubles we might miss the target by 1, this will adjust it
         if(adjMax != newMax) {
-            setModifier("Rounding", newMax - adjMax, MOD_MAX);
+            setModifier(MODIFIER_ROUNDING, newMax - adjMax, MOD_MAX);
         } else {
-            setModifier("Rounding", 0, MOD_MAX);
+            setModifier(MODIFIER_ROUNDING, 0, MOD_MAX);
         }
     } else {
         unsigned int curMax = getMax() - dmSet;
         adjustment = (int)newMax - (int)curMax;
-        this->setModifier("DmSet", adjustment, MOD_MAX);
+        this->setModifier(MODIFIER_DM_SET, adjustment, MOD_MAX);
     }
 
 
@@ -457,7 +549,7 @@ void Stat::setMax(unsigned int newMax, bool allowZero) {
 void Stat::setCur(unsigned int newCur) {
     newCur = MIN(newCur, getMax());
     int modCur = (int)newCur - (int)getCur();
-    adjustModifier("CurModifier", modCur);
+    adjustModifier(MODIFIER_CUR, modCur);
 }
 
 void Stat::setInfluences(Stat* pInfluences) {
@@ -466,6 +558,9 @@ void Stat::setInfluences(Stat* pInfluences) {
 void Stat::setInfluencedBy(Stat* pInfluencedBy) {
     influencedBy = pInfluencedBy;
 }
+void Stat::watchChanges(unsigned long* counter) {
+    changes.watch(counter);
+}
 
 std::ostream& operator<<(std::ostream& out, Stat& stat) {
     out << stat.toString();
@@ -477,8 +572,7 @@ std::string Stat::toString() {
 
     oStr << "^C" << name << ": ^c" << getCur() << "/" << getMax() << "(" << getInitial() << ")\n";
     int i = 1;
-    for(const ModifierMap::value_type& p : modifiers) {
-        StatModifier* mod = p.second;
+    for(StatModifier* mod : getSortedModifiers()) {
         oStr << "\t" << i++ << ") ";
         oStr << "^C" << mod->getName() << "^c ";
         switch(mod->getModType()) {
@@ -73,7 +73,7 @@ bool Money::isZero() const {
 //                      zero
 //*********************************************************************
 
-void Money::zero() { ::zero(m, sizeof(m)); }
+void Money::zero() { ::zero(m, sizeof(m)); changes.changed(); }
 
 //*********************************************************************
 //                      operators
@@ -124,13 +124,25 @@ void Money::sub(Money mn) {
 //                      set
 //*********************************************************************
 
-void Money::set(unsigned long n, Coin c) { m[c] = MIN(2000000000UL, n); }
+void Money::set(unsigned long n, Coin c) {
+    n = MIN(2000000000UL, n);
+    if(m[c] != n) {
+        m[c] = n;
+        changes.changed();
+    }
+}
 
 void Money::set(Money mn) {
     for(Coin i = MIN_COINS; i < MAX_COINS; i = (Coin)((int)i + 1))
         set(mn[i], i);
 }
 
+//*********************************************************************
+//                      watchChanges
+//*********************************************************************
+
+void Money::watchChanges(unsigned long* counter) { changes.watch(counter); }
+
 //*********************************************************************
 //                      str
 //*********************************************************************
@@ -52,6 +52,7 @@
 #include "mudObjects/players.hpp"                   // for Player
 #include "mudObjects/rooms.hpp"                     // for BaseRoom, ExitList
 #include "os.hpp"                                   // for ASSERTLOG
+#include "pool.hpp"                                 // for TypePool
 #include "proto.hpp"                                // for broadcast, timeStr
 #include "pythonHandler.hpp"                        // for PythonHandler
 #include "raceData.hpp"                             // for RaceData
@@ -123,6 +124,18 @@ bool Config::effectExists(const std::string &eName) {
     return(effects.find(eName) != effects.end());
 }
 
+//*********************************************************************
+//                      getEffectId
+//*********************************************************************
+// Returns -1 if no effect or base effect has this name
+
+int Config::getEffectId(std::string_view eName) const {
+    auto it = effectIds.find(eName);
+    if(it == effectIds.end())
+        return(-1);
+    return(it->second);
+}
+
 //*********************************************************************
 //                      dmEffectList
 //*********************************************************************
@@ -254,12 +267,97 @@ bool EffectInfo::updateLastMod(time_t t) {
 
 bool EffectInfo::timeForPulse(time_t t) {
     time_t diff = t - lastPulse;
-    if(diff < myEffect->getPulseDelay())
+    if(diff < getPulseDelay())
         return(false);
 
     lastPulse = t;
     return(true);
 }
+
+//*********************************************************************
+//                      getPulseDelay
+//*********************************************************************
+
+int EffectInfo::getPulseDelay() const {
+    if(myParent && !myParent->getAsConstCreature())
+        return(MAX<int>(EFFECT_ROOM_PULSE_DELAY, myEffect->getPulseDelay()));
+    return(myEffect->getPulseDelay());
+}
+
+//*********************************************************************
+//                      getNextDue
+//*********************************************************************
+// When this effect next needs to be pulsed, either to wear off or to
+// run its pulse script
+
+time_t EffectInfo::getNextDue() const {
+    if(!myEffect)
+        return(0);
+
+    // object appliers keep their duration in sync with the effect every second
+    if(myApplier && myApplier->getAsConstObject())
+        return(lastMod + 1);
+
+    time_t due = 0;
+    if(duration != -1)
+        due = lastMod + MAX<long>(0, duration);
+    if(myEffect->isPulsed()) {
+        time_t nextPulse = lastPulse + getPulseDelay();
+        if(!due || nextPulse < due)
+            due = nextPulse;
+    }
+    return(due);
+}
+
+//*********************************************************************
+//                      schedule
+//*********************************************************************
+
+void EffectInfo::schedule(time_t notBefore) {
+    unschedule();
+    if(!myEffect || !myParent)
+        return;
+    // objects never pulse their effects
+    if(!myParent->getAsConstCreature() && !myParent->getAsConstRoom() && !myParent->getAsConstExit())
+        return;
+
+    time_t due = getNextDue();
+    if(!due)
+        return;
+
+    scheduled = MAX<time_t>(due, notBefore);
+    gServer->scheduleEffect(this, scheduled);
+}
+
+void Effects::schedule(time_t notBefore) {
+    for(EffectInfo* effect : effectList) {
+        if(!effect->getScheduled())
+            effect->schedule(notBefore);
+    }
+}
+
+//*********************************************************************
+//                      unschedule
+//*********************************************************************
+
+void EffectInfo::unschedule() {
+    if(!scheduled)
+        return;
+    gServer->unscheduleEffect(this, scheduled);
+    scheduled = 0;
+}
+
+void EffectInfo::clearScheduled() {
+    scheduled = 0;
+}
+
+//*********************************************************************
+//                      getScheduled
+//*********************************************************************
+
+time_t EffectInfo::getScheduled() const {
+    return(scheduled);
+}
 //*********************************************************************
 //                      remove
 //*********************************************************************
@@ -469,6 +567,8 @@ EffectInfo* Effects::addEffect(EffectInfo* newEffect, bool show, MudObject* pPar
     newEffect->apply();
 
     effectList.push_back(newEffect);
+    addEffectBits(newEffect);
+    newEffect->schedule();
     if(newEffect->getParent()->getAsRoom())
         newEffect->getParent()->getAsRoom()->addEffectsIndex();
     else if(newEffect->getParent()->getAsExit() && newEffect->getParent()->getAsExit()->getRoom())
@@ -516,6 +616,7 @@ bool Effects::removeEffect(EffectInfo* toDel, bool show) {
         return(false);
 
     effectList.remove(toDel);
+    rebuildEffectBits();
     toDel->remove(show);
     delete toDel;
     return(true);
@@ -563,21 +664,54 @@ bool MudObject::isEffected(EffectInfo* effect) const {
 // of this name
 
 bool Effects::isEffected(const std::string &effect, bool exactMatch) const {
-    //EffectList list;
-    for(EffectInfo* eff : effectList) {
-        if(eff->getName() == effect || (!exactMatch && eff->hasBaseEffect(effect)))
-            return(true);
-    }
-
-    return(false);
+    int id = gConfig->getEffectId(effect);
+    if(id == -1)
+        return(false);
+    return(exactMatch ? exactBits.test(id) : effectBits.test(id));
 }
 
+// We are effected if something we have is (or has a base effect of) this effect,
+// or if this effect has a base effect of something we have
+
 bool Effects::isEffected(EffectInfo* effect) const {
-    for(EffectInfo* eff : effectList) {
-        if(eff->getName() == effect->getName() || eff->hasBaseEffect(effect->getName()) || effect->hasBaseEffect(eff->getName()))
-            return(true);
-    }
-    return(false);
+    const Effect* listing = effect->getEffect();
+    // No listing (dropped by a reload): all we can go on is its name
+    if(!listing)
+        return(isEffected(effect->getName()));
+    return(effectBits.test(listing->getId()) || (exactBits & listing->getEffectBits()).any());
+}
+
+//*********************************************************************
+//                      addEffectBits
+//*********************************************************************
+
+static unsigned long lastStamp = 0;
+
+void Effects::addEffectBits(const EffectInfo* effect) {
+    const Effect* listing = effect->getEffect();
+    if(!listing)
+        return;
+    exactBits.set(listing->getId());
+    effectBits |= listing->getEffectBits();
+    stamp = ++lastStamp;
+}
+
+//*********************************************************************
+//                      rebuildEffectBits
+//*********************************************************************
+// Base effects can be shared by more than one effect (fly, etc), so removal
+// can't just clear bits; effect lists are short so rebuild from scratch
+
+void Effects::rebuildEffectBits() {
+    exactBits.reset();
+    effectBits.reset();
+    for(const EffectInfo* eff : effectList)
+        addEffectBits(eff);
+    stamp = ++lastStamp;
+}
+
+unsigned long Effects::getStamp() const {
+    return(stamp);
 }
 
 //*********************************************************************
@@ -613,6 +747,10 @@ EffectInfo* MudObject::getEffect(std::string_view effect) const {
 // the base effect mentioned
 
 EffectInfo* Effects::getEffect(std::string_view effect) const {
+    int id = gConfig->getEffectId(effect);
+    if(id == -1 || !effectBits.test(id))
+        return(nullptr);
+
     EffectInfo* toReturn = nullptr;
     for(const auto eff : effectList) {
         if(eff && (eff->getName() == effect || eff->hasBaseEffect(effect))) {
@@ -638,6 +776,10 @@ EffectInfo* MudObject::getExactEffect(std::string_view effect) const {
 
 // Returns the effect with an exact name match
 EffectInfo* Effects::getExactEffect(std::string_view effect) const {
+    int id = gConfig->getEffectId(effect);
+    if(id == -1 || !exactBits.test(id))
+        return(nullptr);
+
     for(const auto eff : effectList) {
         if(eff && eff->getName() == effect)
             return(eff);
@@ -671,6 +813,7 @@ bool Creature::pulseEffects(time_t t) {
                 poison = true;
             delete effect;
             eIt = effects.effectList.erase(eIt);
+            effects.rebuildEffectBits();
         } else
             eIt++;
     }
@@ -736,6 +879,7 @@ void Effects::pulse(time_t t, MudObject* pParent) {
             effect->remove();
             delete effect;
             it = effectList.erase(it);
+            rebuildEffectBits();
         } else
             it++;
     }
@@ -754,6 +898,7 @@ void Effects::removeAll() {
         (*eIt) = nullptr;
     }
     effectList.clear();
+    rebuildEffectBits();
 }
 
 //*********************************************************************
@@ -766,8 +911,11 @@ void Effects::copy(const Effects* source, MudObject* pParent) {
     for(eIt = source->effectList.begin() ; eIt != source->effectList.end() ; eIt++) {
         effect = new EffectInfo();
         (*effect) = *(*eIt);
+        effect->clearScheduled();
         effect->setParent(pParent);
         effectList.push_back(effect);
+        addEffectBits(effect);
+        effect->schedule();
     }
 }
 
@@ -1088,6 +1236,22 @@ int Effect::getPulseDelay() const {
     return(pulseDelay);
 }
 
+//*********************************************************************
+//                      getId
+//*********************************************************************
+
+int Effect::getId() const {
+    return(id);
+}
+
+//*********************************************************************
+//                      getEffectBits
+//*********************************************************************
+
+const EffectBits& Effect::getEffectBits() const {
+    return(effectBits);
+}
+
 //*********************************************************************
 //                      runScript
 //*********************************************************************
@@ -1118,45 +1282,88 @@ bool EffectInfo::runScript(const std::string& pyScript, MudObject* applier) {
 
 
 //*********************************************************************
-//                      pulseCreatureEffects
+//                      pulseEffects
 //*********************************************************************
-// lastUserUpdate is set in updateUsers
+// Only objects with an effect that is due get pulsed. Everything due on
+// that object comes off the queue, and whatever survives the pulse is
+// put back on with its new due time. Effects due this second are queued by
+// tick slot, so each frame takes its share of them.
+
+void Server::pulseEffects(const TickSlice& slice) {
+    long t = slice.t;
+    if(slice.isFirst()) {
+        lastEffectsPulsed = effectsPulsed;
+        peakEffectsPulsed = MAX(peakEffectsPulsed, effectsPulsed);
+        effectsPulsed = 0;
+    }
 
-void Server::pulseCreatureEffects(long t) {
-    Monster *monster=nullptr;
+    while(!effectQueue.empty()) {
+        auto [when, slot, due] = *effectQueue.begin();
+        if(when > t || (when == t && slot >= slice.end))
+            break;
+        MudObject* parent = due->getParent();
 
-    for (const auto& sock : sockets) {
-        if(!sock.isConnected())
-            continue;
-        if(sock.hasPlayer())
-            sock.getPlayer()->pulseEffects(t);
-    }
+        due->unschedule();
+        for(EffectInfo* effect : parent->effects.effectList) {
+            if(effect->getScheduled() && effect->getScheduled() <= t)
+                effect->unschedule();
+        }
+
+        Creature* creature = parent->getAsCreature();
+        if(creature) {
+            Player* player = creature->getAsPlayer();
+            // players who aren't in the game are picked back up by addPlayer,
+            // inactive monsters by addActive
+            if(player && (!player->getSock() || !player->getSock()->isConnected()))
+                continue;
+            if(!player && !isActive(creature->getAsMonster()))
+                continue;
+
+            effectsPulsed += parent->effects.effectList.size();
+            // monsters that die here are gone, players stay around
+            if(!creature->pulseEffects(t) && !player)
+                continue;
+        } else {
+            effectsPulsed += parent->effects.effectList.size();
+            parent->effects.pulse(t, parent);
+
+            BaseRoom* room = parent->getAsRoom();
+            if(!room && parent->getAsExit())
+                room = parent->getAsExit()->getRoom();
+            if(room)
+                room->removeEffectsIndex();
+        }
 
-    auto mIt = activeList.begin();
-    while(mIt != activeList.end()) {
-        // Increment the iterator in case this monster dies during the update and is removed from the active list
-        monster = (*mIt++);
-        monster->pulseEffects(t);
+        parent->effects.schedule(t + 1);
     }
 }
 
 //*********************************************************************
-//                      pulseRoomEffects
+//                      scheduleEffect
 //*********************************************************************
 
-void Server::pulseRoomEffects(long t) {
-    std::list<BaseRoom*>::iterator it;
+void Server::scheduleEffect(EffectInfo* effect, time_t due) {
+    effectQueue.emplace(due, TickSlice::slotOf(effect), effect);
+}
 
-    for(it = effectsIndex.begin() ; it != effectsIndex.end() ; ) {
-        (*it)->pulseEffects(t);
+//*********************************************************************
+//                      unscheduleEffect
+//*********************************************************************
 
-        if(!(*it)->needsEffectsIndex())
-            it = effectsIndex.erase(it);
-        else
-            it++;
-    }
+void Server::unscheduleEffect(EffectInfo* effect, time_t due) {
+    effectQueue.erase(std::make_tuple(due, TickSlice::slotOf(effect), effect));
+}
 
-    lastRoomPulseUpdate = t;
+//*********************************************************************
+//                      clearEffectQueue
+//*********************************************************************
+// Anything still queued when the server goes away is freed later without
+// a queue to remove itself from
+
+void Server::clearEffectQueue() {
+    for(const auto& [due, slot, effect] : effectQueue)
+        effect->clearScheduled();
+    effectQueue.clear();
 }
 
 //*********************************************************************
@@ -1175,6 +1382,9 @@ void Server::showEffectsIndex(const Player* player) {
     }
 
     player->print("%d room%s in effects index.\n", i, i==1 ? "" : "s");
+    player->print("%ld effect%s in memory.\n", EffectInfo::getResidentCount(), EffectInfo::getResidentCount()==1 ? "" : "s");
+    player->print("%d effect%s waiting to be pulsed.\n", (int)effectQueue.size(), effectQueue.size()==1 ? "" : "s");
+    player->print("%ld effect%s pulsed in the last second, peak %ld.\n", lastEffectsPulsed, lastEffectsPulsed==1 ? "" : "s", peakEffectsPulsed);
 }
 
 //*********************************************************************
@@ -1429,13 +1639,16 @@ EffectInfo::EffectInfo(const std::string &pName, time_t pLastMod, long pDuration
     if(!myEffect)
         throw std::runtime_error(fmt::format("Can't find effect '{}'", pName));
     setOwner(owner);
+    residentCount++;
 }
 
 //*********************************************************************
 //                      EffectInfo
 //*********************************************************************
 
-EffectInfo::EffectInfo() = default;
+EffectInfo::EffectInfo() {
+    residentCount++;
+}
 
 //*********************************************************************
 //                      EffectInfo
@@ -1460,13 +1673,45 @@ EffectInfo::EffectInfo(xmlNodePtr rootNode) {
     if(!myEffect) {
         throw std::runtime_error("Can't find effect listing " + name);
     }
+    residentCount++;
 }
 
 //*********************************************************************
 //                      EffectInfo
 //*********************************************************************
 
-EffectInfo::~EffectInfo() = default;
+EffectInfo::~EffectInfo() {
+    unschedule();
+    residentCount--;
+}
+
+//*********************************************************************
+//                      getResidentCount
+//*********************************************************************
+// Effects that exist right now, queued or not
+
+long EffectInfo::residentCount = 0;
+
+long EffectInfo::getResidentCount() {
+    return(residentCount);
+}
+
+//*********************************************************************
+//                      operator new / delete
+//*********************************************************************
+
+static TypePool* getEffectInfoPool() {
+    static TypePool* pool = TypePool::getPool("EffectInfo", sizeof(EffectInfo));
+    return(pool);
+}
+
+void* EffectInfo::operator new(std::size_t size) {
+    return(getEffectInfoPool()->allocate(size));
+}
+
+void EffectInfo::operator delete(void* ptr, std::size_t size) {
+    getEffectInfoPool()->deallocate(ptr, size);
+}
 
 //*********************************************************************
 //                      setParent
@@ -1598,4 +1843,6 @@ void EffectInfo::setExtra(int pExtra) {
 
 void EffectInfo::setDuration(long pDuration) {
     duration = pDuration;
+    if(scheduled)
+        schedule();
 }
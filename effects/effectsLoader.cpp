@@ -16,7 +16,9 @@
  *
  */
 
+#include <iostream>                    // for operator<<, clog
 #include <map>                         // for allocator
+#include <unordered_map>               // for unordered_map
 #include <utility>                     // for move
 
 #include "builders/effectBuilder.hpp"  // for EffectBuilder
@@ -1750,9 +1752,46 @@ bool Config::loadEffects() {
       effects
     );
 
+    // Intern effect names first so they get the low ids, then any base effects
+    // which aren't effects on their own (warmth, etc)
+    for(auto& [effectName, effect] : effects) {
+        effect.id = internEffectId(effect.getName());
+        if(effect.id == -1)
+            return false;
+    }
+    for(auto& [effectName, effect] : effects) {
+        effect.effectBits.set(effect.id);
+        for(const auto& baseEffect : effect.baseEffects) {
+            int baseId = internEffectId(baseEffect);
+            if(baseId == -1)
+                return false;
+            effect.effectBits.set(baseId);
+        }
+    }
+
     return true;
 }
 
+//*********************************************************************
+//                      internEffectId
+//*********************************************************************
+// Returns -1 if we've run out of effect ids
+
+int Config::internEffectId(const std::string &eName) {
+    auto it = effectIds.find(eName);
+    if(it != effectIds.end())
+        return(it->second);
+
+    if(effectIds.size() >= EFFECT_MAX_IDS) {
+        std::clog << "Too many effects, raise EFFECT_MAX_IDS (" << EFFECT_MAX_IDS << ")" << std::endl;
+        return(-1);
+    }
+
+    int id = (int)effectIds.size();
+    effectIds.emplace(eName, id);
+    return(id);
+}
+
 
 //*********************************************************************
 //                      clearEffects
@@ -1760,4 +1799,5 @@ bool Config::loadEffects() {
 
 void Config::clearEffects() {
     effects.clear();
+    effectIds.clear();
 }
@@ -0,0 +1,32 @@
+/*
+ * allocStats.hpp
+ *   Counts of memory allocated through operator new
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef ALLOCSTATS_H_
+#define ALLOCSTATS_H_
+
+// Running totals for the calling thread. They only ever go up; take a reading
+// before and after a piece of work to see what it allocated. Memory allocated
+// by python or by C libraries through malloc isn't counted.
+struct AllocCount {
+    unsigned long bytes;
+    unsigned long count;
+};
+
+AllocCount getAllocCount();
+
+#endif /*ALLOCSTATS_H_*/
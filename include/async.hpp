@@ -19,6 +19,14 @@
 #ifndef _ASYNCH_H
 #define _ASYNCH_H
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "proc.hpp"
 
 class Player;
@@ -28,15 +36,51 @@ enum AsyncResult {
     AsyncLocal
 };
 
+// A job runs on one of the pool's threads and may hand back a callback, which
+// the main loop runs once the job is done. Jobs must not touch game state;
+// anything that needs the game should be done in the callback.
+typedef std::function<void()> AsyncCallback;
+typedef std::function<AsyncCallback()> AsyncJob;
+
 
 class Async {
 protected:
     int fds[2];
 public:
     Async();
-    AsyncResult branch(const Player* player, ChildType type);
+    AsyncResult branch(const Player* player, ChildType type, ChildHandler handler = nullptr);
 };
 
 
-#endif  /* _ASYNCH_H */
+class AsyncPool {
+public:
+    explicit AsyncPool(int pThreads = 2);
+    ~AsyncPool();
+
+    AsyncPool(const AsyncPool&) = delete;
+    AsyncPool& operator=(const AsyncPool&) = delete;
+
+    void run(AsyncJob job);
+    int runCallbacks(); // Main loop: run callbacks for finished jobs
+
+    [[nodiscard]] int getFd() const;
+    [[nodiscard]] size_t queued();
 
+private:
+    void work();
+
+    int numThreads;
+    int eventFd = -1;
+    bool stopping = false;
+
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake;
+
+    // Guarded by lock
+    std::deque<AsyncJob> jobs;
+    std::list<AsyncCallback> callbacks;
+};
+
+
+#endif  /* _ASYNCH_H */
@@ -19,7 +19,14 @@
 #define BANS_H_
 
 #include <libxml/parser.h>  // for xmlNodePtr
-
+#include <ctime>            // for time_t
+#include <list>             // for list
+#include <map>              // for map
+#include <string>           // for string
+#include <string_view>      // for string_view
+#include <unordered_map>    // for unordered_map
+#include <utility>          // for pair
+#include <vector>           // for vector
 
 class Ban {
 public:
@@ -40,5 +47,52 @@ public: // for now
     bool        isSuffix{};
 };
 
+// The ban list compiled for lookups. Exact sites go in a hash table,
+// "site*" bans in a trie, "*site" bans in a trie of the reversed site, and
+// CIDR bans ("10.0.0.0/8", "2001:db8::/32") in a bit trie per address
+// family, so a lookup costs about the length of what's looked up however
+// many bans there are. Only "*site*" bans are still searched one by one.
+//
+// Bans keep their place in the list, and the first one in the list that
+// matches is the one found, as before. Built from scratch whenever the list
+// changes and swapped in whole.
+class BanMatcher {
+public:
+    explicit BanMatcher(const std::list<Ban*>& bans);
+
+    [[nodiscard]] Ban* find(std::string_view site) const;
+    [[nodiscard]] Ban* find(std::string_view host, std::string_view ip) const;   // Whichever comes first
+    std::vector<Ban*> popExpired(time_t now);   // Soonest first; they're still in the list
+
+private:
+    static const size_t NONE = ~(size_t)0;
+
+    struct CharNode {
+        std::map<char, size_t> next;
+        size_t ban = NONE;
+    };
+    struct BitNode {
+        size_t next[2] = { NONE, NONE };
+        size_t ban = NONE;
+    };
+
+    size_t findPos(std::string_view site) const;
+    static void addChar(std::vector<CharNode>& trie, std::string_view site, size_t pos);
+    static void addBits(std::vector<BitNode>& trie, const unsigned char* addr, int bits, size_t pos);
+    static size_t findChar(const std::vector<CharNode>& trie, std::string_view site, bool reversed);
+    static size_t findBits(const std::vector<BitNode>& trie, const unsigned char* addr, int bits);
+    bool addCidr(const std::string& site, size_t pos);
+
+    std::vector<Ban*> order;
+    size_t everyone = NONE;                         // "*"
+    std::unordered_map<std::string, size_t> exact;
+    std::vector<CharNode> prefixes;
+    std::vector<CharNode> suffixes;
+    std::vector<std::pair<std::string, size_t>> contains;
+    std::vector<BitNode> ipv4;
+    std::vector<BitNode> ipv6;
+    std::vector<std::pair<time_t, Ban*>> expiry;    // Min-heap on unbanTime
+};
+
 
 #endif /*BANS_H_*/
@@ -46,6 +46,8 @@ public:
 
     BOOL_BUILDER(updateable);
     BOOL_BUILDER(isGroup);
+    INT_BUILDER(watches);
+    INT_BUILDER(targetWatches);
 
     // NOLINTNEXTLINE - We want implicit conversion
     operator MsdpVariable&&() {
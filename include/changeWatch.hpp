@@ -0,0 +1,63 @@
+/*
+ * changeWatch.hpp
+ *   Change counters for the parts of a creature MSDP reports on
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef CHANGEWATCH_H_
+#define CHANGEWATCH_H_
+
+// Each creature keeps a counter per kind of change; anything that wants to
+// know whether, say, a player's health moved since it last looked remembers
+// the counter and compares.
+enum StateChange {
+    CHANGE_HEALTH,
+    CHANGE_MANA,
+    CHANGE_EXPERIENCE,  // Experience or level
+    CHANGE_WIMPY,
+    CHANGE_MONEY,
+    CHANGE_BANK,
+    CHANGE_ARMOR,       // Armor or level
+    CHANGE_TARGET,
+    CHANGE_ROOM,
+
+    CHANGE_COUNT
+};
+
+#define CHANGE_MASK(c)  (1 << (c))
+
+// Member of a Stat or Money that bumps its owner's counter whenever it
+// changes. Copies don't take the owner with them: a copied Stat belongs to
+// whoever copied it. Assigning over a watched value is itself a change.
+class ChangeWatch {
+public:
+    ChangeWatch() = default;
+    ChangeWatch(const ChangeWatch&) {}
+    ChangeWatch& operator=(const ChangeWatch&) {
+        changed();
+        return(*this);
+    }
+
+    void watch(unsigned long* pCounter) { counter = pCounter; }
+    void changed() const {
+        if(counter)
+            (*counter)++;
+    }
+
+private:
+    unsigned long* counter = nullptr;
+};
+
+#endif /*CHANGEWATCH_H_*/
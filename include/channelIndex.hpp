@@ -0,0 +1,130 @@
+/*
+ * channelIndex.hpp
+ *   Who hears each global channel, and its compiled display format
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef CHANNELINDEX_H_
+#define CHANNELINDEX_H_
+
+#include <deque>        // for deque
+#include <map>          // for map
+#include <set>          // for set
+#include <string>       // for string
+#include <vector>       // for vector
+
+#include "global.hpp"   // for CustomColor
+
+class Player;
+class Socket;
+struct channelInfo;
+
+// A player as the channels see them. Whether they're deaf or can comprehend
+// languages is only worked out again when their effects have changed.
+class ChannelListener {
+public:
+    explicit ChannelListener(Player* pPlayer);
+
+    [[nodiscard]] Player* getPlayer() const;
+    [[nodiscard]] const std::string& getName() const;
+    bool isDeaf();
+    bool canComprehend();
+
+private:
+    void refresh();
+
+    Player* player;
+    std::string name;           // Their key in gServer->players
+    unsigned long effectStamp;  // Effects::getStamp() when the two below were worked out
+    bool deaf = false;
+    bool comprehends = false;
+};
+
+// A channel's displayFmt, split around its *IC-NAME*, *OOC-NAME* and *TEXT*
+// markers once instead of searched for every time it's shown.
+class ChannelFormat {
+public:
+    explicit ChannelFormat(const channelInfo* chan);
+
+    // Same as replacing the markers in displayFmt one after the other
+    [[nodiscard]] std::string render(const std::string& icName, const std::string& oocName, const std::string& text) const;
+    [[nodiscard]] CustomColor getColor() const;    // MAX_CUSTOM_COLOR if it isn't a single custom color
+
+private:
+    enum PartType {
+        PART_LITERAL,
+        PART_IC_NAME,
+        PART_OOC_NAME,
+        PART_TEXT
+    };
+    struct Part {
+        PartType type;
+        std::string text;
+    };
+
+    void split(const std::string& marker, PartType type);
+
+    std::string format;
+    std::vector<Part> parts;
+    CustomColor color;
+    // False if a name could complete a marker the format started; such
+    // formats (and names with a * in them) are rendered the slow way
+    bool compiled = true;
+};
+
+// Subscriber sets for the global channels. Channels that share their canHear
+// rules (canHear, flag, not_flag) share a set. A player is only in a set while
+// they're connected and pass those rules; the index is told when anything
+// they depend on changes: logging in or out, connection state, flags, class.
+// The checks that depend on who's talking (gags, deafness, class/race/clan)
+// are still made as a message goes out. Sets are kept in name order, the
+// order gServer->players is in, so a message goes out in the same order it
+// always has.
+class ChannelIndex {
+public:
+    struct ListenerOrder {
+        bool operator()(const ChannelListener* a, const ChannelListener* b) const;
+    };
+    typedef std::set<ChannelListener*, ListenerOrder> ListenerSet;
+
+    void add(Player* player);       // Now in gServer->players
+    void remove(Player* player);    // No longer in gServer->players
+    void update(Player* player);    // Something canHear depends on changed
+
+    const ListenerSet& getListeners(const channelInfo* chan);
+    [[nodiscard]] const ListenerSet& getEavesdroppers() const;
+    const ChannelFormat& getFormat(const channelInfo* chan);
+
+private:
+    struct Audience {
+        bool (*canHear)(Socket*);
+        int flag;
+        int notFlag;
+        ListenerSet listeners;
+
+        [[nodiscard]] bool hears(Player* player) const;
+    };
+
+    Audience& getAudience(const channelInfo* chan);
+    void place(ChannelListener* listener);
+
+    std::map<Player*, ChannelListener> members;
+    std::deque<Audience> audiences;     // Never shrinks, so references stay good
+    std::map<const channelInfo*, size_t> channelAudience;
+    std::map<const channelInfo*, ChannelFormat> formats;
+    ListenerSet eavesdroppers;
+};
+
+#endif /*CHANNELINDEX_H_*/
@@ -18,6 +18,8 @@
 #ifndef COMM_H
 #define COMM_H
 
+#include <string_view>
+
 #include "commands.hpp"
 #include "flags.hpp"
 #include "proto.hpp"
@@ -102,6 +104,7 @@ void sendGlobalComm(const Player *player, const std::string &text, const std::st
 
 channelPtr getChannelByName(const Player *player, const std::string &chanStr);
 channelPtr getChannelByDiscordChannel(unsigned long discordChannelID);
+std::string mxpTag(std::string_view str);
 
 
 #endif
@@ -0,0 +1,112 @@
+/*
+ * compressor.hpp
+ *   Per-connection MCCP deflate streams
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef COMPRESSOR_H_
+#define COMPRESSOR_H_
+
+#include <zlib.h>               // for z_stream
+
+#include <atomic>               // for atomic
+#include <condition_variable>   // for condition_variable
+#include <deque>                // for deque
+#include <memory>               // for enable_shared_from_this
+#include <mutex>                // for mutex
+#include <string>               // for string
+#include <string_view>          // for string_view
+
+class AsyncPool;
+
+#define MCCP_WINDOW         60      // Seconds of output looked at when picking a profile
+
+// How hard a connection's stream works, and how much memory it holds on to.
+// deflate keeps about (1 << (windowBits+2)) + (1 << (memLevel+9)) bytes.
+struct CompressProfile {
+    int level;
+    int windowBits;
+    int memLevel;
+};
+
+// One connection's deflate stream. Everything handed to it comes back out of
+// take() in the order it went in, including raw bytes queued between two
+// compressed streams (the MCCP start sequence when a stream is restarted).
+//
+// Given a pool, the deflate calls run on the pool's thread and the main loop
+// only ever copies bytes in and out; without one they run as they're queued.
+// Either way only one job per stream runs at a time.
+class CompressStream : public std::enable_shared_from_this<CompressStream> {
+public:
+    explicit CompressStream(AsyncPool* pPool = nullptr);
+    ~CompressStream();
+
+    CompressStream(const CompressStream&) = delete;
+    CompressStream& operator=(const CompressStream&) = delete;
+
+    void start(const CompressProfile& profile); // Begin a new zlib stream
+    void compress(std::string_view data);       // Deflate with a sync flush
+    void finish();                              // End the zlib stream and free its memory
+    void raw(std::string_view data);            // Passed through untouched
+
+    std::string take();     // Output that's ready to send
+    void wait();            // Until everything queued so far has been done
+
+    [[nodiscard]] bool failed() const;
+    [[nodiscard]] unsigned long getBytesIn() const;     // Uncompressed bytes deflated
+    [[nodiscard]] unsigned long getBytesOut() const;    // ...and what they came to
+    [[nodiscard]] size_t getMemory() const;             // Bytes zlib has allocated
+
+private:
+    enum Op {
+        OP_START,
+        OP_COMPRESS,
+        OP_FINISH,
+        OP_RAW
+    };
+    struct Job {
+        Op op;
+        std::string data;
+        CompressProfile profile;
+    };
+
+    void queue(Job job);
+    void process();                 // Runs every queued job
+    std::string run(const Job& job);
+    std::string deflateAll(const std::string& data, int flush);
+    void release();
+
+    static void* zlibAlloc(void* opaque, unsigned int items, unsigned int size);
+    static void zlibFree(void* opaque, void* address);
+
+    AsyncPool* pool;
+
+    std::mutex lock;
+    std::condition_variable done;
+    // Guarded by lock
+    std::deque<Job> jobs;
+    std::string ready;
+    bool scheduled = false;         // Handed to the pool and not yet finished
+
+    // Only touched by whoever is running the jobs
+    z_stream* zs = nullptr;
+
+    std::atomic<bool> error{false};
+    std::atomic<unsigned long> bytesIn{0};
+    std::atomic<unsigned long> bytesOut{0};
+    std::atomic<size_t> memory{0};
+};
+
+#endif /*COMPRESSOR_H_*/
@@ -21,11 +21,14 @@
 #include <list>
 #include <map>
 #include <set>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <cstring>  // strcasecmp
 
 #include "global.hpp"
+#include "methodTrie.hpp"
 #include "money.hpp"
 #include "msdp.hpp"
 #include "namable.hpp"
@@ -49,6 +52,8 @@ class Unique;
 class PlayerClass;
 class GuildCreation;
 class Ban;
+class BanMatcher;
+struct CompressProfile;
 class Property;
 class Ship;
 class Effect;
@@ -81,6 +86,7 @@ class UniqueRoom;
 class Spell;
 class Song;
 
+class Command;
 class PlyCommand;
 class CrtCommand;
 class SkillCommand;
@@ -112,12 +118,32 @@ typedef std::map<std::string, MxpElement, comp> MxpElementMap;
 typedef std::map<std::string, std::string, comp> stringMap;
 typedef std::map<std::string, SkillInfo, comp> SkillInfoMap;
 typedef std::map<std::string, Effect, comp> EffectMap;
+struct transparentStringHash {
+    using is_transparent = void;
+    std::size_t operator() (std::string_view str) const {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+typedef std::unordered_map<std::string, int, transparentStringHash, std::equal_to<>> EffectIdMap;
+typedef std::unordered_map<std::string, int, transparentStringHash, std::equal_to<>> SkillIdMap;
 typedef std::set<SocialCommand, namableCmp> SocialSet;
 typedef std::set<PlyCommand, namableCmp> PlyCommandSet;
 typedef std::set<CrtCommand, namableCmp> CrtCommandSet;
 typedef std::set<SkillCommand, namableCmp> SkillCommandSet;
 typedef std::set<Spell, namableCmp> SpellSet;
 typedef std::set<Song, namableCmp> SongSet;
+// Order matters: an exact match in an earlier list beats one in a later list
+enum CommandList {
+    COMMAND_GENERAL,
+    COMMAND_SKILL,
+    COMMAND_PLAYER,
+    COMMAND_STAFF,
+    COMMAND_SOCIAL,
+    COMMAND_LIST_COUNT
+};
+typedef MethodTrie<Command, COMMAND_LIST_COUNT> CommandTrie;
+typedef MethodTrie<Spell, 1> SpellTrie;
+typedef MethodTrie<Song, 1> SongTrie;
 typedef std::map<std::string, AlchemyInfo, comp> AlchemyMap;
 typedef std::map<std::string, MsdpVariable> MsdpVariableMap;
 typedef std::map<unsigned int, MudFlag> MudFlagMap;
@@ -200,6 +226,9 @@ public:
 // Commands
     bool initCommands();
     void clearCommands();
+    void indexCommands();
+    [[nodiscard]] unsigned long getCommandGeneration() const;  // Bumped whenever the command sets change
+    [[nodiscard]] std::vector<const Command*> getCommandList() const;
 
 // Socials
     bool loadSocials();
@@ -212,6 +241,8 @@ public:
     void clearEffects();
     const Effect* getEffect(const std::string &eName);
     bool effectExists(const std::string &eName);
+    [[nodiscard]] int getEffectId(std::string_view eName) const;
+    int internEffectId(const std::string &eName);
 
     void clearSpells();
     const Spell* getSpell(const std::string &id, int& ret);
@@ -230,6 +261,7 @@ public:
 // Skills
     [[nodiscard]] bool skillExists(const std::string &skillName) const;
     [[nodiscard]] const SkillInfo * getSkill(const std::string &skillName) const;
+    [[nodiscard]] int getSkillId(std::string_view skillName) const;
     [[nodiscard]] const std::string & getSkillGroupDisplayName(const std::string &groupName) const;
     [[nodiscard]] const std::string & getSkillGroup(const std::string &skillName) const;
     [[nodiscard]] const std::string & getSkillDisplayName(const std::string &skillName) const;
@@ -241,6 +273,7 @@ public:
     bool deleteBan(int toDel);
     bool isBanned(std::string_view site);
     int isLockedOut(Socket* sock);
+    void expireBans();
 
 
 // Guilds
@@ -409,6 +442,13 @@ public:
     void toggleTxtOnCrash();
     [[nodiscard]] int getShopNumObjects() const;
     [[nodiscard]] int getShopNumLines() const;
+    [[nodiscard]] int getTickRate() const;                 // Frames per second
+    [[nodiscard]] int getCommandRate(bool staff) const;   // Commands a socket may run per tick
+    [[nodiscard]] int getCommandBurst(bool staff) const;  // ...and may save up for a batch
+    [[nodiscard]] CompressProfile getCompressProfile(bool busy) const;  // MCCP settings for quiet or busy connections
+    [[nodiscard]] int getCompressBusyAfter() const;       // Bytes a minute that make a connection busy
+    [[nodiscard]] int getCompressIdle() const;            // Seconds before a quiet connection's stream is released
+    [[nodiscard]] bool getCompressThread() const;         // Deflate on its own thread
 
     std::string getSpecialFlag(int index);
 
@@ -530,6 +570,7 @@ private:
 public:
     void setDefaultArea(const std::string &pDefaultArea);
     [[nodiscard]] const std::string &getDefaultArea() const;
+    [[nodiscard]] const std::string &getLogDbType() const;
 
 private:
     // loaded from catrefinfo file
@@ -568,6 +609,20 @@ private:
     int     flashPolicyPort{};
     int     shopNumObjects{};
     int     shopNumLines{};
+    int     tickRate{};
+    int     commandRate{};
+    int     commandBurst{};
+    int     staffCommandRate{};
+    int     staffCommandBurst{};
+    int     mccpLevel{};
+    int     mccpWindow{};
+    int     mccpMemLevel{};
+    int     mccpBusyLevel{};
+    int     mccpBusyWindow{};
+    int     mccpBusyMemLevel{};
+    int     mccpBusyAfter{};
+    int     mccpIdle{};
+    bool    mccpThread{};
     std::string reviewer;
 
     std::list<Unique*> uniques;
@@ -597,9 +652,13 @@ public:
 
     // Bans
     std::list<Ban*> bans;
+    BanMatcher* banMatcher = nullptr;   // Compiled from bans when next needed
+    BanMatcher* getBanMatcher();
+    void bansChanged();
 
     // Effects
     EffectMap effects;
+    EffectIdMap effectIds;  // Effect and base effect names -> bit in EffectBits
 
     // Commands
     PlyCommandSet staffCommands;
@@ -614,6 +673,13 @@ public:
     // All Skill Commands are SkillInfos, but not all SkillInfos are SkillCommands
     SkillCommandSet skillCommands;
     SkillInfoMap skills;
+    SkillIdMap skillIds;    // Skill names -> dense ids, assigned at loadSkills
+
+    // Prefix tries over the sets above, rebuilt by indexCommands whenever they change
+    CommandTrie commandTrie;
+    SpellTrie spellTrie;
+    SongTrie songTrie;
+    unsigned long commandGeneration = 0;
 
     // Guilds
     std::list<GuildCreation*> guildCreations;
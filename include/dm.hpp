@@ -125,6 +125,8 @@ int dmSet(Player* player, cmd* cmnd);
 int dmLog(Player* player, cmd* cmnd);
 int dmList(Player* player, cmd* cmnd);
 int dmInfo(Player* player, cmd* cmnd);
+int dmProfile(Player* player, cmd* cmnd);
+int dmCmdStats(Player* player, cmd* cmnd);
 int dmMd5(Player* player, cmd* cmnd);
 int dmIds(Player* player, cmd* cmnd);
 int dmStat(Player* player, cmd* cmnd);
@@ -0,0 +1,86 @@
+/*
+ * dnsResolver.hpp
+ *   Background reverse DNS lookups for incoming connections
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef DNSRESOLVER_H_
+#define DNSRESOLVER_H_
+
+#include <netinet/in.h>          // for sockaddr_in
+#include <condition_variable>    // for condition_variable
+#include <deque>                 // for deque
+#include <list>                  // for list
+#include <memory>                // for shared_ptr
+#include <mutex>                 // for mutex
+#include <string>                // for string
+#include <string_view>           // for string_view
+#include <unordered_set>         // for unordered_set
+#include <utility>               // for pair
+
+// A small pool of threads that run getnameinfo for the main loop. Finished
+// lookups are queued and the eventfd returned by getFd() becomes readable, so
+// the server can select on it alongside the player sockets and collect the
+// results with takeResults(). Only the main thread may call the public methods.
+//
+// The threads are detached: one can sit in getnameinfo for as long as the
+// system resolver likes, and shutdown shouldn't wait on it. What they share
+// with us lives in Shared, which the last of them to finish frees.
+class DnsResolver {
+public:
+    struct Result {
+        std::string ip;
+        std::string hostName; // Same as ip if the lookup failed
+    };
+
+    explicit DnsResolver(int pThreads = 2);
+    ~DnsResolver();
+
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+
+    // Returns false if a lookup for this ip is already in flight
+    bool lookup(std::string_view ip, const sockaddr_in& addr);
+    std::list<Result> takeResults();
+
+    [[nodiscard]] int getFd() const;
+    [[nodiscard]] size_t inFlight() const;
+
+private:
+    struct Shared {
+        ~Shared();
+
+        int eventFd = -1;
+        std::mutex lock;
+        std::condition_variable wake;
+
+        // Guarded by lock
+        bool stopping = false;
+        std::deque<std::pair<std::string, sockaddr_in>> requests;
+        std::list<Result> results;
+    };
+
+    static void work(std::shared_ptr<Shared> shared);
+    static std::string resolve(const std::string& ip, sockaddr_in addr);
+
+    int numThreads;
+    bool started = false;
+    std::shared_ptr<Shared> shared;
+
+    // Main thread only: ips queued or being resolved whose result hasn't been taken yet
+    std::unordered_set<std::string> pending;
+};
+
+#endif /*DNSRESOLVER_H_*/
@@ -22,9 +22,14 @@
 
 #define EFFECT_MAX_DURATION 10800
 #define EFFECT_MAX_STRENGTH 5000
+#define EFFECT_MAX_IDS 256
+// Rooms and exits never pulse their effects more often than this
+#define EFFECT_ROOM_PULSE_DELAY 20
 
+#include <bitset>
 #include <iostream>
 #include <list>
+#include <string>
 
 
 typedef struct _xmlNode xmlNode;
@@ -33,10 +38,16 @@ typedef xmlNode *xmlNodePtr;
 
 class MudObject;
 class EffectBuilder;
+class Config;
+
+// Effect and base effect names are interned to ids when effects are loaded;
+// one bit per id lets isEffected answer with a single bit test
+typedef std::bitset<EFFECT_MAX_IDS> EffectBits;
 
 class Effect {
 public:
     friend class EffectBuilder; // The builder can access the internals
+    friend class Config;        // Config assigns ids when loading effects
 
     [[nodiscard]] const std::string & getPulseScript() const;
     [[nodiscard]] const std::string & getUnApplyScript() const;
@@ -57,6 +68,8 @@ public:
     [[nodiscard]] bool isPulsed() const;
     [[nodiscard]] bool isSpell() const;
     [[nodiscard]] bool usesStrength() const;
+    [[nodiscard]] int getId() const;
+    [[nodiscard]] const EffectBits& getEffectBits() const;
 
     // Base effect(s) - for multiple effects that confer the same type of effect (fly, etc)
     const std::list<std::string> &getBaseEffects();
@@ -69,6 +82,9 @@ private:
     std::string name;
     std::list<std::string> baseEffects;  // For multiple effects that confer the same type of effect, ie: Fly
 
+    int id = -1;            // Interned id of name
+    EffectBits effectBits;  // Interned ids of name and all base effects
+
     std::string display;
 
     std::string oppositeEffect;
@@ -131,6 +147,9 @@ public:
     EffectInfo(xmlNodePtr rootNode);
 
     virtual ~EffectInfo();
+    // Allocated from a TypePool (see pool.hpp)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
 
     friend std::ostream &operator<<(std::ostream &out, const EffectInfo &effectinfo);
     friend std::ostream &operator<<(std::ostream &out, EffectInfo *effectinfo);
@@ -159,6 +178,12 @@ public:
     bool updateLastMod(time_t t);    // True if it's time to wear off
     bool timeForPulse(time_t t);     // True if it's time to pulse
     bool pulse(time_t t);
+    [[nodiscard]] int getPulseDelay() const;
+    [[nodiscard]] time_t getNextDue() const;   // 0 if this effect never needs to be pulsed
+    [[nodiscard]] time_t getScheduled() const;
+    void schedule(time_t notBefore = 0);
+    void unschedule();
+    void clearScheduled();
 
     void setOwner(const Creature *owner);
     void setStrength(int pStrength);
@@ -174,6 +199,8 @@ public:
 
     [[nodiscard]] MudObject *getApplier() const;
 
+    static long getResidentCount();
+
 protected:
     EffectInfo();
 
@@ -182,6 +209,8 @@ private:
     std::string pOwner;         // Who cast this effect (player)
     time_t lastMod = 0;         // When did we last update duration
     time_t lastPulse = 0;       // Last Pulsed time
+    time_t scheduled = 0;       // When we're due in gServer's effect queue, 0 if not queued
+    static long residentCount;  // EffectInfos in memory
     int pulseModifier = 0;      // Adjustment to base pulse timer
     long duration = 0;          // How much longer will this effect last
     int strength = 0;           // How strong is this effect (for overwriting effects)
@@ -235,7 +264,20 @@ public:
 
     void pulse(time_t t, MudObject *pParent = nullptr);
 
+    // Keep the effect bits in sync with effectList; anything that erases from
+    // effectList directly must call rebuildEffectBits afterwards
+    void addEffectBits(const EffectInfo *effect);
+    void rebuildEffectBits();
+    [[nodiscard]] unsigned long getStamp() const;  // Changes whenever the bits do
+
+    // Queue any effects that aren't already waiting to be pulsed
+    void schedule(time_t notBefore = 0);
+
     EffectList effectList;
+private:
+    EffectBits effectBits;  // Names and base effects of everything in effectList
+    EffectBits exactBits;   // Names of everything in effectList
+    unsigned long stamp = 0;    // Unique across all effect lists, so a copy never looks unchanged
 };
 
 #endif /*EFFECTS_H_*/
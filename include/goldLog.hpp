@@ -0,0 +1,159 @@
+/*
+ * goldLog.hpp
+ *   Background writer for the gold transaction log
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef GOLDLOG_H_
+#define GOLDLOG_H_
+
+#include <atomic>               // for atomic
+#include <condition_variable>   // for condition_variable
+#include <ctime>                // for time_t
+#include <memory>               // for unique_ptr
+#include <mutex>                // for mutex
+#include <string>               // for string
+#include <thread>               // for thread
+#include <vector>               // for vector
+
+#include "mailbox.hpp"          // for Mailbox
+
+#define GOLDLOG_QUEUE       8192    // Events held in memory before they go straight to the journal
+#define GOLDLOG_BATCH       256     // Rows per insert at most
+#define GOLDLOG_INTERVAL    1       // Seconds between flushes when it's quiet
+#define GOLDLOG_RETRY       30      // Seconds between attempts to reconnect
+
+struct GoldEvent {
+    std::string player;
+    std::string id;
+    std::string target;
+    std::string source;
+    std::string room;
+    std::string type;
+    unsigned long gold = 0;
+    std::string direction;
+
+    [[nodiscard]] std::string toLine() const;   // One journal line, tab separated
+    bool fromLine(const std::string& line);
+};
+
+// Where the events end up. Only ever used from the writer thread.
+class GoldSink {
+public:
+    virtual ~GoldSink() = default;
+    virtual bool connect() = 0;
+    virtual bool insert(const std::vector<GoldEvent>& batch) = 0;  // All or nothing
+    virtual void disconnect() = 0;
+    [[nodiscard]] virtual bool isConnected() const = 0;
+};
+
+// Appends to a tab separated file; stands in for a database when there isn't one
+class FileGoldSink : public GoldSink {
+public:
+    explicit FileGoldSink(std::string pPath);
+    bool connect() override;
+    bool insert(const std::vector<GoldEvent>& batch) override;
+    void disconnect() override;
+    [[nodiscard]] bool isConnected() const override;
+private:
+    std::string path;
+    bool connected = false;
+};
+
+#ifdef SQL_LOGGER
+
+namespace odbc {
+    class Connection;
+}
+
+// Multi-row inserts into the goldlog table over ODBC
+class SqlGoldSink : public GoldSink {
+public:
+    explicit SqlGoldSink(std::string pConnStr);
+    ~SqlGoldSink() override;
+    bool connect() override;
+    bool insert(const std::vector<GoldEvent>& batch) override;
+    void disconnect() override;
+    [[nodiscard]] bool isConnected() const override;
+private:
+    std::string connStr;
+    odbc::Connection* conn = nullptr;
+};
+
+#endif // SQL_LOGGER
+
+// The game loop posts events and carries on; the writer thread sends them to
+// the sink in batches. While the sink is down, events are appended to a
+// journal on disk, and replayed in order once it's back. If the writer falls
+// GOLDLOG_QUEUE events behind, the game loop appends new events to a spill
+// file rather than letting memory grow, and keeps doing so until the writer
+// has caught up with the queue and taken the spill back; that way the sink
+// still sees events in the order they were posted. Events are only dropped
+// if the disk can't be written either.
+class GoldLogWriter {
+public:
+    struct Stats {
+        unsigned long queued;       // Posted by the game
+        unsigned long flushed;      // Written to the sink
+        unsigned long journaled;    // Written to the journal instead
+        unsigned long spilled;      // Put on disk by the game loop while we were behind
+        unsigned long replayed;     // Moved from the journal to the sink
+        unsigned long dropped;
+        unsigned long batches;
+        size_t pending;             // In memory right now
+        bool connected;
+    };
+
+    GoldLogWriter(std::unique_ptr<GoldSink> pSink, std::string pJournal);
+    ~GoldLogWriter();   // Flushes or journals whatever's left
+
+    GoldLogWriter(const GoldLogWriter&) = delete;
+    GoldLogWriter& operator=(const GoldLogWriter&) = delete;
+
+    void post(GoldEvent event);     // Game loop; never waits on the sink
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    void work();
+    void flush(std::vector<GoldEvent>& batch);
+    bool replay();
+    void unspill();
+    bool journal(const std::vector<GoldEvent>& events);
+
+    std::unique_ptr<GoldSink> sink;     // Writer thread only
+    std::string journalPath;            // Writer thread only
+    std::string spillPath;
+    std::mutex spillLock;
+    std::atomic<bool> spilling{false};  // Newer than anything in the queue
+
+    Mailbox<GoldEvent> events;
+    std::thread thread;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> connected{false};
+    time_t lastAttempt = 0;             // Writer thread only
+
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned long> queued{0};
+    std::atomic<unsigned long> flushed{0};
+    std::atomic<unsigned long> journaled{0};
+    std::atomic<unsigned long> spilled{0};
+    std::atomic<unsigned long> replayed{0};
+    std::atomic<unsigned long> dropped{0};
+    std::atomic<unsigned long> batches{0};
+};
+
+#endif /*GOLDLOG_H_*/
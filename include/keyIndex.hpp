@@ -0,0 +1,115 @@
+/*
+ * keyIndex.hpp
+ *   Keys and names of everything in a container, for finding things by name
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef KEYINDEX_H_
+#define KEYINDEX_H_
+
+#include <algorithm>    // for sort, unique
+#include <map>          // for map, multimap
+#include <string>       // for string
+#include <vector>       // for vector
+
+#include "mudObjects/container.hpp"     // for ObjectSet, MonsterSet, PlayerSet
+#include "proto.hpp"                    // for keyTxtNormalize
+
+#define KEYINDEX_MIN    32      // Containers smaller than this are just searched
+
+// One set's keys and names as keyTxtCompare sees them (see keyTxtNormalize),
+// sorted so everything starting with what was typed sits together.
+//
+// Kept up to date by Container::add and remove. Code that changes the set
+// directly leaves it a different size than we think it is, and that's
+// enough for the next search to build it again from scratch.
+template <class T, class Less>
+class KeyIndexSet {
+public:
+    void add(T* target) {
+        auto [it, added] = targets.try_emplace(target);
+        if(!added)
+            return;
+        std::vector<std::string>& indexed = it->second;
+        for(const std::string& key : getKeys(target)) {
+            keys.emplace(key, target);
+            indexed.push_back(key);
+        }
+    }
+
+    void remove(T* target) {
+        auto it = targets.find(target);
+        if(it == targets.end())
+            return;
+        // Use what was indexed; their keys may have changed since
+        for(const std::string& key : it->second) {
+            auto range = keys.equal_range(key);
+            for(auto k = range.first; k != range.second; ++k) {
+                if(k->second == target) {
+                    keys.erase(k);
+                    break;
+                }
+            }
+        }
+        targets.erase(it);
+    }
+
+    // Everything in set with a key or name starting with prefix (already run
+    // through keyTxtConvert), in the set's own order
+    std::vector<T*> find(const std::set<T*, Less>& set, const std::string& prefix) {
+        if(targets.size() != set.size())
+            build(set);
+
+        std::vector<T*> found;
+        for(auto it = keys.lower_bound(prefix); it != keys.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+            found.push_back(it->second);
+
+        // Anything with more than one matching key shows up more than once
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        std::sort(found.begin(), found.end(), Less());
+        return(found);
+    }
+
+private:
+    void build(const std::set<T*, Less>& set) {
+        keys.clear();
+        targets.clear();
+        for(T* target : set)
+            add(target);
+    }
+
+    static std::vector<std::string> getKeys(const T* target) {
+        std::vector<std::string> found;
+        for(const char* key : {target->key[0], target->key[1], target->key[2], target->getCName()}) {
+            std::string normalized = keyTxtNormalize(key);
+            if(!normalized.empty())
+                found.push_back(normalized);
+        }
+        return(found);
+    }
+
+    std::multimap<std::string, T*> keys;
+    std::map<T*, std::vector<std::string>> targets;     // What each one was indexed under
+};
+
+class KeyIndex {
+public:
+    KeyIndexSet<Player, PlayerPtrLess> players;
+    KeyIndexSet<Monster, MonsterPtrLess> monsters;
+    KeyIndexSet<Object, ObjectPtrLess> objects;
+};
+
+#endif /*KEYINDEX_H_*/
@@ -0,0 +1,113 @@
+/*
+ * logger.hpp
+ *   Buffered log writer used by logn, loge and loga
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <sys/types.h>          // for pid_t
+#include <atomic>               // for atomic
+#include <condition_variable>   // for condition_variable
+#include <cstdio>               // for FILE
+#include <ctime>                // for time_t
+#include <memory>               // for unique_ptr
+#include <mutex>                // for mutex
+#include <string>               // for string
+#include <string_view>          // for string_view
+#include <thread>               // for thread
+#include <unordered_map>        // for unordered_map
+
+#define LOG_RING_SIZE       4096                // Lines waiting to be written; must be a power of two
+#define LOG_ROTATE_SIZE     (16*1024*1024)      // Rotate a log once it gets this big
+#define LOG_ROTATE_AGE      (60*60*24*7)        // ...or once its first line is this old
+#define LOG_IDLE            60                  // Seconds before an unused log file is closed
+#define LOG_FLUSH_WAIT      2000                // Milliseconds flushLogs waits for the writer
+#define LOG_FULL_WAIT       100                 // Microseconds a logger waits for room when the ring is full
+
+struct LogLine {
+    std::string file;   // Full path
+    std::string text;
+};
+
+// Bounded multi-producer, single-consumer queue. Producers claim a slot with a
+// compare-and-swap on head; each slot's sequence number says whether it's free,
+// full, or still being filled, so no locks are needed on either side.
+class LogRing {
+public:
+    explicit LogRing(size_t size);
+
+    bool push(LogLine&& line);  // false if full
+    bool pop(LogLine& line);    // consumer only; false if empty
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        LogLine line;
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) size_t tail = 0;
+};
+
+// Owns the writer thread and the open log files. Lines are formatted by the
+// caller and handed to the ring; the writer keeps each file open while it's in
+// use and rotates it when it gets too big or too old.
+class Logger {
+public:
+    static Logger* getInstance();
+
+    void write(std::string_view file, std::string text);
+    void flush();   // Wait (briefly) for everything queued so far to reach disk
+    void stop();    // Drain the ring and stop the writer thread
+
+private:
+    Logger();
+
+    struct LogFile {
+        FILE* fp = nullptr;
+        long size = 0;
+        time_t oldest = 0;      // Time of the first line in the file, if we could tell
+        time_t lastUsed = 0;
+    };
+
+    void work();
+    void drain();
+    void writeLine(const LogLine& line, time_t now);
+    bool open(const std::string& path, LogFile& file);
+    void rotate(const std::string& path, LogFile& file, time_t now);
+    void closeIdle(time_t now, bool all = false);
+    static void writeNow(const std::string& path, const std::string& text);
+
+    LogRing ring;
+    pid_t owner;                            // Forked children write directly
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> stopped{false};       // Writer's gone and the ring is drained
+    std::atomic<unsigned long> queued{0};
+    std::atomic<unsigned long> written{0};
+    std::atomic<unsigned long> overflows{0};
+    std::mutex wakeLock;
+    std::condition_variable wake;
+
+    std::unordered_map<std::string, LogFile> files; // Writer thread only
+};
+
+void flushLogs();
+
+#endif /*LOGGER_H_*/
@@ -0,0 +1,105 @@
+/*
+ * mailbox.hpp
+ *   Events posted to the game loop from other threads
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef MAILBOX_H_
+#define MAILBOX_H_
+
+#include <atomic>       // for atomic
+#include <cstddef>      // for size_t
+#include <functional>   // for function
+#include <optional>     // for optional
+#include <string>       // for string
+#include <variant>      // for variant
+
+#define MAILBOX_FRAME_MAX   4096    // Events handled per frame at most; the rest wait for the next
+
+// Unbounded multi-producer, single-consumer queue. Producers link a new node
+// in with one atomic exchange, so posting never blocks or fails; only the
+// consumer walks the list. A producer that has swapped the head but not yet
+// linked its node makes the queue look empty for a moment; its event is
+// simply picked up next time.
+template <class T>
+class Mailbox {
+public:
+    Mailbox(): head(new Node()), tail(head.load()) {}
+    ~Mailbox() {
+        while(tail) {
+            Node* next = tail->next.load();
+            delete tail;
+            tail = next;
+        }
+    }
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    // Any thread
+    void post(T item) {
+        Node* node = new Node();
+        node->item.emplace(std::move(item));
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+        posted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer only; false if empty
+    bool pop(T& item) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if(!next)
+            return(false);
+        item = std::move(*next->item);
+        next->item.reset();
+        delete tail;
+        tail = next;    // The node we took becomes the new stub
+        return(true);
+    }
+
+    [[nodiscard]] unsigned long getPosted() const { return(posted.load(std::memory_order_relaxed)); }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> item;
+    };
+
+    alignas(64) std::atomic<Node*> head;    // Producers
+    alignas(64) Node* tail;                 // Consumer
+    std::atomic<unsigned long> posted{0};
+};
+
+// A message said in a Discord channel that might be bridged to a game channel
+struct DiscordMessage {
+    unsigned long channelId;
+    std::string name;       // Who said it, as shown in the game
+    std::string text;       // With mentions, attachments and embeds filled in
+    std::string content;    // The message as sent
+    std::string author;
+};
+
+// Someone asked the bot who's online; the who list is built on the game loop
+// and reply is run with it through sendToDiscord, on the discordOut pool
+struct DiscordWho {
+    std::function<void(const std::string&)> reply;
+};
+
+// Anything else; runs on the game loop
+typedef std::function<void()> GameCallback;
+
+typedef std::variant<DiscordMessage, DiscordWho, GameCallback> GameEvent;
+
+#endif /*MAILBOX_H_*/
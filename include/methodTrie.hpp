@@ -0,0 +1,231 @@
+/*
+ * methodTrie.hpp
+ *   Case-folded prefix trie used to resolve commands, spells and songs
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+#ifndef METHODTRIE_HPP
+#define METHODTRIE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <strings.h>   // strcasecmp
+#include <utility>
+#include <vector>
+
+// A compressed (radix) trie over method names, folded to lower case. Methods are
+// inserted into one of several lists (general, player, staff, ...); every node
+// keeps, per list, the exact match ending at that node and the best partial match
+// anywhere beneath it, so a lookup only walks the typed prefix.
+//
+// The results are the same as the old examineList scan over the sorted sets:
+//  - an exact match in the first list (in list order) that has one wins
+//  - otherwise the lowest priority wins, then the shortest name, and any
+//    remaining tie bumps the match count
+template<class Method, std::size_t Lists>
+class MethodTrie {
+public:
+    typedef std::bitset<Lists> ListMask;
+
+    struct Result {
+        const Method* method = nullptr;
+        int match = 0;
+    };
+
+    MethodTrie() { clear(); }
+
+    void clear() {
+        nodes.clear();
+        nodes.emplace_back();
+    }
+
+    template<class Set>
+    void insertAll(std::size_t list, const Set& set) {
+        for(const auto& method : set)
+            insert(list, &method);
+    }
+
+    void insert(std::size_t list, const Method* method) {
+        std::string key = fold(method->getName());
+        if(key.empty())
+            return;
+
+        std::size_t node = 0, pos = 0;
+        while(pos < key.length()) {
+            std::size_t child = findChild(node, key[pos]);
+            if(child == npos) {
+                child = nodes.size();
+                nodes.emplace_back();
+                nodes[child].label = key.substr(pos);
+                addChild(node, child);
+                pos = key.length();
+            } else {
+                const std::string& label = nodes[child].label;
+                std::size_t common = 0;
+                while(common < label.length() && pos + common < key.length() && label[common] == key[pos + common])
+                    common++;
+
+                if(common < label.length())
+                    child = split(node, child, common);
+                pos += common;
+            }
+            consider(nodes[child].entries[list], method);
+            node = child;
+        }
+        if(!nodes[node].entries[list].exact)
+            nodes[node].entries[list].exact = method;
+    }
+
+    [[nodiscard]] Result find(std::string_view str, ListMask lists) const {
+        Result result;
+        if(str.empty() || nodes.empty())
+            return(result);
+
+        std::size_t node = 0, pos = 0;
+        bool exact = true;
+        while(pos < str.length()) {
+            std::size_t child = findChild(node, foldChar(str[pos]));
+            if(child == npos)
+                return(result);
+
+            const std::string& label = nodes[child].label;
+            std::size_t len = std::min(label.length(), str.length() - pos);
+            for(std::size_t i = 0; i < len; i++) {
+                if(label[i] != foldChar(str[pos + i]))
+                    return(result);
+            }
+            // The typed string ends part way along this edge
+            if(len < label.length())
+                exact = false;
+            pos += len;
+            node = child;
+        }
+
+        const auto& entries = nodes[node].entries;
+        if(exact) {
+            for(std::size_t list = 0; list < Lists; list++) {
+                if(lists.test(list) && entries[list].exact) {
+                    result.method = entries[list].exact;
+                    result.match = 1;
+                    return(result);
+                }
+            }
+        }
+
+        for(std::size_t list = 0; list < Lists; list++) {
+            const Entry& entry = entries[list];
+            if(!lists.test(list) || !entry.best)
+                continue;
+            int cmp = result.method ? compare(entry.best, result.method) : -1;
+            if(cmp < 0) {
+                result.method = entry.best;
+                result.match = entry.matches;
+            } else if(cmp == 0) {
+                result.match += entry.matches;
+            }
+        }
+        return(result);
+    }
+
+    [[nodiscard]] std::size_t size() const { return(nodes.size()); }
+
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct Entry {
+        const Method* exact = nullptr;  // Method whose whole name ends at this node
+        const Method* best = nullptr;   // Best partial match beneath this node
+        int matches = 0;                // How many methods tie with best
+    };
+
+    struct Node {
+        std::string label;
+        std::vector<std::pair<char, std::size_t>> children;
+        std::array<Entry, Lists> entries{};
+    };
+
+    std::vector<Node> nodes;
+
+    static char foldChar(char c) {
+        return(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+
+    static std::string fold(std::string_view str) {
+        std::string folded(str);
+        for(auto& c : folded)
+            c = foldChar(c);
+        return(folded);
+    }
+
+    // Priority, then name length; equal ranks are a tie
+    static int compare(const Method* a, const Method* b) {
+        if(a->priority != b->priority)
+            return(a->priority < b->priority ? -1 : 1);
+        std::size_t aLen = a->getName().length(), bLen = b->getName().length();
+        if(aLen != bLen)
+            return(aLen < bLen ? -1 : 1);
+        return(0);
+    }
+
+    static void consider(Entry& entry, const Method* method) {
+        int cmp = entry.best ? compare(method, entry.best) : -1;
+        if(cmp < 0) {
+            entry.best = method;
+            entry.matches = 1;
+        } else if(cmp == 0) {
+            entry.matches++;
+            // On a tie the set scan kept whichever came first alphabetically
+            if(strcasecmp(method->getName().c_str(), entry.best->getName().c_str()) < 0)
+                entry.best = method;
+        }
+    }
+
+    [[nodiscard]] std::size_t findChild(std::size_t node, char c) const {
+        for(const auto& [first, child] : nodes[node].children) {
+            if(first == c)
+                return(child);
+        }
+        return(npos);
+    }
+
+    void addChild(std::size_t node, std::size_t child) {
+        nodes[node].children.emplace_back(nodes[child].label[0], child);
+    }
+
+    // Break the edge leading to child after len characters; the new middle node
+    // covers exactly the same names as child, so it inherits its best matches.
+    std::size_t split(std::size_t parent, std::size_t child, std::size_t len) {
+        std::size_t mid = nodes.size();
+        nodes.emplace_back();
+        nodes[mid].label = nodes[child].label.substr(0, len);
+        nodes[mid].entries = nodes[child].entries;
+        for(auto& entry : nodes[mid].entries)
+            entry.exact = nullptr;
+        nodes[child].label.erase(0, len);
+        nodes[mid].children.emplace_back(nodes[child].label[0], child);
+
+        for(auto& [first, next] : nodes[parent].children) {
+            if(next == child)
+                next = mid;
+        }
+        return(mid);
+    }
+};
+
+#endif //METHODTRIE_HPP
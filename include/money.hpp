@@ -21,6 +21,8 @@
 
 #include <libxml/parser.h>  // for xmlNodePtr
 
+#include "changeWatch.hpp"  // for ChangeWatch
+
 
 enum Coin {
     MIN_COINS = 0,
@@ -61,8 +63,10 @@ public:
     [[nodiscard]] std::string str() const;
 
     static std::string coinNames(Coin c);
+    void watchChanges(unsigned long* counter);
 protected:
     unsigned long m[MAX_COINS+1]{};
+    ChangeWatch changes;
 };
 
 
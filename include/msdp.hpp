@@ -24,6 +24,9 @@
 
 #include "timer.hpp"
 
+#define MSDP_REFRESH    30      // Seconds before a watched variable is worked out again, changed or not
+
+class Creature;
 class Socket;
 class Player;
 class MsdpBuilder;
@@ -44,6 +47,8 @@ protected:
     int updateInterval{};      // Update interval (in 10ths of a second)
     bool updateable{};         // Does this have an update function?
     bool isGroup{};            // Is this a group of related variables?
+    int watches{};             // CHANGE_MASK of the player's state this is worked out from; 0 = poll it
+    int targetWatches{};       // ...and of their target's state
 
     std::function<std::string(Socket&, Player*)> valueFn{nullptr}; // Function to send the variable
 
@@ -61,6 +66,7 @@ public:
     [[nodiscard]] bool isWriteOnce() const;
     [[nodiscard]] bool getRequiresPlayer() const;
     [[nodiscard]] int getUpdateInterval() const;
+    [[nodiscard]] bool isWatched() const;
 
     bool send(Socket &sock) const;
 
@@ -74,6 +80,14 @@ protected:
 
     Timer timer;
 
+    // What the value was last worked out from, if this variable is watched
+    const Player* seenPlayer = nullptr;
+    const Creature* seenTarget = nullptr;
+    unsigned long seenChanges = 0;
+    time_t seenAt = 0;
+
+    [[nodiscard]] unsigned long countChanges(const Player* player) const;
+
 public:
     ReportedMsdpVariable(const ReportedMsdpVariable&) = default;
     ReportedMsdpVariable(const MsdpVariable *mv, Socket *sock);
@@ -83,6 +97,8 @@ public:
     void setValue(int newValue);
     void setValue(long newValue);
     bool checkTimer();       // True = ok to send, False = timer hasn't expired yet
+    [[nodiscard]] bool isStale(const Player* player, time_t now) const;   // Anything it watches changed?
+    void markSeen(const Player* player, time_t now);
 
     [[nodiscard]] bool isDirty() const;
     void update();
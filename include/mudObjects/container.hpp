@@ -28,6 +28,7 @@ class BaseRoom;
 class Containable;
 class Container;
 class EffectInfo;
+class KeyIndex;
 class Monster;
 class MudObject;
 class Object;
@@ -59,7 +60,9 @@ typedef std::set<Object*, ObjectPtrLess> ObjectSet;
 class Container : public virtual MudObject {
 public:
     Container();
-    ~Container() override = default;
+    Container(const Container& c);              // The key index isn't copied; it's built again if needed
+    Container& operator=(const Container& c);
+    ~Container() override;
 
     PlayerSet players;
     MonsterSet monsters;
@@ -109,6 +112,11 @@ public:
     MudObject* findTarget(const Creature* searcher,  const std::string& name, int num, bool monFirst= true, bool firstAggro = false, bool exactMatch = false) const;
     MudObject* findTarget(const Creature* searcher,  const std::string& name, int num, bool monFirst, bool firstAggro, bool exactMatch, int& match) const;
 
+protected:
+    KeyIndex* useKeyIndex(const std::string& name, bool exactMatch, size_t size) const;
+
+private:
+    mutable KeyIndex* keyIndex = nullptr;  // Only made for containers big enough to need one
 };
 
 class Containable : public virtual MudObject {
@@ -18,13 +18,16 @@
 
 #pragma once
 
+#include <array>
 #include <map>
 #include <string>
+#include <vector>
 #include <fmt/format.h>
 
 #include "mudObjects/container.hpp"
 #include "mudObjects/mudObject.hpp"
 #include "carry.hpp"
+#include "changeWatch.hpp"
 #include "creatureStreams.hpp"
 #include "damage.hpp"
 #include "enums/loadType.hpp"
@@ -82,6 +85,7 @@ class TalkResponse;
 class QuestInfo;
 class QuestCompletion;
 class QuestCompleted;
+class QuestIndex;
 class QuestCatRef;
 class SpellData;
 
@@ -213,6 +217,8 @@ protected:
     Group* group{};
     GroupStatus groupStatus;
 
+    std::array<unsigned long, CHANGE_COUNT> changes{};  // Bumped on every change of each kind; see changeWatch.hpp
+
 
 public:
 // Constructors, Deconstructors, etc
@@ -283,7 +289,8 @@ public:
 // Data
     std::string plural;
     std::map<std::string, long> factions;
-    SkillMap skills;
+    SkillMap skills;                // Owns the skills, ordered by name
+    std::vector<Skill*> skillTable; // The same skills indexed by SkillInfo id
     char key[3][CRT_KEY_LENGTH]{};
     short fd{}; // Socket number
     short current_language{};
@@ -383,8 +390,11 @@ public:
     double getSkillGained(const std::string& skillName, bool useBase = true) const; // *
     double getTradeSkillGained(const std::string& skillName, bool useBase = true) const; // *
     Skill* getSkill(const std::string& skillName, bool useBase = true) const;
+    Skill* getSkillById(int skillId, bool useBase = true) const;
     void addSkill(const std::string& skillName, int gained); // *
+    bool insertSkill(Skill* skill);
     void remSkill(const std::string& skillName); // *
+    void clearSkills();
     void checkSkillsGain(const std::list<SkillGain*>::const_iterator& begin, const std::list<SkillGain*>::const_iterator& end, bool setToLevel = false);
     void checkImprove(const std::string& skillName, bool success, int attribute = INT, int bns = 0); // *
     bool setSkill(const std::string& skill, int gained); // *
@@ -620,6 +630,8 @@ public:
     void subAlignment(unsigned short a); // *
     void setArmor(unsigned int a);
     void setAttackPower(unsigned int a);
+    void stateChanged(StateChange change);
+    [[nodiscard]] unsigned long getChanges(unsigned int mask) const;   // Sum of the counters in a CHANGE_MASK
     void setDeity(unsigned short d);
     void setSize(Size s);
     void setType(unsigned short t);
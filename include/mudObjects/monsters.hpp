@@ -45,6 +45,9 @@ public:
     Monster& operator=(const Monster& cr);
     bool operator< (const Monster& t) const;
     ~Monster();
+    // Allocated from a TypePool (see pool.hpp)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
     void readXml(xmlNodePtr curNode, bool offline=false);
     void saveXml(xmlNodePtr curNode) const;
     int saveToFile();
@@ -48,6 +48,7 @@ public:
     void setName(std::string_view newName);
     [[nodiscard]] const std::string & getName() const;
     [[nodiscard]] const char* getCName() const;
+    void keysChanged();     // After writing to key[] directly, so whatever holds us can find us by them
 
 protected:
     virtual void removeFromSet();
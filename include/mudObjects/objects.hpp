@@ -123,6 +123,9 @@ public:
 public:
     Object();
     ~Object() override;
+    // Allocated from a TypePool (see pool.hpp)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
     Object& operator=(const Object& o);
     [[nodiscard]] std::string getCompareStr() const ;
     bool operator==(const Object& o) const;
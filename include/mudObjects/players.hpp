@@ -113,6 +113,8 @@ protected:
     KnownAlchemyEffectsMap knownAlchemyEffects;
 
     bool fleeing = false;
+    QuestIndex* questIndex = nullptr;   // Made the first time a kill, pickup or room needs it
+    QuestIndex* getQuestIndex();
 
 public:
     std::string getFlagList(std::string_view sep=", ") const;
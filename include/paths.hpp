@@ -18,6 +18,7 @@
 #ifndef PATHS_H_
 #define PATHS_H_
 
+#include <string>       // for string
 
 class CatRef;
 
@@ -64,6 +65,7 @@ namespace Path {
     bool checkDirExists(const std::string &area, char* (*fn)(const CatRef &cr));
 
     bool checkPaths();
+    void setRoot(const std::string& root);
 }
 
 
@@ -0,0 +1,87 @@
+/*
+ * pool.hpp
+ *   Fixed size allocation for the types the game makes and throws away most
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <cstddef>      // for size_t
+#include <vector>       // for vector
+
+#define POOL_CHUNK_BYTES    65536   // Carved into blocks for one type at a time
+
+// Sanitizer builds (LEAK=1) start out using the system allocator so every
+// object is its own allocation and use-after-free is caught; the counts are
+// still kept. See TypePool::setSystemAlloc.
+#if !defined(POOL_SYSTEM_ALLOC) && defined(__SANITIZE_ADDRESS__)
+#define POOL_SYSTEM_ALLOC
+#endif
+#if !defined(POOL_SYSTEM_ALLOC) && defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define POOL_SYSTEM_ALLOC
+#endif
+#endif
+
+struct PoolStats {
+    const char* name;
+    size_t blockSize;
+    unsigned long live;     // Allocated right now
+    unsigned long peak;     // Most ever allocated at once
+    unsigned long allocs;   // Ever
+    size_t reserved;        // Bytes held in chunks
+    bool systemAlloc;       // Every block is its own system allocation
+};
+
+// Blocks of one size for one type, used by its class operator new/delete.
+// Freed blocks go on a free list for the next one; chunks are kept for the
+// life of the server, since what was busy once will be busy again. Anything
+// of another size (a derived class) goes to the system allocator.
+//
+// Pools are made with getPool and never destroyed, so objects can be freed
+// at any point during shutdown. Monsters, objects and effects are only made
+// and freed on the game thread, so a pool has no lock of its own.
+class TypePool {
+public:
+    static TypePool* getPool(const char* pName, size_t pSize);
+    static std::vector<PoolStats> getAllStats();
+
+    // Pools made from now on use the system allocator for every block instead
+    // of chunks; on by default when POOL_SYSTEM_ALLOC is defined. A pool keeps
+    // the setting it was made with, so each block goes back where it came from.
+    static void setSystemAlloc(bool system);
+    static bool getSystemAlloc();
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+    [[nodiscard]] PoolStats getStats();
+
+private:
+    TypePool(const char* pName, size_t pSize);
+
+    const char* name;
+    size_t objectSize;
+    size_t blockSize;
+    bool systemAlloc;
+
+    void* freeList = nullptr;           // Each free block holds the next one
+    std::vector<void*> chunks;
+    unsigned long live = 0;
+    unsigned long peak = 0;
+    unsigned long allocs = 0;
+};
+
+#endif /*POOL_H_*/
@@ -5,10 +5,12 @@
 #ifndef REALMSCODE_PROC_H
 #define REALMSCODE_PROC_H
 
+#include <functional>
 #include <string>
+#include <string_view>
+#include <utility>
 
 enum class ChildType {
-    DNS_RESOLVER,
     LISTER,
     DEMOGRAPHICS,
     SWAP_FIND,
@@ -18,23 +20,30 @@ enum class ChildType {
 
 };
 
+struct childProcess;
+
+// Called from the main loop with whatever output the child has written so far;
+// onReap is true for the last call, after the child has exited.
+typedef std::function<void(childProcess& child, bool onReap)> ChildHandler;
 
 struct childProcess {
     int pid;
     ChildType type;
     int fd; // Fd if any we should watch
     std::string extra;
+    ChildHandler handler;
     childProcess() {
         pid = 0;
         fd = -1;
         extra = "";
         type = ChildType::UNKNOWN;
     }
-    childProcess(int p, ChildType t, int f = -1, std::string_view e = "") {
+    childProcess(int p, ChildType t, int f = -1, std::string_view e = "", ChildHandler h = nullptr) {
         pid = p;
         type = t;
         fd = f;
         extra = e;
+        handler = std::move(h);
     }
 };
 
@@ -0,0 +1,138 @@
+/*
+ * profiler.hpp
+ *   Per-phase timing of the main loop
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <array>        // for array
+#include <chrono>       // for steady_clock
+#include <ctime>        // for time_t
+#include <deque>        // for deque
+#include <string>       // for string
+#include <vector>       // for vector
+
+#define PROFILE_BUCKETS         25      // Histogram buckets; bucket n holds times under 2^n microseconds
+#define PROFILE_WINDOW          60      // Seconds each histogram covers before it's rolled over
+#define PROFILE_SLOW_FRAMES     32      // Slow frames we keep the details of
+#define PROFILE_FRAME_NOTES     64      // Commands and hooks noted per frame at most
+#define PROFILE_TRACE_FRAMES    300     // Frames kept for the trace dump
+
+enum ProfilePhase {
+    PROF_FRAME,         // The whole frame, not counting the sleep
+    PROF_CHILDREN,
+    PROF_POLL,
+    PROF_DNS,
+    PROF_ASYNC,
+    PROF_MAILBOX,
+    PROF_CHECK_NEW,
+    PROF_INPUT,
+    PROF_COMMANDS,
+    PROF_COMBAT,
+    PROF_GAME,
+    PROF_GAME_SECOND,   // updateGame: once-a-second bookkeeping
+    PROF_GAME_TICKS,    // updateGame: pulseTicks
+    PROF_GAME_EFFECTS,  // updateGame: pulseEffects
+    PROF_GAME_RANDOM,   // updateGame: updateRandom
+    PROF_GAME_ACTIVE,   // updateGame: updateActive
+    PROF_GAME_SHIPS,    // updateGame: updateShips
+    PROF_MSDP,
+    PROF_OUTPUT,
+    PROF_CLEANUP,
+    PROF_WEB,
+
+    PROF_PHASE_COUNT
+};
+
+// Times spent in each phase of the main loop, bucketed by powers of two so
+// they're cheap to keep. Frames that run long are kept along with what ran in
+// them, and the last few hundred frames can be dumped in Chrome's trace event
+// format (load it in chrome://tracing or ui.perfetto.dev). Main thread only.
+class Profiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Profiler();
+
+    void startFrame();
+    void endFrame(long slowAfter);  // Microseconds; longer frames are kept
+    void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end);
+    void note(std::string text);    // A command or hook that ran this frame
+    void reset();
+
+    [[nodiscard]] std::string getReport() const;
+    [[nodiscard]] std::string getSlowFrames() const;
+    bool writeTrace(const std::string& filename) const;
+
+    static const char* getPhaseName(ProfilePhase phase);
+
+private:
+    struct Histogram {
+        std::array<unsigned long, PROFILE_BUCKETS> buckets{};
+        unsigned long count = 0;
+        long total = 0;
+        long max = 0;
+
+        void add(long micros);
+        void merge(const Histogram& other);
+        [[nodiscard]] long percentile(int pct) const;
+    };
+    struct Span {
+        ProfilePhase phase;
+        long start;     // Microseconds since the profiler started
+        long length;
+    };
+    struct SlowFrame {
+        time_t when;
+        long length;
+        std::array<long, PROF_PHASE_COUNT> phases;
+        std::vector<std::string> notes;
+    };
+
+    [[nodiscard]] long sinceEpoch(Clock::time_point point) const;
+
+    Clock::time_point epoch;
+    Clock::time_point frameStart;
+    time_t windowStart;
+
+    std::array<Histogram, PROF_PHASE_COUNT> current;
+    std::array<Histogram, PROF_PHASE_COUNT> previous;   // The last full window
+
+    std::array<long, PROF_PHASE_COUNT> framePhases{};
+    std::vector<std::string> frameNotes;
+    std::vector<Span> frameSpans;
+
+    std::deque<SlowFrame> slowFrames;
+    std::deque<std::vector<Span>> trace;
+};
+
+// Times the enclosing block as one phase
+class ProfileScope {
+public:
+    ProfileScope(Profiler& pProfiler, ProfilePhase pPhase);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& profiler;
+    ProfilePhase phase;
+    Profiler::Clock::time_point start;
+};
+
+#endif /*PROFILER_H_*/
@@ -63,6 +63,10 @@ unsigned int standardPoisonDuration(short level, short con);
 int reloadCalendar(Player* player);
 
 
+// color.cpp
+CustomColor getCustomColorToken(std::string_view token);
+
+
 // commerce.cpp
 CatRef shopStorageRoom(const UniqueRoom *shop);
 
@@ -95,8 +99,10 @@ namespace Pueblo {
 
 char keyTxtConvert(unsigned char c);
 std::string keyTxtConvert(std::string_view txt);
+bool keyTxtCompare(const char* key, const char* txt, int tLen);
 bool keyTxtEqual(const Creature* target, const char* txt);
 bool keyTxtEqual(const Object* target, const char* txt);
+std::string keyTxtNormalize(const char* key);
 bool isPrintable(char c);
 
 
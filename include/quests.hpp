@@ -21,6 +21,9 @@
 
 #include <list>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "catRef.hpp"
 #include "money.hpp"
@@ -28,6 +31,7 @@
 class Player;
 class Monster;
 class Object;
+class QuestCompletion;
 class UniqueRoom;
 
 class QuestCatRef : public CatRef {
@@ -121,6 +125,7 @@ private:
     std::map<std::string,long> factionRewards;  // Factions to be modified
 
     friend class QuestCompletion;
+    friend class QuestIndex;
 };
 
 // Class to keep track of what has been completed on a given quest for a player so far
@@ -150,10 +155,14 @@ private:
     bool mobsCompleted;
     bool itemsCompleted;
     bool roomsCompleted;
+
+    friend class QuestIndex;
 public:
-    void updateMobKills(Monster* monster);
-    void updateItems(Object* object);
-    void updateRooms(UniqueRoom* room);
+    // wanted is false when the quest doesn't care about this one; it only
+    // checks for completion then, the same as when nothing matched
+    void updateMobKills(Monster* monster, bool wanted = true);
+    void updateItems(Object* object, bool wanted = true);
+    void updateRooms(UniqueRoom* room, bool wanted = true);
     std::string getStatusDisplay();
 
     bool checkQuestCompletion(bool showMessage = true);
@@ -164,6 +173,50 @@ public:
     bool complete(Monster* monster);
 };
 
+// Which of a player's quests want each monster, object and room, so a kill,
+// pickup or room entry only runs through the quests it matters to. While
+// one is being handled, it also holds how many of each wanted object the
+// player carries, counted in one pass over their inventory instead of once
+// for every item objective of every quest.
+//
+// It's checked against the quest book before each use and built again if
+// anything was accepted, completed, abandoned or loaded, or if the quests
+// themselves were reloaded.
+class QuestIndex {
+public:
+    typedef std::set<QuestCompletion*> QuestSet;
+
+    void sync(const std::map<int, QuestCompletion*>& quests);
+    [[nodiscard]] const QuestSet* getMobQuests(const CatRef& mob) const;
+    [[nodiscard]] const QuestSet* getItemQuests(const CatRef& obj) const;
+    [[nodiscard]] const QuestSet* getRoomQuests(const CatRef& room) const;
+
+    void startCounting(const Player* player);
+    void stopCounting();
+    bool getCount(const CatRef& obj, int& count) const;   // False if not counting it
+
+    static void questsReloaded();
+
+private:
+    typedef std::unordered_map<CatRef, QuestSet> RefQuests;
+    static const QuestSet* find(const RefQuests& refs, const CatRef& ref);
+
+    struct Entry {
+        int id;
+        QuestCompletion* quest;
+    };
+    std::vector<Entry> indexed;     // The quest book as of the last build
+    unsigned long generation = 0;
+    static unsigned long lastGeneration;
+
+    RefQuests mobs;
+    RefQuests items;
+    RefQuests rooms;
+
+    bool counting = false;
+    std::unordered_map<CatRef, int> counts;
+};
+
 class QuestCompleted {
 private:
     int times{};
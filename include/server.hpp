@@ -19,28 +19,31 @@
 #ifndef SERVER_H_
 #define SERVER_H_
 
-#ifdef SQL_LOGGER
-
-namespace odbc {
-    class Connection;
-}
-
-#endif //SQL_LOGGER
-
+#include <chrono>
+#include <ctime>
 #include <list>
 #include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // C Includes
 #include <netinet/in.h> // Needs: htons, htonl, INADDR_ANY, sockaddr_in
 
 #include "catRef.hpp"
+#include "channelIndex.hpp"
 #include "delayedAction.hpp"
 #include "free_crt.hpp"
 #include "money.hpp"
 #include "proc.hpp"
+#include "profiler.hpp"
+#include "serverTimer.hpp"
 #include "swap.hpp"
 #include "weather.hpp"
+#include "mailbox.hpp"
+#include "socketSlab.hpp"
 #include "lru/lru.hpp"
 
 namespace pybind11 {
@@ -54,7 +57,10 @@ class BaseRoom;
 class UniqueRoom;
 class MapMarker;
 class Creature;
+class DnsResolver;
+class EffectInfo;
 class Group;
+class GoldLogWriter;
 class Monster;
 class MsdpVariable;
 class Object;
@@ -63,6 +69,7 @@ class PythonHandler;
 class ReportedMsdpVariable;
 class Socket;
 class WebInterface;
+class WebNotifier;
 
 namespace dpp {
     class cluster;
@@ -81,6 +88,9 @@ struct FreeCrt {
 		void operator()( Monster* mon ) { free_crt((Creature*)mon); }
 };
 
+// How long a reverse lookup stays in the DNS cache (15 days)
+#define DNS_CACHE_TTL   (60*60*24*15)
+
 enum GoldLog {
     GOLD_IN,
     GOLD_OUT
@@ -97,14 +107,31 @@ struct idComp : public std::binary_function<const std::string&, const std::strin
 typedef std::map<std::string, MudObject*,idComp> IdMap;
 using MonsterList = std::list<Monster*>;
 using GroupList = std::list<Group*>;
-using SocketList = std::list<Socket>;
+using SocketList = SocketSlab;
 using SocketVector= std::vector<Socket*>;
 using PlayerMap = std::map<std::string, Player*>;
+using EffectQueue = std::set<std::tuple<time_t, int, EffectInfo*>>; // Due, tick slot, effect
 
 using RoomCache = LRU::lru_cache<CatRef, UniqueRoom, CleanupRoomFn, CanCleanupRoomFn>;
 using MonsterCache = LRU::lru_cache<CatRef, Monster, FreeCrt>;
 using ObjectCache = LRU::lru_cache<CatRef, Object>;
 
+#define TICK_SLOTS      60      // A game second is split into this many slots, see TickSlice
+
+// The share of a game second one frame is responsible for. Once-a-second work
+// over a list (players, active monsters, effects...) hashes each entry into
+// one of TICK_SLOTS slots and only handles the ones in the frame's range, so
+// the work is spread over the frames of the second instead of landing in one.
+struct TickSlice {
+    long    t = 0;              // The game second being spread out
+    int     begin = 0;          // Slots [begin, end)
+    int     end = TICK_SLOTS;
+
+    static int slotOf(const void* ptr);
+    [[nodiscard]] bool contains(const void* ptr) const;
+    [[nodiscard]] bool isFirst() const;
+};
+
 class Server {
     friend class PythonHandler;
 // **************
@@ -147,11 +174,14 @@ public:
             return(ip == o.ip && hostName == o.hostName);
         }
     };
+    typedef std::unordered_map<std::string, dnsCache> DnsCacheMap;
 
 public:
     PlayerMap players; // Map of all players
+    ChannelIndex channels; // Who hears each global channel; kept in step with players
     SocketList sockets; // List of all connected sockets
-    SocketVector* vSockets = nullptr;
+    SocketVector vSockets;  // This frame's sockets, in this frame's order
+    bool vSocketsReady = false;
 
     RoomCache roomCache;
     MonsterCache monsterCache;
@@ -166,6 +196,10 @@ private:
     PythonHandler* pythonHandler;
 
     std::list<BaseRoom*> effectsIndex;
+    EffectQueue effectQueue;    // Effects waiting to be pulsed, ordered by when they're next due
+    long effectsPulsed = 0;     // Effects pulsed so far this second
+    long lastEffectsPulsed = 0; // Effects pulsed in the last second
+    long peakEffectsPulsed = 0;
 
     fd_set inSet{};
     fd_set outSet{};
@@ -190,21 +224,37 @@ private:
     bool idDirty;
 
     std::list<childProcess> children; // List of child processes
+    std::vector<int> unreaped; // Children that closed their pipe before exiting; waited on until they do
     std::list<controlSock> controlSocks; // List of control fds
-    std::list<dnsCache> cachedDns; // Cache of DNS lookups
+    DnsCacheMap cachedDns; // Cache of DNS lookups, keyed by ip
+    DnsResolver* resolver = nullptr; // Started on the first lookup
+    AsyncPool* asyncPool = nullptr; // Started on the first job
+    AsyncPool* compressPool = nullptr; // MCCP deflate thread, when MccpThread is set
+    WebNotifier* webNotifier = nullptr; // Started on the first callWebserver
     WebInterface* webInterface;
     dpp::cluster *discordBot{};
     dpp::commandhandler *commandHandler{};
+    AsyncPool* discordOut = nullptr; // Sends to Discord in order, so the game loop never waits on it
+    Mailbox<GameEvent> mailbox; // Events from other threads, handled once a frame
 
     // Game Updates
     MonsterList activeList; // The new active list
 
-    long lastDnsPrune;
     long lastUserUpdate;
-    long lastRoomPulseUpdate;
     long lastRandomUpdate;
     long lastActiveUpdate;
 
+    // Frame scheduling
+    ServerTimer timer;
+    Profiler profiler;
+    TickSlice tickSlice;        // This frame's share of the current game second
+    std::chrono::steady_clock::time_point tickStart;    // When the current game second began
+    int tickDone = TICK_SLOTS;  // Slots of the current game second handled so far
+    bool tickPulse = false;     // What's due this game second
+    bool tickShips = false;
+    bool tickRandom = false;
+    bool tickActive = false;
+
 public:
     std::list<Area*> areas;
 
@@ -213,6 +263,9 @@ public:
 private:
     bool initDiscordBot();
     void cleanupDiscordBot();
+    void handleDiscordMessage(const DiscordMessage& message);
+    void handleDiscordWho(const DiscordWho& who);
+    void sendToDiscord(std::function<void()> job);
 
     size_t getNumSockets() const; // Get number of sockets in the sockets list
 
@@ -224,23 +277,27 @@ private:
     int processCommands(); // Process commands from users
     int updatePlayerCombat(); // Handle player auto attacks etc
     int processChildren();
-    int processListOutput(const childProcess &lister);
+    int processDns(); // Collect finished DNS lookups
+    int processAsync(); // Run callbacks for finished async jobs
+    int processMailbox(); // Handle events posted by other threads
+    int processListOutput(const childProcess &lister, SocketHandle requester = SocketHandle());
 
     // Child processes
     int reapChildren(); // Clean up after any dead children
+    ChildHandler childHandler(ChildType type);
 
     // Reboot
     bool saveRebootFile(bool resetShips = false);
 
     // Updates
     void updateGame();
+    void runTickSlots(int due);
     void processMsdp();
-    void pulseTicks(long t);
-    void pulseCreatureEffects(long t);
-    void pulseRoomEffects(long t);
+    void pulseTicks(const TickSlice& slice);
+    void pulseEffects(const TickSlice& slice);
     void updateUsers(long t);
-    void updateRandom(long t);
-    void updateActive(long t);
+    void updateRandom(const TickSlice& slice);
+    void updateActive(const TickSlice& slice);
     void updateTrack(long t);
     void updateShips(long n=0);
 
@@ -251,7 +308,6 @@ private:
     void addCache(std::string_view ip, std::string_view hostName, time_t t = -1);
     void saveDnsCache();
     void loadDnsCache();
-    void pruneDns();
 
     int installPrintfHandlers();
     static void installSignalHandlers();
@@ -262,17 +318,15 @@ private:
 protected:
     void parseDelayedActions(long t);
 
-#ifdef SQL_LOGGER
-
+    // Gold log
 protected:
-    odbc::Connection* conn;
-    bool connActive;
-    void cleanUpSql();
-    bool initSql();
-    bool logGoldSql(std::string& pName, std::string& pId, std::string& targetStr, std::string& source, std::string& room,
-                    std::string& logType, unsigned long amt, std::string& direction);
+    GoldLogWriter* goldLog = nullptr; // Started in init if there's somewhere to write it
+    void initGoldLog();
 
 public:
+    void stopGoldLog(); // Flush or journal what's queued; before exiting or rebooting
+    [[nodiscard]] const GoldLogWriter* getGoldLog() const;
+#ifdef SQL_LOGGER
     bool getConnStatus();
     int getConnTimeout();
 #endif // SQL_LOGGER
@@ -282,6 +336,9 @@ public:
 
     void clearAsEnemy(Player* player);
     std::string showActiveList();
+    std::string getFrameStats() const;
+    [[nodiscard]] long getLastFrameTime() const;
+    Profiler& getProfiler();
 
     static void logGold(GoldLog dir, Player* player, Money amt, MudObject* target, std::string_view logType);
 
@@ -346,7 +403,11 @@ public:
     void showMemory(Socket* sock, bool extended=false);
 
     // Child processes
-    void addChild(int pid, ChildType pType, int pFd = -1, std::string_view pExtra = "");
+    void addChild(int pid, ChildType pType, int pFd = -1, std::string_view pExtra = "", ChildHandler handler = nullptr);
+    void runAsync(AsyncJob job);
+    void postEvent(GameEvent event); // Any thread: have the game loop handle it next frame
+    AsyncPool* getCompressPool();
+    bool notifyWebserver(std::string_view url, std::string_view userAgent);
 
 
     // Setup
@@ -357,6 +418,8 @@ public:
     void setValgrind();
 
     int run(); // Run the server
+    void runOnce(); // Run a single frame of the main loop
+    [[nodiscard]] bool isRunning() const;
     int addListenPort(int); // Add a new port to listen to
 
     // Status
@@ -423,6 +486,9 @@ public:
     void removeEffectsIndex(BaseRoom* room);
     void removeEffectsOwner(const Creature* owner);
     void showEffectsIndex(const Player* player);
+    void scheduleEffect(EffectInfo* effect, time_t due);
+    void unscheduleEffect(EffectInfo* effect, time_t due);
+    void clearEffectQueue();
 
     // Python
     bool runPython(const std::string& pyScript, py::object& dictionary);
@@ -19,19 +19,36 @@
 #ifndef SERVERTIMER_H_
 #define SERVERTIMER_H_
 
-#include <ctime>    // timeval
+#include <chrono>   // for steady_clock
+#include <vector>   // for vector
 
+#define FRAME_HISTORY   600     // Frames kept for the frame time percentiles
+
+// Times the work done in each frame and sleeps out the rest of it. Frames are
+// scheduled against the monotonic clock, so a slow frame doesn't push every
+// frame after it back; if we fall behind by more than a frame we start over
+// from now instead of bunching frames up to catch up.
 class ServerTimer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
 protected:
-    struct timeval timePassed; // How much time passed
-    struct timeval startTime; // Time we started the timer
-    struct timeval endTime;  // Time we finished the timer
-    bool running; // Is the timer running? If so timePassed not valid
-    void reset();
+    Clock::time_point startTime;    // Time we started the timer
+    Clock::time_point nextFrame;    // When the next frame is due to start
+    long timePassed = 0;            // Microseconds of work in the last frame
+    bool running = false;           // Is the timer running? If so timePassed not valid
+
+    std::vector<long> history;      // Microseconds of work in the last FRAME_HISTORY frames
+    size_t historyPos = 0;
+
 public:
     void start();
     void end();
-    void sleep();
+    void sleep(long frameLength);  // Microseconds per frame
+
+    [[nodiscard]] long getLast() const;
+    [[nodiscard]] long getPercentile(int pct) const;
+    [[nodiscard]] size_t getSamples() const;
 };
 
 
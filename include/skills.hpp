@@ -70,6 +70,7 @@ std::string getSkillLevelStr(int gained);
 class SkillInfo : public virtual Nameable {
     friend class Skill;
     friend class SkillInfoBuilder;
+    friend class Config;        // Config assigns ids when loading skills
 public:
     SkillInfo();
     SkillInfo(const SkillInfo&) = delete; // No Copies
@@ -83,6 +84,8 @@ protected:
     std::string displayName;            // Display name
     SkillGainType gainType;             // Adjustments for skills with long timers
     bool knownOnly;
+    int id = -1;                        // Dense id, indexes Creature::skillTable
+    int baseSkillId = -1;
 
 public:
     [[nodiscard]] const std::string & getGroup() const;
@@ -91,6 +94,8 @@ public:
     [[nodiscard]] SkillGainType getGainType() const;
     [[nodiscard]] bool isKnownOnly() const;
     [[nodiscard]] bool hasBaseSkill() const;
+    [[nodiscard]] int getId() const;
+    [[nodiscard]] int getBaseSkillId() const;
 
 };
 
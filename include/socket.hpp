@@ -20,20 +20,23 @@
 #define SOCKET_H_
 
 // C Includes
-#include <zlib.h>
 #include <netinet/in.h>
 
 // C++ Includes
+#include <chrono>
 #include <list>
 #include <map>
+#include <memory>
 #include <queue>
 #include <vector>
 #include <string>
 #include <fmt/format.h>
 
 #include "msdp.hpp"                                 // for ReportedMsdpVariable
+#include "socketSlab.hpp"                           // for SocketHandle
 
 // Defines needed
+#define SOCKET_READ_MAX     16384   // Bytes read from one socket per tick at most
 
 #define NAWS TELOPT_NAWS
 #define TTYPE TELOPT_TTYPE
@@ -44,6 +47,7 @@ extern long InBytes;
 extern long UnCompressedBytes;
 extern long OutBytes;
 
+class CompressStream;
 class Player;
 
 typedef struct _xmlNode xmlNode;
@@ -123,15 +127,11 @@ namespace telnet {
 
 
     extern unsigned const char eor_str[];
-
-
-    // For MCCP
-    void *zlib_alloc(void *opaque, unsigned int items, unsigned int size);
-    void zlib_free(void *opaque, void *address);
 }
 
 class Socket {
     friend class Server;
+    friend class SocketSlab;
     struct Host {
         std::string hostName;
         std::string ip;
@@ -160,9 +160,27 @@ class Socket {
         bool            charset;
         bool            utf8;
     };
+    struct InputLine {
+        std::string     line;
+        std::chrono::steady_clock::time_point queued;
+    };
+public:
+    struct InputStats {
+        size_t          peakDepth;      // Most commands waiting at once
+        unsigned long   commands;       // Commands run
+        long            totalWait;      // Milliseconds between being read and being run
+        long            maxWait;
+    };
+    struct MsdpStats {
+        unsigned long   checked;        // Reported variables looked at
+        unsigned long   computed;       // ...that had to be worked out again
+        unsigned long   sent;           // ...that had changed and were sent
+        unsigned long   bytes;
+    };
 
 private:
     static int numSockets;
+    SocketHandle handle;    // Set by the slab it's in
 
 public:
     // Static Methods
@@ -228,6 +246,8 @@ public:
 
     int startCompress(bool silent = false);
     int endCompress();
+    void checkCompress(time_t t);   // Send what's been compressed, and restart or release the stream
+    [[nodiscard]] std::string getCompressInfo() const;
 
     int sendMSSP(); // Send MSSP Variables
 
@@ -237,6 +257,7 @@ public:
 // End Telopt related
 
     [[nodiscard]] int getFd() const;
+    [[nodiscard]] SocketHandle getHandle() const;   // For holding on to it past this frame
     [[nodiscard]] bool isConnected() const;
     [[nodiscard]] int getState() const;
     [[nodiscard]] std::string_view getIp() const;
@@ -248,7 +269,14 @@ public:
     void setIp(std::string_view pIp);
 
     [[nodiscard]] bool hasOutput() const;
+    [[nodiscard]] bool hasCompressor() const;
     [[nodiscard]] bool hasCommand() const;
+    [[nodiscard]] size_t getInputDepth() const;
+    [[nodiscard]] const InputStats& getInputStats() const;
+    [[nodiscard]] const MsdpStats& getMsdpStats() const;
+
+    void refillCommandTokens(int rate, int burst);
+    bool takeCommandToken();
 
     [[nodiscard]] long getIdle() const;
     [[nodiscard]] int mccpEnabled() const;
@@ -290,6 +318,7 @@ public:
     // MSDP Support Functions
     ReportedMsdpVariable *getReportedMsdpVariable(const std::string &value);
     bool msdpSendPair(std::string_view variable, std::string_view value);
+    void msdpSendChanges(time_t now);
     void msdpSendList(std::string_view variable, const std::vector<std::string>& values);
     void msdpClearReporting();
     std::string getMsdpReporting();
@@ -299,7 +328,9 @@ protected:
     bool negotiate(unsigned char ch);
     //bool subNegotiate(unsigned char ch);
     bool handleNaws(int& colRow, unsigned char& chr, bool high);
-    size_t processCompressed(); // Mccp
+    ssize_t sendCompressed(); // Mccp
+    void restartCompress();
+    void noteOutput(size_t bytes);
 
     bool parseMXPSecure();
 
@@ -337,7 +368,9 @@ protected:
     std::string     output;
     std::string     processedOutput;   // Output that has been processed but not fully sent (in the case of EWOULDBLOCK for example)
 
-    std::queue<std::string> input;      // Processed Input buffer
+    std::queue<InputLine> input;        // Processed Input buffer
+    InputStats  inputStats{};
+    int         cmdTokens{};            // Commands this socket may still run this tick
 
     // IAC buffer, we make it a vector so that it will handle NUL bytes and other characters and still report the correct size()/length()
     std::vector<unsigned char>  cmdInBuf;
@@ -348,8 +381,13 @@ protected:
 
 
 // For MCCP
-    char        *outCompressBuf{};
-    z_stream    *outCompress{};
+    std::shared_ptr<CompressStream> compressor;
+    std::string compressedOut;      // Compressed output the socket wouldn't take yet
+    bool        compressBusy{};     // Using the busy profile
+    bool        compressIdle{};     // Stream released until there's output again
+    time_t      lastOutput{};
+    time_t      outputWindowStart{};
+    unsigned long outputWindowBytes{};  // Uncompressed bytes written since outputWindowStart
 
 // Old items from IOBUF that we might keep
     void        (*fn)(Socket*, const std::string&){};
@@ -358,6 +396,7 @@ protected:
     Socket      *spyingOn{};      // Socket we are spying on
     std::list<Socket*> spying;    // Sockets spying on us
     std::map<std::string, ReportedMsdpVariable> msdpReporting;
+    MsdpStats   msdpStats{};
 // TEMP
 public:
     long        ltime{};
@@ -366,8 +405,6 @@ public:
 private:
     std::deque<std::string> pagerOutput;
 
-public:
-    static const int COMPRESSED_OUTBUF_SIZE;
 
 public:
     static int getNumSockets();
@@ -0,0 +1,100 @@
+/*
+ * socketSlab.hpp
+ *   Where the server keeps its sockets, and handles that outlive them
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef SOCKETSLAB_H_
+#define SOCKETSLAB_H_
+
+#include <netinet/in.h>     // for sockaddr_in
+#include <cstddef>          // for size_t
+#include <cstdint>          // for uint32_t
+#include <functional>       // for function
+#include <vector>           // for vector
+
+#define SOCKETSLAB_CHUNK    64      // Sockets allocated at a time
+
+class Socket;
+
+// Names a socket without pointing at it. Once the socket's gone, the handle
+// finds nothing, even if another socket has taken its place in the slab.
+struct SocketHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;    // 0 is never a live socket
+
+    [[nodiscard]] bool isSet() const { return(generation != 0); }
+    bool operator==(const SocketHandle& h) const = default;
+};
+
+// Sockets live in chunks that are never moved or freed until the server is,
+// so a Socket* stays good for as long as the socket does. Iterates in the
+// order sockets were added, like the list it replaces; sockets added while
+// iterating are visited too.
+class SocketSlab {
+public:
+    SocketSlab() = default;
+    ~SocketSlab();
+    SocketSlab(const SocketSlab&) = delete;
+    SocketSlab& operator=(const SocketSlab&) = delete;
+
+    Socket& emplace_back(int fd);
+    Socket& emplace_back(int fd, sockaddr_in addr, bool dnsDone);
+    void remove_if(const std::function<bool(Socket&)>& pred);
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] Socket* get(const SocketHandle& handle) const;   // nullptr if it's gone
+
+    // Every socket, starting one further along each time it's called, so
+    // nobody is always first
+    void getRotated(std::vector<Socket*>& order);
+
+    class iterator {
+    public:
+        iterator(const SocketSlab* pSlab, size_t pPos): slab(pSlab), pos(pPos) {}
+        Socket& operator*() const { return(*slab->slots[slab->live[pos]].socket); }
+        Socket* operator->() const { return(slab->slots[slab->live[pos]].socket); }
+        iterator& operator++() { pos++; return(*this); }
+        bool operator!=(const iterator& it) const { return(atEnd() != it.atEnd() || (!atEnd() && pos != it.pos)); }
+        bool operator==(const iterator& it) const { return(!(*this != it)); }
+    private:
+        [[nodiscard]] bool atEnd() const { return(pos >= slab->live.size()); }
+        const SocketSlab* slab;
+        size_t pos;
+    };
+    [[nodiscard]] iterator begin() const { return(iterator(this, 0)); }
+    [[nodiscard]] iterator end() const { return(iterator(this, ~(size_t)0)); }
+
+private:
+    struct Slot {
+        Socket* socket;             // Always points into its chunk; only live while used
+        uint32_t generation = 1;
+        bool used = false;
+    };
+
+    uint32_t claim();
+    Socket& finish(uint32_t index);
+    void destroy(const std::vector<uint32_t>& indexes);
+
+    std::vector<void*> chunks;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> live;     // In the order they were added
+    std::vector<uint32_t> freed;
+    size_t rotation = 0;
+};
+
+#endif /*SOCKETSLAB_H_*/
@@ -18,10 +18,13 @@
 #ifndef STAT_H_
 #define STAT_H_
 
-#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <libxml/parser.h>  // for xmlNodePtr
 
 #include "alphanum.hpp"
+#include "changeWatch.hpp"    // for ChangeWatch
 
 enum ModifierType {
     MOD_NONE = 0,
@@ -30,10 +33,37 @@ enum ModifierType {
     MOD_CUR_MAX = 3,
     MOD_ALL = MOD_CUR_MAX
 };
+
+// Modifier names are interned to ids the first time they're seen; these are
+// registered up front because reCalc and friends use them directly
+typedef unsigned short ModifierId;
+enum : ModifierId {
+    MODIFIER_CUR = 0,       // CurModifier
+    MODIFIER_DM_SET,        // DmSet
+    MODIFIER_ROUNDING,      // Rounding
+    MODIFIER_CON_BONUS,     // ConBonus
+    MODIFIER_INT_BONUS,     // IntBonus
+
+    MODIFIER_BUILTIN_COUNT
+};
+
+enum StatType {
+    STAT_NONE = 0,
+    STAT_STRENGTH,
+    STAT_DEXTERITY,
+    STAT_CONSTITUTION,
+    STAT_INTELLIGENCE,
+    STAT_PIETY,
+    STAT_HP,
+    STAT_MP,
+    STAT_FOCUS
+};
+
 class StatModifier {
 public:
     StatModifier();
     StatModifier(std::string_view pName, int pModAmt, ModifierType pModType);
+    StatModifier(ModifierId pId, int pModAmt, ModifierType pModType);
     StatModifier(xmlNodePtr curNode);
     StatModifier(StatModifier &sm);
     void save(xmlNodePtr parentNode);
@@ -42,18 +72,25 @@ public:
     void set(int newAmt);
     void setType(ModifierType newType);
     std::string getName();
+    [[nodiscard]] ModifierId getId() const;
     int getModAmt();
     ModifierType getModType();
 
     std::string toString();
+
+    static ModifierId getModifierId(std::string_view pName);
+    static const std::string& getModifierName(ModifierId pId);
 private:
     std::string         name;
+    ModifierId      id{};
     int             modAmt{};
     ModifierType    modType;
 
 };
 
-typedef std::map<std::string, StatModifier*, alphanum_less<std::string> > ModifierMap;
+// Stats rarely have more than a handful of modifiers, so they're kept in a flat
+// list and found by id
+typedef std::vector<StatModifier*> StatModifierList;
 
 class Stat
 {
@@ -68,6 +105,7 @@ public:
     friend std::ostream& operator<<(std::ostream& out, Stat& stat);
 
     void setName(std::string_view pName);
+    [[nodiscard]] StatType getType() const;
 
     bool load(xmlNodePtr curNode, std::string_view statName);
     bool loadModifiers(xmlNodePtr curNode);
@@ -89,6 +127,7 @@ public:
 
     void setInfluences(Stat* pInfluences);
     void setInfluencedBy(Stat* pInfluencedBy);
+    void watchChanges(unsigned long* counter);
     unsigned int restore(); // Set a stat to it's maximum value
 
     void reCalc();
@@ -97,19 +136,26 @@ public:
     bool addModifier(const std::string &pName, int modAmt, ModifierType modType);
 
     bool removeModifier(const std::string &pName);
+    bool removeModifier(ModifierId pId);
     bool adjustModifier(const std::string &pName, int modAmt, ModifierType modType = MOD_CUR);
+    bool adjustModifier(ModifierId pId, int modAmt, ModifierType modType = MOD_CUR);
     bool setModifier(const std::string &pName, int newAmt, ModifierType modType = MOD_CUR);
+    bool setModifier(ModifierId pId, int newAmt, ModifierType modType = MOD_CUR);
 
     void clearModifiers();
 
     StatModifier* getModifier(const std::string &pName);
+    StatModifier* getModifier(ModifierId pId);
     int getModifierAmt(const std::string &pName);
+    int getModifierAmt(ModifierId pId);
 
     void upgradeSetCur(unsigned int newCur);  // Used only in upgrading to new stats
 protected:
+    [[nodiscard]] StatModifierList getSortedModifiers() const;
 
     std::string name;
-    ModifierMap modifiers;
+    StatType type;
+    StatModifierList modifiers;
     bool dirty;
 
 
@@ -119,6 +165,7 @@ protected:
 
     Stat* influences;
     Stat* influencedBy;
+    ChangeWatch changes;    // Every change goes through setDirty
 };
 
 #endif /*STAT_H_*/
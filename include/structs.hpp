@@ -278,12 +278,24 @@ public:
 
 #include "songs.hpp"
 
+// What a command has cost us, kept by cmdProcess
+struct CommandStats {
+    unsigned long   calls = 0;
+    long            totalTime = 0;      // Microseconds
+    long            maxTime = 0;
+    unsigned long   bytes = 0;          // Allocated through operator new
+    unsigned long   allocations = 0;
+};
+
 // Base class for Ply/Crt commands
 class Command: public virtual MudMethod {
 public:
     ~Command() = default;
     bool    (*auth)(const Creature *){};
 
+    // Commands live in sets, so they're always const
+    mutable CommandStats stats;
+
     virtual int execute(Creature* player, cmd* cmnd) const = 0;
 };
 
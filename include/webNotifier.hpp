@@ -0,0 +1,116 @@
+/*
+ * webNotifier.hpp
+ *   Background queue of notifications sent to the webserver
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef WEBNOTIFIER_H_
+#define WEBNOTIFIER_H_
+
+#include <chrono>                // for steady_clock
+#include <condition_variable>    // for condition_variable
+#include <map>                   // for multimap
+#include <mutex>                 // for mutex
+#include <string>                // for string
+#include <string_view>           // for string_view
+#include <thread>                // for thread
+#include <unordered_set>         // for unordered_set
+
+#define WEB_NOTIFY_MAX_DEPTH    256     // Notifications waiting to be sent before we start dropping them
+#define WEB_NOTIFY_MAX_TRIES    4       // Attempts per notification
+#define WEB_NOTIFY_TIMEOUT      5000    // Milliseconds to wait on the webserver for any one step
+#define WEB_NOTIFY_MAX_BACKOFF  30      // Seconds between retries at most
+#define WEB_NOTIFY_IDLE         15000   // Milliseconds an idle connection is kept open
+
+// Sends the fire-and-forget GET requests made by callWebserver from a single
+// background thread, keeping one HTTP/1.1 connection open to the webserver
+// between them. The same url queued again while the first is still waiting is
+// only sent once; failures are retried with exponential backoff. https urls
+// are handed to wget, since we don't link a TLS library.
+class WebNotifier {
+public:
+    struct Stats {
+        size_t depth = 0;               // Waiting to be sent, including retries
+        size_t peakDepth = 0;
+        unsigned long sent = 0;
+        unsigned long failed = 0;       // Gave up after WEB_NOTIFY_MAX_TRIES
+        unsigned long retried = 0;
+        unsigned long coalesced = 0;    // Already queued, so not queued again
+        unsigned long dropped = 0;      // Queue was full
+        unsigned long connects = 0;
+        long lastLatency = 0;           // Milliseconds from queued to sent
+        long maxLatency = 0;
+        long totalLatency = 0;
+    };
+
+    explicit WebNotifier(size_t pMaxDepth = WEB_NOTIFY_MAX_DEPTH, int pMaxTries = WEB_NOTIFY_MAX_TRIES);
+    ~WebNotifier();
+
+    WebNotifier(const WebNotifier&) = delete;
+    WebNotifier& operator=(const WebNotifier&) = delete;
+
+    // Returns false if the notification was dropped
+    bool notify(std::string_view url, std::string_view userAgent);
+
+    Stats getStats();
+    std::string getStatsString();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        std::string url;
+        std::string userAgent;
+        Clock::time_point queued;
+        int tries = 0;
+    };
+
+    void work();
+    bool send(const Request& request);
+    bool sendHttp(const std::string& host, const std::string& port, const std::string& path, const Request& request);
+    static bool sendWget(const Request& request);
+
+    // Connection handling, worker thread only
+    bool connectTo(const std::string& host, const std::string& port);
+    void disconnect();
+    bool writeAll(const std::string& data);
+    bool readMore();
+    bool readLine(std::string& line);
+    bool readBody(size_t length);
+    bool readResponse(int& status);
+
+    size_t maxDepth;
+    int maxTries;
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+
+    // Guarded by lock
+    bool stopping = false;
+    std::multimap<Clock::time_point, Request> requests; // Ordered by when they're due
+    std::unordered_set<std::string> queuedUrls;
+    Stats stats;
+
+    // Worker thread only
+    int fd = -1;
+    std::string connHost;
+    std::string connPort;
+    std::string readBuf;
+    size_t received = 0;            // Bytes read since the request was written
+    bool closedByPeer = false;      // The last read failed because the webserver hung up
+};
+
+#endif /*WEBNOTIFIER_H_*/
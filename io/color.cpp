@@ -153,6 +153,27 @@ std::string Config::getCustomColor(CustomColor i, bool caret) const {
 //                      customColorize
 //**********************************************************************
 
+// Indexed by CustomColor
+static const char* customColorTokens[MAX_CUSTOM_COLOR] = {
+    "*CC:BROADCAST*",
+    "*CC:GOSSIP*",
+    "*CC:PTEST*",
+    "*CC:NEWBIE*",
+    "*CC:DM*",
+    "*CC:ADMIN*",
+    "*CC:SEND*",
+    "*CC:MESSAGE*",
+    "*CC:WATCHER*",
+    "*CC:CLASS*",
+    "*CC:RACE*",
+    "*CC:CLAN*",
+    "*CC:TELL*",
+    "*CC:GROUP*",
+    "*CC:DAMAGE*",
+    "*CC:SELF*",
+    "*CC:GUILD*"
+};
+
 std::string Monster::customColorize(const std::string& pText, bool caret) const {
     std::string text = pText;
     if(getMaster() && getMaster()->isPlayer())
@@ -161,26 +182,25 @@ std::string Monster::customColorize(const std::string& pText, bool caret) const
 }
 std::string Player::customColorize(const std::string&  pText, bool caret) const {
     std::string text = pText;
-    boost::replace_all(text, "*CC:BROADCAST*", getCustomColor(CUSTOM_COLOR_BROADCAST, caret).c_str());
-    boost::replace_all(text, "*CC:GOSSIP*", getCustomColor(CUSTOM_COLOR_GOSSIP, caret).c_str());
-    boost::replace_all(text, "*CC:PTEST*", getCustomColor(CUSTOM_COLOR_PTEST, caret).c_str());
-    boost::replace_all(text, "*CC:NEWBIE*", getCustomColor(CUSTOM_COLOR_NEWBIE, caret).c_str());
-    boost::replace_all(text, "*CC:DM*", getCustomColor(CUSTOM_COLOR_DM, caret).c_str());
-    boost::replace_all(text, "*CC:ADMIN*", getCustomColor(CUSTOM_COLOR_ADMIN, caret).c_str());
-    boost::replace_all(text, "*CC:SEND*", getCustomColor(CUSTOM_COLOR_SEND, caret).c_str());
-    boost::replace_all(text, "*CC:MESSAGE*", getCustomColor(CUSTOM_COLOR_MESSAGE, caret).c_str());
-    boost::replace_all(text, "*CC:WATCHER*", getCustomColor(CUSTOM_COLOR_WATCHER, caret).c_str());
-    boost::replace_all(text, "*CC:CLASS*", getCustomColor(CUSTOM_COLOR_CLASS, caret).c_str());
-    boost::replace_all(text, "*CC:RACE*", getCustomColor(CUSTOM_COLOR_RACE, caret).c_str());
-    boost::replace_all(text, "*CC:CLAN*", getCustomColor(CUSTOM_COLOR_CLAN, caret).c_str());
-    boost::replace_all(text, "*CC:TELL*", getCustomColor(CUSTOM_COLOR_TELL, caret).c_str());
-    boost::replace_all(text, "*CC:GROUP*", getCustomColor(CUSTOM_COLOR_GROUP, caret).c_str());
-    boost::replace_all(text, "*CC:DAMAGE*", getCustomColor(CUSTOM_COLOR_DAMAGE, caret).c_str());
-    boost::replace_all(text, "*CC:SELF*", getCustomColor(CUSTOM_COLOR_SELF, caret).c_str());
-    boost::replace_all(text, "*CC:GUILD*", getCustomColor(CUSTOM_COLOR_GUILD, caret).c_str());
+    for(int i = 0; i < MAX_CUSTOM_COLOR; i++)
+        boost::replace_all(text, customColorTokens[i], getCustomColor((CustomColor)i, caret).c_str());
     return(text);
 }
 
+//*********************************************************************
+//                      getCustomColorToken
+//**********************************************************************
+// Which custom color a string like "*CC:GOSSIP*" is; MAX_CUSTOM_COLOR if
+// it's anything else
+
+CustomColor getCustomColorToken(std::string_view token) {
+    for(int i = 0; i < MAX_CUSTOM_COLOR; i++) {
+        if(token == customColorTokens[i])
+            return((CustomColor)i);
+    }
+    return(MAX_CUSTOM_COLOR);
+}
+
 //*********************************************************************
 //                      resetCustomColors
 //**********************************************************************
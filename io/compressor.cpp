@@ -0,0 +1,221 @@
+/*
+ * compressor.cpp
+ *   Per-connection MCCP deflate streams
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <cstddef>          // for max_align_t
+#include <cstdlib>          // for calloc, free
+#include <iostream>         // for clog
+
+#include "async.hpp"        // for AsyncPool
+#include "compressor.hpp"   // for CompressStream, CompressProfile
+
+// zlib's allocations carry their size in front of them so we know exactly
+// how much each stream holds
+#define ZLIB_HEADER     sizeof(std::max_align_t)
+
+//*********************************************************************
+//                      CompressStream
+//*********************************************************************
+
+CompressStream::CompressStream(AsyncPool* pPool): pool(pPool) {
+}
+
+CompressStream::~CompressStream() {
+    release();
+}
+
+bool CompressStream::failed() const { return(error); }
+unsigned long CompressStream::getBytesIn() const { return(bytesIn); }
+unsigned long CompressStream::getBytesOut() const { return(bytesOut); }
+size_t CompressStream::getMemory() const { return(memory); }
+
+void CompressStream::start(const CompressProfile& profile) {
+    queue({OP_START, "", profile});
+}
+void CompressStream::compress(std::string_view data) {
+    queue({OP_COMPRESS, std::string(data), {}});
+}
+void CompressStream::finish() {
+    queue({OP_FINISH, "", {}});
+}
+void CompressStream::raw(std::string_view data) {
+    queue({OP_RAW, std::string(data), {}});
+}
+
+//*********************************************************************
+//                      queue
+//*********************************************************************
+
+void CompressStream::queue(Job job) {
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(std::move(job));
+        // Only one run of this stream's jobs at a time, so they stay in order
+        if(pool && !scheduled)
+            schedule = scheduled = true;
+    }
+
+    if(!pool) {
+        process();
+    } else if(schedule) {
+        std::shared_ptr<CompressStream> self = shared_from_this();
+        pool->run([self]() -> AsyncCallback {
+            self->process();
+            return(nullptr);
+        });
+    }
+}
+
+//*********************************************************************
+//                      process
+//*********************************************************************
+
+void CompressStream::process() {
+    std::unique_lock<std::mutex> guard(lock);
+    while(!jobs.empty()) {
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        guard.unlock();
+        std::string out = run(job);
+        guard.lock();
+        ready += out;
+    }
+    scheduled = false;
+    done.notify_all();
+}
+
+//*********************************************************************
+//                      take
+//*********************************************************************
+
+std::string CompressStream::take() {
+    std::string out;
+    std::lock_guard<std::mutex> guard(lock);
+    out.swap(ready);
+    return(out);
+}
+
+//*********************************************************************
+//                      wait
+//*********************************************************************
+
+void CompressStream::wait() {
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this] { return(!scheduled); });
+}
+
+//*********************************************************************
+//                      run
+//*********************************************************************
+
+std::string CompressStream::run(const Job& job) {
+    std::string out;
+    switch(job.op) {
+        case OP_START:
+            release();
+            zs = new z_stream{};
+            zs->zalloc = zlibAlloc;
+            zs->zfree = zlibFree;
+            zs->opaque = this;
+            if(deflateInit2(zs, job.profile.level, Z_DEFLATED, job.profile.windowBits, job.profile.memLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+                std::clog << "CompressStream: deflateInit2 failed\n";
+                delete zs;
+                zs = nullptr;
+                error = true;
+            }
+            break;
+        case OP_COMPRESS:
+            if(!zs) {
+                error = true;
+                break;
+            }
+            out = deflateAll(job.data, Z_SYNC_FLUSH);
+            bytesIn += job.data.size();
+            bytesOut += out.size();
+            break;
+        case OP_FINISH:
+            if(!zs)
+                break;
+            out = deflateAll("", Z_FINISH);
+            bytesOut += out.size();
+            release();
+            break;
+        case OP_RAW:
+            out = job.data;
+            break;
+    }
+    return(out);
+}
+
+//*********************************************************************
+//                      deflateAll
+//*********************************************************************
+
+std::string CompressStream::deflateAll(const std::string& data, int flush) {
+    std::string out;
+    unsigned char buf[8192];
+    int ret;
+
+    zs->next_in = (Bytef*)data.data();
+    zs->avail_in = data.size();
+    do {
+        zs->next_out = buf;
+        zs->avail_out = sizeof(buf);
+        ret = deflate(zs, flush);
+        if(ret == Z_STREAM_ERROR) {
+            std::clog << "CompressStream: deflate failed\n";
+            error = true;
+            break;
+        }
+        out.append((char*)buf, sizeof(buf) - zs->avail_out);
+        // Z_FINISH is only done once the stream's end has been written
+    } while(zs->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+    return(out);
+}
+
+//*********************************************************************
+//                      release
+//*********************************************************************
+
+void CompressStream::release() {
+    if(!zs)
+        return;
+    deflateEnd(zs);
+    delete zs;
+    zs = nullptr;
+}
+
+//*********************************************************************
+//                      zlibAlloc
+//*********************************************************************
+
+void* CompressStream::zlibAlloc(void* opaque, unsigned int items, unsigned int size) {
+    size_t bytes = (size_t)items * size;
+    auto* block = (char*)calloc(1, bytes + ZLIB_HEADER);
+    if(!block)
+        return(Z_NULL);
+    *(size_t*)block = bytes;
+    static_cast<CompressStream*>(opaque)->memory += bytes;
+    return(block + ZLIB_HEADER);
+}
+
+void CompressStream::zlibFree(void* opaque, void* address) {
+    char* block = (char*)address - ZLIB_HEADER;
+    static_cast<CompressStream*>(opaque)->memory -= *(size_t*)block;
+    free(block);
+}
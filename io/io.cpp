@@ -41,6 +41,7 @@
 #include "global.hpp"                            // for CreatureClass, Creat...
 #include "group.hpp"                             // for CreatureList, Group
 #include "location.hpp"                          // for Location
+#include "logger.hpp"                            // for flushLogs
 #include "mud.hpp"                               // for GUILD_PEON
 #include "mudObjects/areaRooms.hpp"              // for AreaRoom
 #include "mudObjects/container.hpp"              // for Container, PlayerSet
@@ -474,6 +475,8 @@ void shutdown_now(int sig) {
     gServer->saveAllPly();
 
     std::clog << "Goodbye.\n";
+    gServer->stopGoldLog();
+    flushLogs();
     exit(0);
 }
 
@@ -749,6 +752,38 @@ bool keyTxtCompare(const char* key, const char* txt, int tLen) {
     }
 }
 
+//*********************************************************************
+//                      keyTxtNormalize
+//*********************************************************************
+// A key the way keyTxtCompare reads it: color gone, &#nnn; and accents
+// turned into plain lower case letters, and cut short where keyTxtCompare
+// would give up on it. For any txt without color in it, keyTxtCompare is
+// true exactly when keyTxtConvert(txt) is a prefix of this.
+
+std::string keyTxtNormalize(const char* key) {
+    std::string ret;
+    int kI=0, kLen = strlen(key);
+    while(kI < kLen) {
+        if(key[kI] == '^') {
+            kI += 2;
+            continue;
+        }
+        if(key[kI] == '&' && key[kI+1] == '#') {
+            int convert = atoi(&key[kI+2]);
+            kI += 2;
+            while(key[kI] != ';') {
+                kI++;
+                if(kI >= kLen)
+                    return(ret);
+            }
+            ret += keyTxtConvert(convert);
+        } else
+            ret += keyTxtConvert(key[kI]);
+        kI++;
+    }
+    return(ret);
+}
+
 //*********************************************************************
 //                      keyTxtEqual
 //*********************************************************************
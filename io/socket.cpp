@@ -24,9 +24,7 @@
 #include <netinet/in.h>                             // for htonl, sockaddr_in
 #include <sys/socket.h>                             // for linger, setsockopt
 #include <unistd.h>                                 // for ssize_t, write
-#include <zconf.h>                                  // for Bytef
-#include <zlib.h>                                   // for z_stream, deflate
-#include <algorithm>                                // for replace
+#include <algorithm>                                // for replace, min, max
 #include <boost/algorithm/string/predicate.hpp>     // for iequals, istarts_...
 #include <boost/algorithm/string/replace.hpp>       // for replace_all
 #include <boost/iterator/iterator_facade.hpp>       // for operator!=, itera...
@@ -36,7 +34,7 @@
 #include <boost/token_iterator.hpp>                 // for token_iterator
 #include <boost/tokenizer.hpp>                      // for tokenizer
 #include <cctype>                                   // for isalpha, isdigit
-#include <cerrno>                                   // for EWOULDBLOCK, errno
+#include <cerrno>                                   // for EWOULDBLOCK, EINTR, errno
 #include <cstdarg>                                  // for va_end, va_list
 #include <cstdio>                                   // for fseek, size_t, ftell
 #include <cstdlib>                                  // for free, atol, calloc
@@ -54,7 +52,9 @@
 #include <string_view>                              // for string_view, basi...
 #include <vector>                                   // for vector
 
+#include "async.hpp"                                // for AsyncPool
 #include "color.hpp"                                // for stripColor
+#include "compressor.hpp"                           // for CompressStream, MCCP_WINDOW
 #include "commands.hpp"                             // for command, changing...
 #include "config.hpp"                               // for Config, gConfig
 #include "flags.hpp"                                // for P_READING_FILE
@@ -79,7 +79,6 @@
 const int MIN_PAGES = 10;
 
 // Static initialization
-const int Socket::COMPRESSED_OUTBUF_SIZE = 8192;
 int Socket::numSockets = 0;
 
 enum telnetNegotiation {
@@ -181,14 +180,6 @@ unsigned const char do_naws[] = { IAC, DO, TELOPT_NAWS, '\0' };
 
 // End of line string
 unsigned const char eor_str[] = { IAC, EOR, '\0' };
-
-// MCCP Hooks
-void *zlib_alloc(void *opaque, unsigned int items, unsigned int size) {
-    return calloc(items, size);
-}
-void zlib_free(void *opaque, void *address) {
-    free(address);
-}
 }
 
 //--------------------------------------------------------------------
@@ -217,8 +208,10 @@ void Socket::reset() {
     opts.compressing = false;
     inPlayerList = false;
 
-    outCompressBuf = nullptr;
-    outCompress = nullptr;
+    compressor = nullptr;
+    compressBusy = compressIdle = false;
+    lastOutput = outputWindowStart = time(nullptr);
+    outputWindowBytes = 0;
     myPlayer = nullptr;
 
     tState = NEG_NONE;
@@ -271,7 +264,7 @@ Socket::Socket(int pFd, sockaddr_in pAddr, bool dnsDone) {
     numSockets++;
     std::clog << "Constructing socket (" << fd << ") from " << host.ip << " Socket #" << numSockets << std::endl;
 
-    // If we're running under valgrind, we don't resolve dns.  The child process tends to mess with proper memory leak detection
+    // If we're running under valgrind, we don't resolve dns.
     if (gServer->getDnsCache(host.ip, host.hostName) || gServer->isValgrind()) {
         dnsDone = true;
     } else {
@@ -591,19 +584,29 @@ void Socket::continueTelnetNeg(bool queryTType) {
 //********************************************************************
 
 int Socket::processInput() {
-    unsigned char tmpBuf[1024];
-    ssize_t n;
+    unsigned char tmpBuf[SOCKET_READ_MAX + 1];
+    ssize_t n = 0, got;
     ssize_t i = 0;
     std::string tmp = "";
 
-    // Attempt to read from the socket
-    n = read(getFd(), tmpBuf, 1023);
-    if (n <= 0) {
-        if (errno != EWOULDBLOCK)
+    // Drain the socket until it would block (or we've taken our share for this
+    // tick), so a pasted or triggered burst arrives in one go
+    while (n < SOCKET_READ_MAX) {
+        got = read(getFd(), tmpBuf + n, SOCKET_READ_MAX - n);
+        if (got > 0) {
+            n += got;
+            continue;
+        }
+        if (got < 0 && errno == EINTR)
+            continue;
+        // Closed or errored: hand back whatever we did get first, we'll
+        // notice again on the next read
+        if (n == 0 && (got == 0 || errno != EWOULDBLOCK))
             return (-1);
-        else
-            return (0);
+        break;
     }
+    if (n == 0)
+        return (0);
 
     tmp.reserve(n);
 
@@ -946,8 +949,9 @@ int Socket::processInput() {
                 std::clog << "Got msxp supports\n";
             }
         }
-        input.push(tmpr);
+        input.push({std::move(tmpr), std::chrono::steady_clock::now()});
     }
+    inputStats.peakDepth = std::max(inputStats.peakDepth, input.size());
     ltime = time(nullptr);
     return (0);
 }
@@ -1114,9 +1118,14 @@ bool Socket::handleNaws(int& colRow, unsigned char& chr, bool high) {
 // Aka interpreter
 
 int Socket::processOneCommand() {
-    std::string cmd = input.front();
+    std::string cmd = std::move(input.front().line);
+    long wait = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - input.front().queued).count();
     input.pop();
 
+    inputStats.commands++;
+    inputStats.totalWait += wait;
+    inputStats.maxWait = std::max(inputStats.maxWait, wait);
+
     // Send the command to the people we're spying on
     if (!spying.empty()) {
         std::list<Socket*>::iterator it;
@@ -1125,8 +1134,15 @@ int Socket::processOneCommand() {
         }
     }
 
+    // Note what ran for the profiler's slow frame log; login input stays out
+    // of it since it includes passwords
+    std::string note = canForce() && myPlayer ? fmt::format("{}: {}", myPlayer->getName(), cmd) : fmt::format("fd {}: (login)", fd);
+    auto start = std::chrono::steady_clock::now();
+
     ((void(*)(Socket*, std::string)) (fn))(this, cmd);
 
+    note += fmt::format(" ({}us)", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    gServer->getProfiler().note(std::move(note));
     return (1);
 }
 
@@ -1250,6 +1266,10 @@ void Socket::setState(int pState, char pFnParam) {
     }
 
     fnparam = (char) pFnParam;
+
+    // Connected or not decides whether they hear any channels
+    if(myPlayer)
+        gServer->channels.update(myPlayer);
 }
 
 std::string getMxpTag( std::string_view tag, std::string text ) {
@@ -1497,6 +1517,10 @@ ssize_t Socket::write(std::string_view toWrite, bool pSpy, bool process) {
 
     total = toOutput.length();
 
+    // A stream released while the connection was quiet starts again, handshake and all
+    if(compressIdle)
+        startCompress();
+
     const char *str = toOutput.c_str();
     // Write directly to the socket, otherwise compress it and send it
     if (!opts.compressing) {
@@ -1519,6 +1543,7 @@ ssize_t Socket::write(std::string_view toWrite, bool pSpy, bool process) {
         } while (written < total);
 
         UnCompressedBytes += written;
+        OutBytes += written;
 
         if(n == -2)
             written = -2;
@@ -1528,21 +1553,15 @@ ssize_t Socket::write(std::string_view toWrite, bool pSpy, bool process) {
         }
     } else {
         UnCompressedBytes += total;
+        outputWindowBytes += total;
+        lastOutput = time(nullptr);
 
-        outCompress->next_in = (unsigned char*) str;
-        outCompress->avail_in = total;
-        while (outCompress->avail_in) {
-            outCompress->avail_out =
-                    COMPRESSED_OUTBUF_SIZE
-                            - ((char*) outCompress->next_out
-                                    - (char*) outCompressBuf);
-            if (deflate(outCompress, Z_SYNC_FLUSH) != Z_OK) {
-                return (0);
-            }
-            written += processCompressed();
-            if (written == 0)
-                break;
-        }
+        compressor->compress(toOutput);
+        if(!processedOutput.empty() && !process)
+            processedOutput.erase();
+        if(sendCompressed() < 0)
+            return(-1);
+        written = total;
     }
 
     if (pSpy && !spying.empty()) {
@@ -1557,9 +1576,6 @@ ssize_t Socket::write(std::string_view toWrite, bool pSpy, bool process) {
             }
         }
     }
-    // Keep track of total outbytes
-    OutBytes += written;
-
     // If stripped len is 0, it means we only wrote OOB data, so adjust the return so we don't send another prompt
     if(!needsPrompt(toWrite))
         written = -2;
@@ -1581,32 +1597,29 @@ int Socket::startCompress(bool silent) {
     if (opts.compressing)
         return (-1);
 
-    outCompressBuf = new char[COMPRESSED_OUTBUF_SIZE];
-    //out_compress = new z_stream;
-    outCompress = (z_stream *) malloc(sizeof(*outCompress));
-    outCompress->zalloc = telnet::zlib_alloc;
-    outCompress->zfree = telnet::zlib_free;
-    outCompress->opaque = nullptr;
-    outCompress->next_in = nullptr;
-    outCompress->avail_in = 0;
-    outCompress->next_out = (Bytef*) outCompressBuf;
-    outCompress->avail_out = COMPRESSED_OUTBUF_SIZE;
-
-    if (deflateInit(outCompress, 9) != Z_OK) {
-        // Problem with zlib, try to clean up
-        delete outCompressBuf;
-        free(outCompress);
+    if(!compressor) {
+        AsyncPool* pool = gConfig->getCompressThread() ? gServer->getCompressPool() : nullptr;
+        compressor = std::make_shared<CompressStream>(pool);
+    }
+
+    compressor->start(gConfig->getCompressProfile(compressBusy));
+    // We only know straight away if we're deflating on this thread
+    if (compressor->failed()) {
+        compressor = nullptr;
         return (-1);
     }
 
     if (!silent) {
         if (opts.mccp == 2)
-            write(reinterpret_cast<const char *>(telnet::start_mccp2), false);
+            compressor->raw(reinterpret_cast<const char *>(telnet::start_mccp2));
         else
-            write(reinterpret_cast<const char *>(telnet::start_mccp), false);
+            compressor->raw(reinterpret_cast<const char *>(telnet::start_mccp));
     }
     // We're compressing now
     opts.compressing = true;
+    compressIdle = false;
+    lastOutput = time(nullptr);
+    sendCompressed();
 
     return (0);
 }
@@ -1616,60 +1629,124 @@ int Socket::startCompress(bool silent) {
 //********************************************************************
 
 int Socket::endCompress() {
-    if (outCompress && opts.compressing) {
-        unsigned char dummy[1] = { 0 };
-        outCompress->avail_in = 0;
-        outCompress->next_in = dummy;
-        // process any remaining output first?
-        if (deflate(outCompress, Z_FINISH) != Z_STREAM_END) {
-            std::clog << "Error with deflate Z_FINISH\n";
-            return (-1);
-        }
+    if (compressor && (opts.compressing || compressIdle)) {
+        if (opts.compressing)
+            compressor->finish();
 
-        // Send any residual data
-        if (processCompressed() < 0)
-            return (-1);
+        // Send any residual data before anything goes out uncompressed
+        compressor->wait();
+        sendCompressed();
+        compressor = nullptr;
 
-        deflateEnd(outCompress);
+        opts.mccp = 0;
+        opts.compressing = false;
+        compressIdle = false;
+    }
+    return (-1);
+}
 
-        delete[] outCompressBuf;
+//********************************************************************
+//                      restartCompress
+//********************************************************************
+// MCCP v2 lets us end one stream and begin another with a new handshake
 
-        outCompress = nullptr;
-        outCompressBuf = nullptr;
+void Socket::restartCompress() {
+    compressor->finish();
+    opts.compressing = false;
+    startCompress();
+}
+
+//********************************************************************
+//                      checkCompress
+//********************************************************************
+// Once a frame: send anything the compression thread has finished, and
+// move the connection to the profile its output calls for. Quiet
+// connections hand their zlib memory back until they have output again.
+
+void Socket::checkCompress(time_t t) {
+    if (!compressor && compressedOut.empty())
+        return;
+    sendCompressed();
+
+    if (!compressor || !opts.compressing)
+        return;
 
+    if (compressor->failed()) {
+        std::clog << "MCCP stream failed on socket " << fd << ", ending compression.\n";
+        compressor = nullptr;
         opts.mccp = 0;
         opts.compressing = false;
+        return;
+    }
+    // MCCP v1 has no way to end a stream and begin another
+    if (opts.mccp != 2)
+        return;
+
+    int idle = gConfig->getCompressIdle();
+    if (idle > 0 && t - lastOutput >= idle) {
+        compressor->finish();
+        opts.compressing = false;
+        compressIdle = true;
+        compressBusy = false;
+        return;
+    }
+
+    long busyAfter = gConfig->getCompressBusyAfter();
+    bool busy = compressBusy || outputWindowBytes >= (unsigned long)busyAfter;
+    if (t - outputWindowStart >= MCCP_WINDOW) {
+        // A whole window well under the mark and it's quiet again
+        if (outputWindowBytes < (unsigned long)busyAfter / 4)
+            busy = false;
+        outputWindowStart = t;
+        outputWindowBytes = 0;
+    }
+    if (busy != compressBusy) {
+        compressBusy = busy;
+        restartCompress();
     }
-    return (-1);
 }
 
 //********************************************************************
-//                      processCompressed
+//                      sendCompressed
 //********************************************************************
+// Returns bytes sent, or -1 on a socket error. Whatever the socket won't
+// take yet waits for the next frame.
 
-size_t Socket::processCompressed() {
-    auto len = (size_t) ((char*) outCompress->next_out - (char*) outCompressBuf);
-    size_t written = 0;
-    size_t block;
-    ssize_t n, i;
+ssize_t Socket::sendCompressed() {
+    if (compressor)
+        compressedOut += compressor->take();
 
-    if (len > 0) {
-        for (i = 0, n = 0; i < len; i += n) {
-            block = MIN<size_t>(len - i, 4096);
-            if ((n = ::write(fd, outCompressBuf + i, block)) < 0)
-                return (-1);
-            written += n;
-            if (n == 0)
-                break;
-        }
-        if (i) {
-            if (i < len)
-                memmove(outCompressBuf, outCompressBuf + i, len - i);
-
-            outCompress->next_out = (Bytef*) outCompressBuf + len - i;
+    size_t sent = 0;
+    while (sent < compressedOut.size()) {
+        ssize_t n = ::write(fd, compressedOut.data() + sent, compressedOut.size() - sent);
+        if (n < 0 && errno != EWOULDBLOCK && errno != EINTR) {
+            compressedOut.clear();
+            return (-1);
         }
+        if (n <= 0)
+            break;
+        sent += n;
     }
-    return (written);
+    compressedOut.erase(0, sent);
+    OutBytes += sent;
+    return (sent);
+}
+
+//********************************************************************
+//                      getCompressInfo
+//********************************************************************
+
+bool Socket::hasCompressor() const {
+    return (compressor != nullptr);
+}
+
+std::string Socket::getCompressInfo() const {
+    if (!compressor)
+        return ("not compressing");
+    unsigned long in = compressor->getBytesIn(), out = compressor->getBytesOut();
+    return (fmt::format("MCCP v{} {:<6} {:>10} -> {:>9} ({:.1f}%)   zlib {}k",
+        opts.mccp, compressIdle ? "idle" : compressBusy ? "busy" : "quiet", in, out,
+        in ? out * 100.0 / in : 0.0, compressor->getMemory() / 1024));
 }
 // End - MCCP
 //--------------------------------------------------------------------
@@ -1740,6 +1817,31 @@ bool Socket::hasCommand() const {
     return (!input.empty());
 }
 
+size_t Socket::getInputDepth() const {
+    return (input.size());
+}
+
+const Socket::InputStats& Socket::getInputStats() const {
+    return (inputStats);
+}
+
+//********************************************************************
+//                      refillCommandTokens
+//********************************************************************
+// Token bucket: each tick a socket earns rate commands, and can save up to
+// burst of them for when a pasted or triggered batch comes in
+
+void Socket::refillCommandTokens(int rate, int burst) {
+    cmdTokens = std::min(cmdTokens + rate, burst);
+}
+
+bool Socket::takeCommandToken() {
+    if (cmdTokens <= 0)
+        return (false);
+    cmdTokens--;
+    return (true);
+}
+
 //********************************************************************
 //                      canForce
 //********************************************************************
@@ -1766,6 +1868,9 @@ bool Player::isConnected() const {
 int Socket::getFd() const {
     return (fd);
 }
+SocketHandle Socket::getHandle() const {
+    return (handle);
+}
 bool Socket::mxpEnabled() const {
     return (opts.mxp);
 }
@@ -1842,6 +1947,8 @@ void Socket::setIp(std::string_view pIp) {
 }
 void Socket::setPlayer(Player* ply) {
     myPlayer = ply;
+    if(myPlayer)
+        gServer->channels.update(myPlayer);
 }
 
 bool Socket::hasPlayer() const {
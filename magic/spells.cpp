@@ -53,6 +53,7 @@
 
 void Config::clearSpells() {
     spells.clear();
+    indexCommands();
 }
 
 //*********************************************************************
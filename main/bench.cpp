@@ -0,0 +1,482 @@
+/*
+ * bench.cpp
+ *   Headless load generator: boots the game and drives it with scripted bots
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+// Usage: RealmsBench [-p port] [-b bots] [-s seconds] [-r seed] [-t think ms] [-c script] [-w world]
+//
+// Run it from the top of the source tree. The world (tests/world by default)
+// is copied to a temporary directory and the game is run from there, so the
+// player files and rooms the bots save never touch the tree. Each bot gets a
+// player (Benchbota, Benchbotb, ...) made from the world's bench/player.xml.
+//
+// The default script walks to the field and fights a rat, talks, buys bread
+// in the bakery and eats it, then gossips, over and over.
+//
+// Script format, one step per line:
+//   ?text      wait until the server has sent text
+//   *loop      the steps after this one are repeated until time runs out
+//   #...       comment
+//   anything else is sent as a command, with %n replaced by the bot's name
+
+#include <arpa/inet.h>          // for htons, htonl
+#include <fcntl.h>              // for fcntl, O_NONBLOCK
+#include <netinet/in.h>         // for sockaddr_in, INADDR_LOOPBACK
+#include <poll.h>               // for poll, pollfd
+#include <sys/socket.h>         // for socket, connect, send, recv
+#include <unistd.h>             // for close
+#include <algorithm>            // for sort, max
+#include <atomic>               // for atomic
+#include <cerrno>               // for errno, EAGAIN
+#include <chrono>               // for steady_clock
+#include <cstdlib>              // for atoi, atol, mkdtemp
+#include <cstring>              // for strlen, strncpy
+#include <filesystem>           // for copy, remove_all, directory_iterator
+#include <fstream>              // for ifstream, ofstream
+#include <functional>           // for ref, cref
+#include <iostream>             // for cout, cerr
+#include <sstream>              // for stringstream
+#include <string>               // for string
+#include <thread>               // for thread
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "config.hpp"           // for Config, gConfig
+#include "logger.hpp"           // for flushLogs
+#include "mud.hpp"              // for StartTime
+#include "paths.hpp"            // for setRoot
+#include "random.hpp"           // for Random
+#include "server.hpp"           // for Server, gServer
+#include "socket.hpp"           // for OutBytes
+#include "structs.hpp"          // for Command, CommandStats
+
+#define BENCH_WAIT          30      // Seconds a bot waits on a ?step before giving up
+#define BENCH_SEEN_MAX      8192    // Output a bot keeps around to match ?steps against
+#define BENCH_DRAIN_FRAMES  50      // Frames run after the bots quit so their logouts finish
+#define BENCH_WORLD         "tests/world"
+#define BENCH_PYTHON        "pythonLib"     // Copied in so the world has the game's python
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* defaultScript[] = {
+    "?enter name",
+    "%n",
+    "?enter password",
+    "benchpass",
+    "",
+    "*loop",
+    "look",
+    "north",
+    "kill rat",
+    "say got you",
+    "south",
+    "east",
+    "list",
+    "buy bread",
+    "eat bread",
+    "west",
+    "gossip benchmarking",
+    "who",
+    "score",
+    nullptr
+};
+
+struct Bot {
+    int fd = -1;
+    std::string name;
+    size_t step = 0;
+    std::string seen;
+    Clock::time_point waitStart;
+    Clock::time_point nextSend;
+    bool done = false;
+    bool failed = false;
+};
+
+struct BenchOptions {
+    int port = 4444;
+    int bots = 10;
+    int seconds = 60;
+    unsigned int seed = 1;
+    int think = 250;
+    std::vector<std::string> script;
+    size_t loopAt = std::string::npos;    // Where *loop sends a bot back to, if anywhere
+};
+
+//*********************************************************************
+//                      botName
+//*********************************************************************
+// Player names can't have digits in them, so bots are lettered: a..z, ba..
+
+static std::string botName(int n) {
+    std::string suffix;
+    do {
+        suffix.insert(suffix.begin(), static_cast<char>('a' + n % 26));
+        n /= 26;
+    } while(n);
+    return("Benchbot" + suffix);
+}
+
+//*********************************************************************
+//                      loadScript
+//*********************************************************************
+
+static bool loadScript(BenchOptions& options, const char* filename) {
+    std::vector<std::string> lines;
+    if(filename) {
+        std::ifstream in(filename);
+        if(!in) {
+            std::cerr << "Unable to open script " << filename << "\n";
+            return(false);
+        }
+        std::string line;
+        while(std::getline(in, line)) {
+            if(!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if(!line.empty() && line[0] == '#')
+                continue;
+            lines.push_back(line);
+        }
+    } else {
+        for(int i = 0; defaultScript[i]; i++)
+            lines.emplace_back(defaultScript[i]);
+    }
+
+    for(const std::string& line : lines) {
+        if(line == "*loop")
+            options.loopAt = options.script.size();
+        else
+            options.script.push_back(line);
+    }
+    return(true);
+}
+
+//*********************************************************************
+//                      makeWorld
+//*********************************************************************
+// Copies the world to a new temporary directory and writes a player for
+// every bot into it. Returns the directory, or an empty string on failure.
+
+static std::string makeWorld(const std::string& world, int bots) {
+    namespace fs = std::filesystem;
+    char dir[] = "/tmp/realmsBench.XXXXXX";
+    if(!mkdtemp(dir)) {
+        std::cerr << "Unable to make a temporary directory\n";
+        return("");
+    }
+    std::string root = dir;
+
+    std::error_code ec;
+    fs::copy(world, root, fs::copy_options::recursive, ec);
+    if(!ec && fs::is_directory(BENCH_PYTHON)) {
+        fs::create_directories(root + "/config/code/python", ec);
+        for(const fs::directory_entry& entry : fs::directory_iterator(BENCH_PYTHON, ec)) {
+            if(entry.path().extension() == ".py")
+                fs::copy_file(entry.path(), root + "/config/code/python/" + entry.path().filename().string(), ec);
+            if(ec)
+                break;
+        }
+    }
+    if(!ec)
+        fs::create_directories(root + "/player", ec);
+    if(ec) {
+        std::cerr << "Unable to copy " << world << " to " << root << ": " << ec.message() << "\n";
+        fs::remove_all(root, ec);
+        return("");
+    }
+
+    std::ifstream in(root + "/bench/player.xml");
+    std::stringstream buf;
+    buf << in.rdbuf();
+    std::string player = buf.str();
+    if(player.empty()) {
+        std::cerr << "No bench/player.xml in " << world << "\n";
+        fs::remove_all(root, ec);
+        return("");
+    }
+
+    for(int i = 0; i < bots; i++) {
+        std::string name = botName(i), text = player;
+        for(size_t pos = text.find("%n"); pos != std::string::npos; pos = text.find("%n", pos))
+            text.replace(pos, 2, name);
+        std::ofstream out(root + "/player/" + name + ".xml");
+        out << text;
+    }
+    return(root);
+}
+
+//*********************************************************************
+//                      connectBot
+//*********************************************************************
+
+static bool connectBot(Bot& bot, int port) {
+    struct sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    bot.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(bot.fd < 0)
+        return(false);
+    if(connect(bot.fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 && errno != EINPROGRESS) {
+        close(bot.fd);
+        bot.fd = -1;
+        return(false);
+    }
+    fcntl(bot.fd, F_SETFL, fcntl(bot.fd, F_GETFL) | O_NONBLOCK);
+    bot.waitStart = bot.nextSend = Clock::now();
+    return(true);
+}
+
+//*********************************************************************
+//                      sendLine
+//*********************************************************************
+
+static void sendLine(Bot& bot, std::string line) {
+    for(size_t pos = line.find("%n"); pos != std::string::npos; pos = line.find("%n", pos))
+        line.replace(pos, 2, bot.name);
+    line += "\r\n";
+    // Short lines on a loopback socket; if it won't take them the server has stalled anyway
+    if(send(bot.fd, line.c_str(), line.size(), MSG_NOSIGNAL) < 0 && errno != EAGAIN)
+        bot.done = bot.failed = true;
+}
+
+//*********************************************************************
+//                      stepBot
+//*********************************************************************
+// Runs the bot's script as far as it can go without waiting
+
+static void stepBot(Bot& bot, const BenchOptions& options, Clock::time_point now) {
+    while(!bot.done) {
+        if(bot.step >= options.script.size()) {
+            if(options.loopAt >= options.script.size()) {
+                bot.done = true;
+                return;
+            }
+            // At most one pass of the loop per call, even with no think time
+            bot.step = options.loopAt;
+            return;
+        }
+
+        const std::string& line = options.script[bot.step];
+        if(!line.empty() && line[0] == '?') {
+            size_t found = bot.seen.find(line.substr(1));
+            if(found == std::string::npos) {
+                if(now - bot.waitStart > std::chrono::seconds(BENCH_WAIT)) {
+                    std::cerr << bot.name << " gave up waiting for \"" << line.substr(1) << "\"\n";
+                    bot.done = bot.failed = true;
+                }
+                return;
+            }
+            bot.seen.erase(0, found + line.size() - 1);
+        } else {
+            if(now < bot.nextSend)
+                return;
+            sendLine(bot, line);
+            bot.nextSend = now + std::chrono::milliseconds(options.think);
+        }
+        bot.step++;
+        bot.waitStart = now;
+    }
+}
+
+//*********************************************************************
+//                      runBots
+//*********************************************************************
+// The bot thread: never touches the game, only its own sockets
+
+static void runBots(std::vector<Bot>& bots, const BenchOptions& options, std::atomic<bool>& finished) {
+    Clock::time_point stopAt = Clock::now() + std::chrono::seconds(options.seconds);
+    std::vector<pollfd> fds(bots.size());
+    char buf[4096];
+
+    while(Clock::now() < stopAt) {
+        for(size_t i = 0; i < bots.size(); i++)
+            fds[i] = { bots[i].done ? -1 : bots[i].fd, POLLIN, 0 };
+        poll(fds.data(), fds.size(), 10);
+
+        Clock::time_point now = Clock::now();
+        bool anyLeft = false;
+        for(size_t i = 0; i < bots.size(); i++) {
+            Bot& bot = bots[i];
+            if(bot.done)
+                continue;
+            if(fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                ssize_t n;
+                while((n = recv(bot.fd, buf, sizeof(buf), 0)) > 0)
+                    bot.seen.append(buf, n);
+                if(n == 0 || (n < 0 && errno != EAGAIN)) {
+                    std::cerr << bot.name << " was disconnected\n";
+                    bot.done = bot.failed = true;
+                    continue;
+                }
+                if(bot.seen.size() > BENCH_SEEN_MAX)
+                    bot.seen.erase(0, bot.seen.size() - BENCH_SEEN_MAX);
+            }
+            stepBot(bot, options, now);
+            anyLeft = anyLeft || !bot.done;
+        }
+        if(!anyLeft)
+            break;
+    }
+
+    for(Bot& bot : bots) {
+        if(bot.fd < 0)
+            continue;
+        if(!bot.failed)
+            sendLine(bot, "quit");
+        close(bot.fd);
+        bot.fd = -1;
+    }
+    finished = true;
+}
+
+//*********************************************************************
+//                      readStatus
+//*********************************************************************
+// A kB figure from /proc/self/status
+
+static long readStatus(const std::string& field) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.compare(0, field.size() + 1, field + ":") == 0)
+            return(atol(line.c_str() + field.size() + 1));
+    }
+    return(0);
+}
+
+//*********************************************************************
+//                      commandCalls
+//*********************************************************************
+
+static unsigned long commandCalls() {
+    unsigned long calls = 0;
+    for(const Command* cmd : gConfig->getCommandList())
+        calls += cmd->stats.calls;
+    return(calls);
+}
+
+//*********************************************************************
+//                      main
+//*********************************************************************
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    const char* scriptFile = nullptr;
+    std::string world = BENCH_WORLD;
+
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2) {
+            std::cerr << "Usage: " << argv[0] << " [-p port] [-b bots] [-s seconds] [-r seed] [-t think ms] [-c script] [-w world]\n";
+            return(1);
+        }
+        const char* value = argv[++i];
+        switch(argv[i-1][1]) {
+        case 'p': options.port = atoi(value); break;
+        case 'b': options.bots = std::max(1, atoi(value)); break;
+        case 's': options.seconds = std::max(1, atoi(value)); break;
+        case 'r': options.seed = static_cast<unsigned int>(atol(value)); break;
+        case 't': options.think = std::max(0, atoi(value)); break;
+        case 'c': scriptFile = value; break;
+        case 'w': world = value; break;
+        default:
+            std::cerr << "Unknown option " << argv[i-1] << "\n";
+            return(1);
+        }
+    }
+    if(!loadScript(options, scriptFile))
+        return(1);
+
+    std::string root = makeWorld(world, options.bots);
+    if(root.empty())
+        return(1);
+    Path::setRoot(root + "/");
+    std::error_code ec;
+
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+    strncpy(gConfig->cmdline, argv[0], 255);
+    gConfig->cmdline[255] = 0;
+    gConfig->setPortNum(static_cast<short>(options.port));
+
+    StartTime = time(nullptr);
+    gServer->init();
+    if(!gServer->isRunning()) {
+        std::cerr << "Unable to listen on port " << options.port << "\n";
+        std::filesystem::remove_all(root, ec);
+        return(1);
+    }
+
+    // Everything after this point draws from the same sequence on every run
+    Random::seed(options.seed);
+    srand(options.seed);
+
+    std::vector<Bot> bots(options.bots);
+    for(int i = 0; i < options.bots; i++) {
+        bots[i].name = botName(i);
+        if(!connectBot(bots[i], options.port)) {
+            std::cerr << "Unable to connect " << bots[i].name << "\n";
+            std::filesystem::remove_all(root, ec);
+            return(1);
+        }
+    }
+
+    long rssBefore = readStatus("VmRSS");
+    long outBefore = OutBytes;
+    unsigned long callsBefore = commandCalls();
+    std::vector<long> frames;
+    frames.reserve(options.seconds * TICK_SLOTS);
+
+    std::atomic<bool> finished{false};
+    Clock::time_point start = Clock::now();
+    std::thread botThread(runBots, std::ref(bots), std::cref(options), std::ref(finished));
+
+    while(!finished) {
+        gServer->runOnce();
+        frames.push_back(gServer->getLastFrameTime());
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    botThread.join();
+
+    unsigned long calls = commandCalls() - callsBefore;
+    long outBytes = OutBytes - outBefore;
+
+    for(int i = 0; i < BENCH_DRAIN_FRAMES; i++)
+        gServer->runOnce();
+
+    int failed = 0;
+    for(const Bot& bot : bots)
+        failed += bot.failed;
+
+    std::sort(frames.begin(), frames.end());
+    auto percentile = [&frames](int pct) -> double {
+        if(frames.empty())
+            return(0);
+        return(frames[std::min(frames.size() - 1, frames.size() * pct / 100)] / 1000.0);
+    };
+
+    std::cout << fmt::format("Bots: {} ({} failed)   Seconds: {:.1f}   Seed: {}\n", options.bots, failed, elapsed, options.seed);
+    std::cout << fmt::format("Commands: {}   ({:.1f}/sec)\n", calls, calls / elapsed);
+    std::cout << fmt::format("Frames: {}   p50 {:.2f}ms   p99 {:.2f}ms   max {:.2f}ms\n",
+        frames.size(), percentile(50), percentile(99), frames.empty() ? 0.0 : frames.back() / 1000.0);
+    std::cout << fmt::format("Bytes out: {}   ({:.1f}/sec)\n", outBytes, outBytes / elapsed);
+    std::cout << fmt::format("RSS: {}kB at start, {}kB at end, {}kB peak\n", rssBefore, readStatus("VmRSS"), readStatus("VmHWM"));
+
+    flushLogs();
+    std::filesystem::remove_all(root, ec);
+    return(failed ? 2 : 0);
+}
@@ -0,0 +1,405 @@
+/*
+ * microBench.cpp
+ *   Timings of the game's hot paths, written out in Google Benchmark's JSON format
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+// Usage: RealmsMicroBench [--benchmark_filter=regex] [--benchmark_min_time=seconds]
+//            [--benchmark_repetitions=n] [--benchmark_out=file]
+//            [--player=name] [--room=area.id] [--map=area:x:y:z]
+//
+// The fixture player and room are loaded from the world on disk (run it
+// against a copy of a fixture world); benchmarks that need one are skipped if
+// it can't be loaded. The player is saved as a backup, never over the real file.
+//
+// The JSON is the same shape Google Benchmark writes, so its compare.py can
+// diff two runs:  compare.py benchmarks before.json after.json
+
+#include <sys/utsname.h>        // for uname
+#include <unistd.h>             // for sysconf
+#include <algorithm>            // for max
+#include <chrono>               // for steady_clock
+#include <cstring>              // for strcpy
+#include <ctime>                // for clock_gettime, CLOCK_PROCESS_CPUTIME_ID
+#include <fstream>              // for ofstream
+#include <functional>           // for function
+#include <iostream>             // for cout, cerr
+#include <list>                 // for list
+#include <regex>                // for regex, regex_search
+#include <set>                  // for set
+#include <string>               // for string
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "area.hpp"             // for Area, MapMarker
+#include "bans.hpp"             // for Ban, BanMatcher
+#include "catRef.hpp"           // for CatRef
+#include "cmd.hpp"              // for cmd
+#include "commands.hpp"         // for parse
+#include "communication.hpp"    // for sendGlobalComm, getChannelByName
+#include "config.hpp"           // for Config, gConfig
+#include "flags.hpp"            // for P_IGNORE_GOSSIP
+#include "global.hpp"           // for WIELD
+#include "login.hpp"            // for CON_PLAYING
+#include "mudObjects/monsters.hpp"      // for Monster
+#include "mudObjects/objects.hpp"       // for Object
+#include "mudObjects/players.hpp"       // for Player
+#include "mudObjects/uniqueRooms.hpp"   // for UniqueRoom
+#include "proto.hpp"            // for getCatRef
+#include "server.hpp"           // for Server, gServer, idComp
+#include "socket.hpp"           // for Socket
+#include "stats.hpp"            // for Stat
+#include "xml.hpp"              // for loadPlayer, loadRoomFromFile
+
+#define MICRO_MIN_TIME      0.5     // Seconds each benchmark runs for at least
+#define MICRO_MAX_ITERS     1000000000L
+#define MICRO_LISTENERS     1000    // Players online for sendGlobalComm
+#define MICRO_BAG_SIZE      500     // Objects in the bag for Container::findObject
+#define MICRO_BANS          10000   // Bans for BanMatcher::find
+#define MICRO_HERD          1000    // Monsters alive at once for Monster/spawn+kill
+
+std::string delimit(const char *str, int wrap);
+void getCommand(Creature *user, cmd* cmnd);
+
+typedef std::chrono::steady_clock Clock;
+
+// Keeps the compiler from throwing away a result we never look at
+template <class T>
+static void keep(T&& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Nothing is ever sent; output is thrown away so it doesn't pile up between iterations
+class BenchSocket : public Socket {
+public:
+    using Socket::Socket;
+    void discard() { output.clear(); }
+};
+
+struct MicroBench {
+    std::string name;
+    std::function<void()> run;      // One iteration
+    bool available = true;
+};
+
+struct MicroResult {
+    std::string name;
+    int repetition;
+    long iterations;
+    double realTime;    // Nanoseconds per iteration
+    double cpuTime;
+};
+
+//*********************************************************************
+//                      cpuNow
+//*********************************************************************
+
+static double cpuNow() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return(ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+//*********************************************************************
+//                      measure
+//*********************************************************************
+// Grows the iteration count until a run takes at least minTime, the way
+// Google Benchmark does, and times that last run
+
+static MicroResult measure(const MicroBench& bench, double minTime, int repetition) {
+    long iterations = 1;
+    while(true) {
+        double cpuStart = cpuNow();
+        Clock::time_point start = Clock::now();
+        for(long i = 0; i < iterations; i++)
+            bench.run();
+        double real = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        double cpu = cpuNow() - cpuStart;
+
+        if(real >= minTime * 1e9 || iterations >= MICRO_MAX_ITERS)
+            return(MicroResult{bench.name, repetition, iterations, real / iterations, cpu / iterations});
+
+        // Aim a little past minTime so we usually only need one more run
+        double want = minTime * 1e9 * 1.4 / std::max(real / iterations, 1.0);
+        iterations = std::clamp(static_cast<long>(want), iterations * 2, std::min(iterations * 100, MICRO_MAX_ITERS));
+    }
+}
+
+//*********************************************************************
+//                      writeJson
+//*********************************************************************
+
+static std::string jsonEscape(const std::string& str) {
+    std::string out;
+    for(char ch : str) {
+        if(ch == '"' || ch == '\\')
+            out += '\\';
+        out += ch;
+    }
+    return(out);
+}
+
+static std::string writeJson(const std::vector<MicroResult>& results, const char* executable, int repetitions) {
+    char date[64];
+    time_t t = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&t));
+    struct utsname host{};
+    uname(&host);
+
+    std::string json = "{\n  \"context\": {\n";
+    json += fmt::format("    \"date\": \"{}\",\n", date);
+    json += fmt::format("    \"host_name\": \"{}\",\n", jsonEscape(host.nodename));
+    json += fmt::format("    \"executable\": \"{}\",\n", jsonEscape(executable));
+    json += fmt::format("    \"num_cpus\": {},\n", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef NDEBUG
+    json += "    \"library_build_type\": \"release\"\n";
+#else
+    json += "    \"library_build_type\": \"debug\"\n";
+#endif
+    json += "  },\n  \"benchmarks\": [";
+
+    bool first = true;
+    for(const MicroResult& result : results) {
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += "    {\n";
+        json += fmt::format("      \"name\": \"{}\",\n", jsonEscape(result.name));
+        json += fmt::format("      \"run_name\": \"{}\",\n", jsonEscape(result.name));
+        json += "      \"run_type\": \"iteration\",\n";
+        json += fmt::format("      \"repetitions\": {},\n", repetitions);
+        json += fmt::format("      \"repetition_index\": {},\n", result.repetition);
+        json += "      \"threads\": 1,\n";
+        json += fmt::format("      \"iterations\": {},\n", result.iterations);
+        json += fmt::format("      \"real_time\": {:.3f},\n", result.realTime);
+        json += fmt::format("      \"cpu_time\": {:.3f},\n", result.cpuTime);
+        json += "      \"time_unit\": \"ns\"\n";
+        json += "    }";
+    }
+    json += "\n  ]\n}\n";
+    return(json);
+}
+
+//*********************************************************************
+//                      main
+//*********************************************************************
+
+int main(int argc, char *argv[]) {
+    std::string filter = ".", outFile, playerName = "Benchbota", roomName = "misc.1", mapName = "1:0:0:0";
+    double minTime = MICRO_MIN_TIME;
+    int repetitions = 1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq), value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if(key == "--benchmark_filter")             filter = value;
+        else if(key == "--benchmark_min_time")      minTime = std::max(0.001, atof(value.c_str()));
+        else if(key == "--benchmark_repetitions")   repetitions = std::max(1, atoi(value.c_str()));
+        else if(key == "--benchmark_out")           outFile = value;
+        else if(key == "--player")                  playerName = value;
+        else if(key == "--room")                    roomName = value;
+        else if(key == "--map")                     mapName = value;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return(1);
+        }
+    }
+
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+    gConfig->setListing(true);  // Load everything, but don't listen on a port
+    gServer->init();
+
+    // Fixtures
+    Player* player = nullptr;
+    if(!loadPlayer(playerName, &player))
+        std::cerr << "Unable to load player " << playerName << "; skipping the benchmarks that need one.\n";
+    auto* sock = new Socket(-1);
+    if(player) {
+        player->fd = -1;
+        player->setSock(sock);
+        sock->setPlayer(player);
+    }
+
+    CatRef roomRef;
+    getCatRef(roomName, &roomRef, nullptr);
+
+    MapMarker mapmarker;
+    mapmarker.load("A: " + mapName);
+    Area* area = gServer->getArea(mapmarker.getArea());
+
+    const std::string colored = "^gYou see ^Ya golden chalice^g here.^x\n^cObvious exits: ^Wnorth, south, east, west^x.\n"
+                                "^rThe goblin^x hits you for ^R12^x damage!\n";
+    const std::string longText = "The wind picks up as you crest the hill, and far below you can make out the "
+                                 "walls of Highport, the harbour crowded with ships and the market square busy "
+                                 "with the noise of a hundred merchants calling out their wares to passersby.";
+    std::vector<std::string> ids;
+    for(int i = 0; i < 1000; i++)
+        ids.emplace_back(fmt::format("{}{}", "PMOR"[i % 4], (i * 7919) % 100000));
+    std::vector<Object*> objects;
+    for(int i = 0; i < 200; i++) {
+        auto* object = new Object();
+        object->setName(fmt::format("{} {}", i % 3 ? "short sword" : "small leather pouch", i % 17));
+        objects.push_back(object);
+    }
+    // A bag with a lot in it, looked through by keyword
+    auto* bag = new Object();
+    bag->setName("bottomless bag");
+    const char* kinds[] = { "sword", "pouch", "ring", "potion", "scroll" };
+    for(int i = 0; i < MICRO_BAG_SIZE; i++) {
+        auto* object = new Object();
+        object->setName(fmt::format("{} {}", kinds[i % 5], i));
+        strcpy(object->key[0], kinds[i % 5]);
+        bag->addObj(object, false);
+    }
+    // Prefix, suffix and exact bans, looked up by the addresses and hosts
+    // of connections that mostly aren't banned
+    std::list<Ban*> bans;
+    for(int i = 0; i < MICRO_BANS; i++) {
+        auto* ban = new Ban();
+        if(i % 3 == 0) {
+            ban->site = fmt::format("{}.{}.", i % 200, (i * 7) % 250);
+            ban->isPrefix = true;
+        } else if(i % 3 == 1) {
+            ban->site = fmt::format(".host{}.example.net", i);
+            ban->isSuffix = true;
+        } else {
+            ban->site = fmt::format("203.{}.{}.{}", i % 250, (i / 250) % 250, i % 17);
+        }
+        bans.push_back(ban);
+    }
+    BanMatcher banMatcher(bans);
+    std::vector<std::string> sites;
+    for(int i = 0; i < 1000; i++)
+        sites.push_back(i % 2 ? fmt::format("{}.{}.5.6", i % 256, (i * 3) % 256) : fmt::format("dsl-{}.host{}.example.net", i, i * 5));
+    size_t nextSite = 0;
+    // Everyone online: a few ignore gossip, a few are staff
+    std::vector<BenchSocket*> listeners;
+    for(int i = 0; i < MICRO_LISTENERS; i++) {
+        auto* listenerSock = new BenchSocket(-1);
+        auto* listener = new Player;
+        listener->fd = -1;
+        listener->setName(fmt::format("Benchlistener{}", i));
+        listener->setClass(i % 50 ? CreatureClass::FIGHTER : CreatureClass::CARETAKER);
+        if(i % 7 == 0)
+            listener->setFlag(P_IGNORE_GOSSIP);
+        listener->setSock(listenerSock);
+        listenerSock->setPlayer(listener);
+        listenerSock->setState(CON_PLAYING);
+        gServer->addPlayer(listener);
+        listeners.push_back(listenerSock);
+    }
+    Player* speaker = listeners.front()->getPlayer();
+    channelPtr gossip = getChannelByName(speaker, "gossip");
+
+    // Monsters coming and going; each one killed is replaced by a new one
+    std::vector<Monster*> herd;
+    for(int i = 0; i < MICRO_HERD; i++)
+        herd.push_back(new Monster());
+    size_t nextKill = 0;
+
+    Stat stat;
+    stat.setInitial(50);
+    for(int i = 0; i < 8; i++)
+        stat.addModifier(fmt::format("bench{}", i), i % 2 ? 5 : -3, MOD_ALL);
+
+    std::vector<MicroBench> benches = {
+        { "parseForOutput", [&] { keep(sock->parseForOutput(colored)); } },
+        { "customColorize", [&] { keep(player->customColorize(colored)); }, player != nullptr },
+        { "delimit", [&] { keep(delimit(longText.c_str(), 78)); } },
+        { "getCommand", [&] {
+            cmd cmnd;
+            parse("kill goblin", &cmnd);
+            getCommand(player, &cmnd);
+            keep(cmnd.myCommand);
+        }, player != nullptr },
+        { "Effects::isEffected", [&] { keep(player->effects.isEffected("haste")); }, player != nullptr },
+        { "combatRound/skills", [&] {
+            // The skill lookups one swing makes: the attacker's weapon skill,
+            // the defender's defense, then whether they can dodge or parry
+            const Object* weapon = player->ready[WIELD-1];
+            keep(player->getWeaponSkill(weapon));
+            keep(player->getDefenseSkill());
+            if(player->knowsSkill("dodge"))
+                keep(player->getSkillLevel("dodge"));
+            if(player->knowsSkill("parry"))
+                keep(player->getSkillLevel("parry"));
+            keep(player->getSkillLevel(weapon ? weapon->getWeaponType() : player->getUnarmedWeaponSkill()));
+            keep(player->getSkillLevel("defense"));
+        }, player != nullptr },
+        { "Stat::reCalc", [&] { stat.reCalc(); keep(stat.getCur()); } },
+        { "idComp", [&] {
+            static idComp comp;
+            bool less = false;
+            for(size_t i = 1; i < ids.size(); i++)
+                less ^= comp(ids[i-1], ids[i]);
+            keep(less);
+        } },
+        { "ObjectPtrLess/insert", [&] {
+            ObjectSet set;
+            for(Object* object : objects)
+                set.insert(object);
+            keep(set.size());
+        } },
+        { "Area::showGrid", [&] { keep(area->showGrid(player, &mapmarker, true)); }, player && area },
+        { "loadRoomFromFile", [&] {
+            UniqueRoom* room = nullptr;
+            if(loadRoomFromFile(roomRef, &room, "", true))
+                delete room;
+            keep(room);
+        } },
+        { "Player::saveToFile", [&] { keep(player->saveToFile(LoadType::LS_BACKUP)); }, player != nullptr },
+        { "BanMatcher::find/10k", [&] { keep(banMatcher.find(sites[nextSite++ % sites.size()])); } },
+        { "Container::findObject/500", [&] { keep(bag->findObject(player, "scr", 40)); }, player != nullptr },
+        { "Monster/spawn+kill", [&] {
+            // Out of order, the way they die in the game
+            Monster*& victim = herd[(nextKill++ * 7919) % herd.size()];
+            delete victim;
+            victim = new Monster();
+            keep(victim);
+        } },
+        { "sendGlobalComm/1k", [&] {
+            sendGlobalComm(speaker, "Anyone selling a short sword?", "", 0, gossip, "", speaker->getName(), speaker->getName());
+            for(BenchSocket* listenerSock : listeners)
+                listenerSock->discard();
+        }, gossip != nullptr },
+    };
+
+    std::regex match(filter);
+    std::vector<MicroResult> results;
+    for(const MicroBench& bench : benches) {
+        if(!bench.available || !std::regex_search(bench.name, match))
+            continue;
+        for(int r = 0; r < repetitions; r++) {
+            MicroResult result = measure(bench, minTime, r);
+            std::cerr << fmt::format("{:<24} {:>14.1f} ns {:>14.1f} ns {:>12}\n", result.name, result.realTime, result.cpuTime, result.iterations);
+            results.push_back(result);
+        }
+    }
+
+    std::string json = writeJson(results, argv[0], repetitions);
+    if(outFile.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(outFile);
+        out << json;
+        if(!out) {
+            std::cerr << "Unable to write " << outFile << "\n";
+            return(1);
+        }
+    }
+    return(0);
+}
@@ -48,6 +48,7 @@
 #include "mudObjects/rooms.hpp"        // for BaseRoom
 #include "mudObjects/uniqueRooms.hpp"  // for UniqueRoom
 #include "objIncrease.hpp"             // for ObjIncrease
+#include "pool.hpp"                    // for TypePool
 #include "proto.hpp"                   // for getCatRef, int_to_text, broadcast
 #include "random.hpp"                  // for Random
 #include "range.hpp"                   // for Range
@@ -196,6 +197,23 @@ Object::~Object() {
     moDestroy();
 }
 
+//*********************************************************************
+//                      operator new / delete
+//*********************************************************************
+
+static TypePool* getObjectPool() {
+    static TypePool* pool = TypePool::getPool("Object", sizeof(Object));
+    return(pool);
+}
+
+void* Object::operator new(std::size_t size) {
+    return(getObjectPool()->allocate(size));
+}
+
+void Object::operator delete(void* ptr, std::size_t size) {
+    getObjectPool()->deallocate(ptr, size);
+}
+
 //*********************************************************************
 //                          init
 //*********************************************************************
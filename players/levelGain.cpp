@@ -182,6 +182,8 @@ void Player::upLevel() {
 
     if(isStaff()) {
         level++;
+        stateChanged(CHANGE_EXPERIENCE);
+        stateChanged(CHANGE_ARMOR);
         return;
     }
 
@@ -195,6 +197,8 @@ void Player::upLevel() {
         relevel = true;
 
     level++;
+    stateChanged(CHANGE_EXPERIENCE);
+    stateChanged(CHANGE_ARMOR);
 
     // Check for level info
     if(!pClass) {
@@ -442,6 +446,8 @@ void Player::downLevel() {
 
     if(isStaff()) {
         level--;
+        stateChanged(CHANGE_EXPERIENCE);
+        stateChanged(CHANGE_ARMOR);
         return;
     }
 
@@ -488,6 +494,8 @@ void Player::downLevel() {
         *this << "You have lost piety.\n";
 
     level--;
+    stateChanged(CHANGE_EXPERIENCE);
+    stateChanged(CHANGE_ARMOR);
 
     hp.restore();
 
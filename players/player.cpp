@@ -760,7 +760,11 @@ void Player::computeAC() {
     if(isEffected("weakness"))
         ac -= 100;
 
-    armor = MAX(0, ac);
+    // Worked out every time anything is worn, so only count a real change
+    if(armor != static_cast<unsigned int>(MAX(0, ac))) {
+        armor = MAX(0, ac);
+        stateChanged(CHANGE_ARMOR);
+    }
 }
 
 
@@ -157,7 +157,7 @@ void Player::checkEffectsWearingOff() {
                 printColor("^WYou have regained a lost level.\n");
                 expTemp = experience;
                 upLevel();
-                experience = expTemp;
+                setExperience(expTemp);
 
                 lasttime[LT_LEVEL_DRAIN].ltime = t;
                 lasttime[LT_LEVEL_DRAIN].interval = 60L + 5*bonus(constitution.getCur());
@@ -165,7 +165,7 @@ void Player::checkEffectsWearingOff() {
                 printColor("^WYou have recovered all your lost levels.\n");
                 expTemp = experience;
                 upLevel();
-                experience = expTemp;
+                setExperience(expTemp);
             }
         }
     }
@@ -28,7 +28,7 @@ namespace py = pybind11;
 
 void init_module_stats(py::module &m) {
     py::class_<Stat>(m, "Stat")
-        .def("getModifierAmt", &Stat::getModifierAmt)
+        .def("getModifierAmt", py::overload_cast<const std::string &>(&Stat::getModifierAmt))
         .def("adjust", &Stat::adjust, py::arg("amt"))
         .def("decrease", &Stat::decrease, py::arg("amt"))
         .def("getCur", &Stat::getCur, py::arg("recalc") = true)
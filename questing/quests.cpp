@@ -30,6 +30,7 @@
 #include <boost/token_functions.hpp>                // for char_delimiters_s...
 #include <boost/token_iterator.hpp>                 // for token_iterator
 #include <boost/tokenizer.hpp>                      // for tokenizer<>::iter...
+#include <algorithm>                                // for equal
 #include <cctype>                                   // for ispunct, isspace
 #include <cstdio>                                   // for sprintf
 #include <cstring>                                  // for strlen, strncmp
@@ -440,6 +441,7 @@ bool Config::loadQuests() {
     }
     xmlFreeDoc(xmlDoc);
     xmlCleanupParser();
+    QuestIndex::questsReloaded();
     return(true);
 }
 
@@ -560,26 +562,58 @@ QuestCompleted* Player::getQuestCompleted(const int questId) const {
     }
 }
 
+QuestIndex* Player::getQuestIndex() {
+    if(!questIndex)
+        questIndex = new QuestIndex();
+    questIndex->sync(questsInProgress);
+    return(questIndex);
+}
+
+// Every quest still gets a look, in order, so they finish (and say so) just
+// as they always have; only the ones that want this monster, object or room
+// go through their lists.
 void Player::updateMobKills(Monster* monster) {
+    if(questsInProgress.empty())
+        return;
+    QuestIndex* index = getQuestIndex();
+    const QuestIndex::QuestSet* wanted = index->getMobQuests(monster->info);
+    index->startCounting(this);
     for(std::pair<int, QuestCompletion*> p : questsInProgress) {
         QuestCompletion* quest = p.second;
-        quest->updateMobKills(monster);
+        quest->updateMobKills(monster, wanted && wanted->contains(quest));
     }
+    index->stopCounting();
 }
 
 void Player::updateItems(Object* object) {
+    if(questsInProgress.empty())
+        return;
+    QuestIndex* index = getQuestIndex();
+    const QuestIndex::QuestSet* wanted = index->getItemQuests(object->info);
+    index->startCounting(this);
     for(std::pair<int, QuestCompletion*> p : questsInProgress) {
         QuestCompletion* quest = p.second;
-        quest->updateItems(object);
+        quest->updateItems(object, wanted && wanted->contains(quest));
     }
+    index->stopCounting();
 }
 void Player::updateRooms(UniqueRoom* room) {
+    if(questsInProgress.empty())
+        return;
+    QuestIndex* index = getQuestIndex();
+    const QuestIndex::QuestSet* wanted = index->getRoomQuests(room->info);
+    index->startCounting(this);
     for(std::pair<int, QuestCompletion*> p : questsInProgress) {
         QuestCompletion* quest = p.second;
-        quest->updateRooms(room);
+        quest->updateRooms(room, wanted && wanted->contains(quest));
     }
+    index->stopCounting();
 }
-void QuestCompletion::updateMobKills(Monster* monster) {
+void QuestCompletion::updateMobKills(Monster* monster, bool wanted) {
+    if(!wanted) {
+        checkQuestCompletion();
+        return;
+    }
     //std::list<QuestCatRef> mobsKilled;
     for(QuestCatRef & qcr : mobsKilled) {
         if(qcr == monster->info) {
@@ -601,7 +635,11 @@ void QuestCompletion::updateMobKills(Monster* monster) {
 }
 
 // Called when adding an item to inventory, but before it is put in the list of items
-void QuestCompletion::updateItems(Object* object) {
+void QuestCompletion::updateItems(Object* object, bool wanted) {
+    if(!wanted) {
+        checkQuestCompletion();
+        return;
+    }
     for(QuestCatRef & qcr : parentQuest->itemsToGet) {
         if(qcr == object->info && object->isQuestOwner(parentPlayer)) {
             int curNum = parentPlayer->countItems(qcr)-1;
@@ -623,9 +661,13 @@ void QuestCompletion::updateItems(Object* object) {
     }
     checkQuestCompletion();
 }
-void QuestCompletion::updateRooms(UniqueRoom* room) {
+void QuestCompletion::updateRooms(UniqueRoom* room, bool wanted) {
     if(roomsCompleted)
         return;
+    if(!wanted) {
+        checkQuestCompletion();
+        return;
+    }
     for(QuestCatRef & qcr : roomsVisited) {
         if(qcr == room->info) {
             if(qcr.curNum != 1) {
@@ -869,6 +911,8 @@ bool Object::isQuestValid() const {
 // Count how many of a given item this player has that are non-broken
 int Player::countItems(const QuestCatRef& obj) {
     int total=0;
+    if(questIndex && questIndex->getCount(obj, total))
+        return(total);
     for(Object* object : objects) {
         // Items only count if they're a bag and have 0 shots, or if
         // they're not a bag, and don't have 0 shots (unless shotsmax is 0)
@@ -885,6 +929,103 @@ int Player::countItems(const QuestCatRef& obj) {
     return(total);
 }
 
+//*********************************************************************
+//                      QuestIndex
+//*********************************************************************
+
+unsigned long QuestIndex::lastGeneration = 0;
+
+void QuestIndex::questsReloaded() {
+    lastGeneration++;
+}
+
+void QuestIndex::sync(const std::map<int, QuestCompletion*>& quests) {
+    if(generation == lastGeneration && indexed.size() == quests.size() &&
+        std::equal(quests.begin(), quests.end(), indexed.begin(), [](const auto& p, const Entry& e) {
+            return(p.first == e.id && p.second == e.quest);
+        })
+    )
+        return;
+
+    generation = lastGeneration;
+    indexed.clear();
+    mobs.clear();
+    items.clear();
+    rooms.clear();
+    for(const auto& [id, quest] : quests) {
+        indexed.push_back({id, quest});
+        for(const QuestCatRef& mob : quest->mobsKilled)
+            mobs[mob].insert(quest);
+        for(const QuestCatRef& obj : quest->parentQuest->itemsToGet)
+            items[obj].insert(quest);
+        for(const QuestCatRef& room : quest->roomsVisited)
+            rooms[room].insert(quest);
+    }
+}
+
+const QuestIndex::QuestSet* QuestIndex::find(const RefQuests& refs, const CatRef& ref) {
+    auto it = refs.find(ref);
+    return(it == refs.end() ? nullptr : &it->second);
+}
+const QuestIndex::QuestSet* QuestIndex::getMobQuests(const CatRef& mob) const {
+    return(find(mobs, mob));
+}
+const QuestIndex::QuestSet* QuestIndex::getItemQuests(const CatRef& obj) const {
+    return(find(items, obj));
+}
+const QuestIndex::QuestSet* QuestIndex::getRoomQuests(const CatRef& room) const {
+    return(find(rooms, room));
+}
+
+//*********************************************************************
+//                      startCounting
+//*********************************************************************
+// Counts every wanted object the way countItems does, in one pass. Nothing
+// the quests do while handling one event changes the inventory, so the
+// counts hold until stopCounting.
+
+void QuestIndex::startCounting(const Player* player) {
+    counts.clear();
+    counting = false;
+    if(items.empty())
+        return;
+
+    for(const auto& [obj, quests] : items)
+        counts[obj] = 0;
+    auto tally = [this](const Object* object) {
+        if(!object->isQuestValid())
+            return;
+        auto it = counts.find(object->info);
+        if(it != counts.end())
+            it->second++;
+    };
+    for(Object* object : player->objects) {
+        if(!object)
+            continue;
+        tally(object);
+        if(object->getType() == ObjectType::CONTAINER) {
+            for(Object* subObj : object->objects)
+                tally(subObj);
+        }
+    }
+    counting = true;
+}
+
+void QuestIndex::stopCounting() {
+    counting = false;
+    counts.clear();
+}
+
+bool QuestIndex::getCount(const CatRef& obj, int& count) const {
+    if(!counting)
+        return(false);
+    auto it = counts.find(obj);
+    if(it == counts.end())
+        return(false);
+    count = it->second;
+    return(true);
+}
+
 bool prepareItemList(const Player* player, std::list<Object*> &objects, Object* object, const Monster* monster, bool isTrade, bool setTradeOwner, int totalBulk);
 
 bool QuestCompletion::complete(Monster* monster) {
@@ -0,0 +1,88 @@
+/*
+ * allocStats.cpp
+ *   Counts of memory allocated through operator new
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <cstdlib>          // for malloc, free
+#include <new>              // for bad_alloc, get_new_handler, nothrow_t
+
+#include "allocStats.hpp"   // for AllocCount
+
+// Replaces the global operator new/delete so every allocation made through
+// them is counted. Plain (zero-initialised) thread_local, so there's no
+// construction cost on first use in a thread.
+static thread_local AllocCount allocCount{};
+
+AllocCount getAllocCount() {
+    return(allocCount);
+}
+
+void* operator new(std::size_t size) {
+    allocCount.bytes += size;
+    allocCount.count++;
+
+    if(size == 0)
+        size = 1;
+    for(;;) {
+        void* ptr = malloc(size);
+        if(ptr)
+            return(ptr);
+        std::new_handler handler = std::get_new_handler();
+        if(!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return(::operator new(size));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return(::operator new(size));
+    } catch(...) {
+        return(nullptr);
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return(::operator new(size, std::nothrow));
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
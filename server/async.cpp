@@ -17,8 +17,11 @@
  */
 #include "async.hpp"
 
+#include <cstdint>                  // for uint64_t
 #include <cstdlib>                  // for abort, exit
-#include <unistd.h>                 // for close, dup2, execl, fork, pipe, STDOUT_FILENO
+#include <spawn.h>                  // for posix_spawn, posix_spawn_file_actions_t
+#include <sys/eventfd.h>            // for eventfd, EFD_NONBLOCK
+#include <unistd.h>                 // for close, dup2, fork, pipe, STDOUT_FILENO
 #include <ostream>                  // for operator<<, basic_ostream::operator<<, basi...
 #include <string>                   // for operator<<, char_traits
 
@@ -41,9 +44,15 @@
 //      player->print("Doing something long and arduous.\n");
 //  }
 //
-// Responses to asychronous communication are handled in Server::reapChildren().
-// Create your own CHILD_XYZ type if you want to perform special handling. The
-// ChildType::PRINT type simply prints the response back to the player.
+// Responses to asychronous communication are handled in Server::processChildren()
+// and Server::reapChildren(), which hand the child's output to its ChildHandler.
+// Pass your own handler to branch() if you want to perform special handling;
+// otherwise the handler for the ChildType is used. The ChildType::PRINT type
+// simply prints the response back to the player.
+//
+// Branching copies the whole game, so it's only for work that needs a snapshot
+// of it. Work that doesn't (waiting on another program, the network, etc)
+// belongs on the AsyncPool, via Server::runAsync.
 
 Async::Async() {
 }
@@ -52,7 +61,7 @@ Async::Async() {
 //                      branch
 //*********************************************************************
 
-AsyncResult Async::branch(const Player* player, ChildType type) {
+AsyncResult Async::branch(const Player* player, ChildType type, ChildHandler handler) {
     std::string user = (player ? player->getName() : "Someone");
     if(pipe(fds) == -1) {
         std::clog << "Error with pipe!\n";
@@ -81,27 +90,153 @@ AsyncResult Async::branch(const Player* player, ChildType type) {
         std::clog << "Watching Child " << (int)type << " for (" << user << ") running with pid " << pid << " reading from fd " << fds[0] << ".";
 
         // Let the server know we're monitoring this child process
-        gServer->addChild(pid, type, fds[0], user);
+        gServer->addChild(pid, type, fds[0], user, std::move(handler));
 
         return(AsyncLocal);
     }
 }
 
 
+//*********************************************************************
+//                      AsyncPool
+//*********************************************************************
+
+AsyncPool::AsyncPool(int pThreads): numThreads(pThreads) {
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(eventFd == -1)
+        std::clog << "AsyncPool: Unable to create eventfd\n";
+}
+
+AsyncPool::~AsyncPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for(std::thread& thread : threads)
+        thread.join();
+    if(eventFd != -1)
+        close(eventFd);
+}
+
+int AsyncPool::getFd() const {
+    return(eventFd);
+}
+
+size_t AsyncPool::queued() {
+    std::lock_guard<std::mutex> guard(lock);
+    return(jobs.size());
+}
+
+//*********************************************************************
+//                      run
+//*********************************************************************
+
+void AsyncPool::run(AsyncJob job) {
+    // Threads are only started once we actually need one
+    if(threads.empty()) {
+        for(int i = 0; i < numThreads; i++)
+            threads.emplace_back(&AsyncPool::work, this);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+//*********************************************************************
+//                      runCallbacks
+//*********************************************************************
+
+int AsyncPool::runCallbacks() {
+    uint64_t count = 0;
+    if(eventFd != -1)
+        (void)read(eventFd, &count, sizeof(count));
+
+    std::list<AsyncCallback> done;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done.swap(callbacks);
+    }
+    for(AsyncCallback& callback : done)
+        callback();
+    return(static_cast<int>(done.size()));
+}
+
+//*********************************************************************
+//                      work
+//*********************************************************************
+
+void AsyncPool::work() {
+    for(;;) {
+        AsyncJob job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return(stopping || !jobs.empty()); });
+            if(stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        AsyncCallback callback = job();
+        if(!callback)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            callbacks.push_back(std::move(callback));
+        }
+        uint64_t one = 1;
+        if(eventFd != -1)
+            (void)write(eventFd, &one, sizeof(one));
+    }
+}
+
+
 //********************************************************************
 //                      runList
 //********************************************************************
+// The lister is a separate program, so there's no need to copy the game to
+// run it: spawn it directly with its stdout on a pipe we watch.
 
 int Server::runList(Socket* sock, cmd* cmnd) {
-    Async async;
-    if(async.branch(sock->getPlayer(), ChildType::LISTER) == AsyncExternal) {
-        std::string lister = "/mud/List";
-        std::clog << "Running <" << lister << ">\n";
+    int listFds[2];
+    std::string lister = "/mud/List";
+    std::string user = (sock->getPlayer() ? sock->getPlayer()->getName() : "Someone");
 
-        execl(lister.c_str(), lister.c_str(), cmnd->str[1], cmnd->str[2], cmnd->str[3], cmnd->str[4], nullptr);
-        std::clog << "Error!";
+    if(pipe(listFds) == -1) {
+        std::clog << "Error with pipe!\n";
+        return(0);
+    }
 
-        exit(0);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addclose(&actions, listFds[0]);
+    posix_spawn_file_actions_adddup2(&actions, listFds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, listFds[1]);
+
+    char* argv[] = { lister.data(), cmnd->str[1], cmnd->str[2], cmnd->str[3], cmnd->str[4], nullptr };
+    pid_t pid = 0;
+    std::clog << "Running <" << lister << ">\n";
+    int res = posix_spawn(&pid, lister.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(listFds[1]);
+
+    if(res != 0) {
+        std::clog << "Error running " << lister << ": " << res << "\n";
+        close(listFds[0]);
+        return(0);
     }
+
+    nonBlock(listFds[0]);
+    // The socket may be gone, and its slot reused, by the time there's output
+    SocketHandle requester = sock->getHandle();
+    addChild(pid, ChildType::LISTER, listFds[0], user, [this, requester](childProcess& child, bool onReap) {
+        processListOutput(child, requester);
+    });
     return(0);
 }
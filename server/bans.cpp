@@ -16,13 +16,16 @@
  *
  */
 
+#include <arpa/inet.h>             // for inet_pton
 #include <fmt/format.h>            // for format
 #include <strings.h>               // for strncasecmp
+#include <algorithm>               // for min, push_heap, pop_heap
 #include <cctype>                  // for isspace, isgraph, isdigit
 #include <cstdio>                  // for sprintf
 #include <cstdlib>                 // for atoi, free
 #include <cstring>                 // for strlen, strcpy, strstr, memcpy
 #include <ctime>                   // for time, ctime, size_t
+#include <functional>              // for greater
 #include <list>                    // for list, operator==, list<>::iterator
 #include <ostream>                 // for operator<<, basic_ostream, ostring...
 #include <string>                  // for string, operator<<, char_traits
@@ -71,7 +74,178 @@ bool Ban::matches(std::string_view toMatch) {
     return(false);
 }
 
+//*********************************************************************
+//                      BanMatcher
+//*********************************************************************
+// Each ban goes wherever Ban::matches would look for it.
+
+BanMatcher::BanMatcher(const std::list<Ban*>& bans) {
+    prefixes.emplace_back();
+    suffixes.emplace_back();
+    ipv4.emplace_back();
+    ipv6.emplace_back();
+
+    for(Ban* ban : bans) {
+        // Better safe than sorry
+        if(!ban)
+            continue;
+        size_t pos = order.size();
+        order.push_back(ban);
+        if(ban->unbanTime != 0) {
+            expiry.emplace_back(ban->unbanTime, ban);
+            std::push_heap(expiry.begin(), expiry.end(), std::greater<>());
+        }
+
+        if(ban->site == "*") {
+            everyone = std::min(everyone, pos);
+        } else if(ban->isPrefix && ban->isSuffix) {
+            contains.emplace_back(ban->site, pos);
+        } else if(ban->isPrefix) {
+            addChar(prefixes, ban->site, pos);
+        } else if(ban->isSuffix) {
+            addChar(suffixes, std::string(ban->site.rbegin(), ban->site.rend()), pos);
+        } else {
+            exact.try_emplace(ban->site, pos);
+            addCidr(ban->site, pos);
+        }
+    }
+}
+
+void BanMatcher::addChar(std::vector<CharNode>& trie, std::string_view site, size_t pos) {
+    size_t node = 0;
+    for(char ch : site) {
+        auto it = trie[node].next.find(ch);
+        if(it == trie[node].next.end()) {
+            trie[node].next[ch] = trie.size();
+            node = trie.size();
+            trie.emplace_back();
+        } else {
+            node = it->second;
+        }
+    }
+    trie[node].ban = std::min(trie[node].ban, pos);
+}
+
+void BanMatcher::addBits(std::vector<BitNode>& trie, const unsigned char* addr, int bits, size_t pos) {
+    size_t node = 0;
+    for(int i = 0; i < bits; i++) {
+        int bit = (addr[i / 8] >> (7 - i % 8)) & 1;
+        if(trie[node].next[bit] == NONE) {
+            trie[node].next[bit] = trie.size();
+            trie.emplace_back();
+        }
+        node = trie[node].next[bit];
+    }
+    trie[node].ban = std::min(trie[node].ban, pos);
+}
+
+//*********************************************************************
+//                      addCidr
+//*********************************************************************
+// "address/bits" matches every IP in that block; anything else is left
+// to the exact match it always was.
+
+bool BanMatcher::addCidr(const std::string& site, size_t pos) {
+    size_t slash = site.find('/');
+    if(slash == std::string::npos || slash + 1 == site.size() || site.size() - slash > 4)
+        return(false);
+    int bits = 0;
+    for(size_t i = slash + 1; i < site.size(); i++) {
+        if(!isdigit(site[i]))
+            return(false);
+        bits = bits * 10 + (site[i] - '0');
+    }
+
+    std::string address = site.substr(0, slash);
+    unsigned char addr[16];
+    if(inet_pton(AF_INET, address.c_str(), addr) == 1 && bits <= 32)
+        addBits(ipv4, addr, bits, pos);
+    else if(inet_pton(AF_INET6, address.c_str(), addr) == 1 && bits <= 128)
+        addBits(ipv6, addr, bits, pos);
+    else
+        return(false);
+    return(true);
+}
+
+//*********************************************************************
+//                      find
+//*********************************************************************
+
+size_t BanMatcher::findChar(const std::vector<CharNode>& trie, std::string_view site, bool reversed) {
+    size_t node = 0, found = trie[0].ban;
+    for(size_t i = 0; i < site.size(); i++) {
+        auto it = trie[node].next.find(reversed ? site[site.size() - 1 - i] : site[i]);
+        if(it == trie[node].next.end())
+            break;
+        node = it->second;
+        found = std::min(found, trie[node].ban);
+    }
+    return(found);
+}
+
+size_t BanMatcher::findBits(const std::vector<BitNode>& trie, const unsigned char* addr, int bits) {
+    size_t node = 0, found = trie[0].ban;
+    for(int i = 0; i < bits; i++) {
+        node = trie[node].next[(addr[i / 8] >> (7 - i % 8)) & 1];
+        if(node == NONE)
+            break;
+        found = std::min(found, trie[node].ban);
+    }
+    return(found);
+}
+
+size_t BanMatcher::findPos(std::string_view site) const {
+    size_t found = everyone;
+
+    auto it = exact.find(std::string(site));
+    if(it != exact.end())
+        found = std::min(found, it->second);
+    found = std::min(found, findChar(prefixes, site, false));
+    found = std::min(found, findChar(suffixes, site, true));
+    for(const auto& [text, pos] : contains) {
+        if(pos < found && site.find(text) != std::string_view::npos)
+            found = pos;
+    }
+
+    if(ipv4.size() > 1 || ipv6.size() > 1) {
+        std::string address(site);
+        unsigned char addr[16];
+        if(inet_pton(AF_INET, address.c_str(), addr) == 1) {
+            found = std::min(found, findBits(ipv4, addr, 32));
+        } else if(inet_pton(AF_INET6, address.c_str(), addr) == 1) {
+            found = std::min(found, findBits(ipv6, addr, 128));
+            // ::ffff:a.b.c.d is an IPv4 address too
+            static const unsigned char mapped[12] = { 0,0,0,0, 0,0,0,0, 0,0,0xff,0xff };
+            if(std::equal(mapped, mapped + 12, addr))
+                found = std::min(found, findBits(ipv4, addr + 12, 32));
+        }
+    }
+    return(found);
+}
+
+Ban* BanMatcher::find(std::string_view site) const {
+    size_t pos = findPos(site);
+    return(pos == NONE ? nullptr : order[pos]);
+}
 
+Ban* BanMatcher::find(std::string_view host, std::string_view ip) const {
+    size_t pos = std::min(findPos(host), findPos(ip));
+    return(pos == NONE ? nullptr : order[pos]);
+}
+
+//*********************************************************************
+//                      popExpired
+//*********************************************************************
+
+std::vector<Ban*> BanMatcher::popExpired(time_t now) {
+    std::vector<Ban*> expired;
+    while(!expiry.empty() && now > expiry.front().first) {
+        std::pop_heap(expiry.begin(), expiry.end(), std::greater<>());
+        expired.push_back(expiry.back().second);
+        expiry.pop_back();
+    }
+    return(expired);
+}
 
 
 int dmListbans(Player* player, cmd* cmnd) {
@@ -179,7 +353,7 @@ int dmBan(Player* player, cmd* cmnd) {
     lowercize(who, 1);
     target = gServer->findPlayer(who);
     if(!target || target == player) {
-        if((!strstr(site, "*") && !strstr(site, ".")) || !player->isDm()) {
+        if((!strstr(site, "*") && !strstr(site, ".") && !strstr(site, ":")) || !player->isDm()) {
             player->print("%s is not on.\n", who);
             return(0);
         }
@@ -348,7 +522,7 @@ int dmBan(Player* player, cmd* cmnd) {
 void Server::checkBans() {
     static const char* banString = "\n\rThe watcher just arrived.\n\rThe watcher says, \"Begone from this place!\".\n\rThe watcher banishes your soul from this world.\n\r\n\r\n\r";
 
-    for(auto sock : sockets) {
+    for(auto& sock : sockets) {
         if(sock.getPlayer() && (gConfig->isBanned(sock.getIp()) ||
             gConfig->isBanned(sock.getHostname()))) {
             if(sock.getPlayer()->getClass() <= CreatureClass::BUILDER) {
@@ -392,9 +566,40 @@ int dmUnban(Player* player, cmd* cmnd) {
 
 bool Config::addBan(Ban* toAdd) {
     bans.push_back(toAdd);
+    bansChanged();
     return(true);   
 }
 
+// The list changed; the matcher is built again the next time it's needed
+void Config::bansChanged() {
+    delete banMatcher;
+    banMatcher = nullptr;
+}
+
+BanMatcher* Config::getBanMatcher() {
+    if(!banMatcher)
+        banMatcher = new BanMatcher(bans);
+    return(banMatcher);
+}
+
+//*********************************************************************
+//                      expireBans
+//*********************************************************************
+
+void Config::expireBans() {
+    std::vector<Ban*> expired = getBanMatcher()->popExpired(time(nullptr));
+    if(expired.empty())
+        return;
+
+    for(Ban* ban : expired) {
+        broadcast(isCt, "^y--- Expiring ban for '%s'", ban->site.c_str());
+        bans.remove(ban);
+        delete ban;
+    }
+    bansChanged();
+    saveBans();
+}
+
 bool Config::deleteBan(int toDel) {
     std::list<Ban*>::iterator it;
     int count=0;
@@ -405,6 +610,7 @@ bool Config::deleteBan(int toDel) {
             Ban* ban = (*it);
             bans.erase(it);
             delete ban;
+            bansChanged();
             return(true);
         }
     }
@@ -420,36 +626,11 @@ bool Config::deleteBan(int toDel) {
 // then 2 is returned.  If it's completely locked, 1 is returned.  If
 // it's not locked out at all, 0 is returned.
 int Config::isLockedOut( Socket* sock ) {
-    bool match = false;
-    int count=0;
-
-    std::list<Ban*>::iterator it;
-    Ban* ban = nullptr;
-
-    for(it = bans.begin() ; it != bans.end() ; it++) {
-        count++;
-        ban = (*it);
-        // Better safe than sorry
-        if(!ban)
-            continue;
-        
-        if(ban->matches(sock->getHostname()) || ban->matches(sock->getIp())) {
-            match = true;
-            break;
-        }
-    }
-    if(!match)
+    expireBans();
+    Ban* ban = getBanMatcher()->find(sock->getHostname(), sock->getIp());
+    if(!ban)
         return(0);
 
-    if(ban->unbanTime != 0 && time(nullptr) > ban->unbanTime) {
-        // Ban has expired so delete it
-        broadcast(isCt, "^y--- Expiring ban for '%s'", ban->site.c_str());
-        deleteBan(count);
-        saveBans();
-
-        // See if they're effected by another ban
-        return(isLockedOut(sock));
-    }
     if(!ban->password.empty()) {
         strcpy(sock->tempstr[0], ban->password.c_str());
         return (2);
@@ -464,18 +645,8 @@ int Config::isLockedOut( Socket* sock ) {
 
 // Returns 1 if the site is on the ban list, 0 otherwise
 bool Config::isBanned(std::string_view site) {
-    std::list<Ban*>::iterator it;
-    Ban* ban;
-
-    for(it = bans.begin() ; it != bans.end() ; it++) {
-        ban = (*it);
-        // Better safe than sorry
-        if(!ban)
-            continue;
-        if(ban->matches(site))
-            return(true);
-    }
-    return (false);
+    expireBans();
+    return(getBanMatcher()->find(site) != nullptr);
 }
 
 // Clears bans
@@ -488,5 +659,6 @@ void Config::clearBanList() {
         bans.pop_front();
     }
     bans.clear();
+    bansChanged();
 }
 
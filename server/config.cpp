@@ -29,11 +29,13 @@
 #include <ostream>             // for operator<<, endl, basic_ostream, ostream
 #include <stdexcept>           // for runtime_error
 #include <string>              // for string, allocator, operator==
+#include <string_view>         // for string_view
 #include <utility>             // for pair
 
 #include "alchemy.hpp"         // for AlchemyInfo
 #include "calendar.hpp"        // for Calendar, cSeason, cWeather (ptr only)
 #include "catRef.hpp"          // for CatRef
+#include "compressor.hpp"      // for CompressProfile
 #include "config.hpp"          // for Config, accountDouble, MudFlagMap, Dis...
 #include "effects.hpp"         // for Effect
 #include "fishing.hpp"         // for Fishing
@@ -176,6 +178,12 @@ void Config::reset(bool reload) {
 
     flashPolicyPort = 0;
     shopNumObjects = shopNumLines = 0;
+    commandRate = commandBurst = staffCommandRate = staffCommandBurst = 0;
+    tickRate = 0;
+    mccpLevel = mccpWindow = mccpMemLevel = 0;
+    mccpBusyLevel = mccpBusyWindow = mccpBusyMemLevel = 0;
+    mccpBusyAfter = mccpIdle = 0;
+    mccpThread = false;
 
     dmPass = "default_dm_pw";
     webserver = qs = userAgent = reviewer = "";
@@ -358,6 +366,26 @@ void Config::toggleTxtOnCrash() { txtOnCrash = !txtOnCrash; }
 
 int Config::getShopNumObjects() const { return(shopNumObjects ? shopNumObjects : 400); }
 int Config::getShopNumLines() const { return(shopNumLines ? shopNumLines : 150); }
+const std::string &Config::getLogDbType() const { return(logDbType); }
+int Config::getTickRate() const { return(tickRate ? tickRate : 10); }
+int Config::getCommandRate(bool staff) const {
+    if(staff) return(staffCommandRate ? staffCommandRate : 20);
+    return(commandRate ? commandRate : 4);
+}
+int Config::getCommandBurst(bool staff) const {
+    if(staff) return(staffCommandBurst ? staffCommandBurst : 40);
+    return(commandBurst ? commandBurst : 8);
+}
+// Quiet connections get a small window so they hold ~18k of zlib state rather than ~260k
+CompressProfile Config::getCompressProfile(bool busy) const {
+    if(busy)
+        return(CompressProfile{mccpBusyLevel ? mccpBusyLevel : 6, mccpBusyWindow ? mccpBusyWindow : 15, mccpBusyMemLevel ? mccpBusyMemLevel : 8});
+    return(CompressProfile{mccpLevel ? mccpLevel : 6, mccpWindow ? mccpWindow : 10, mccpMemLevel ? mccpMemLevel : 4});
+}
+int Config::getCompressBusyAfter() const { return(mccpBusyAfter ? mccpBusyAfter : 65536); }
+// Negative never releases them
+int Config::getCompressIdle() const { return(mccpIdle ? mccpIdle : 120); }
+bool Config::getCompressThread() const { return(mccpThread); }
 
 const cWeather* Config::getWeather() const { return(calendar->getCurSeason()->getWeather()); }
 
@@ -446,6 +474,37 @@ namespace Path {
     const char* BuilderHelp = "/home/realms/realms/help/bhelp/";
     const char* HelpTemplate = "/home/realms/realms/help/template/";
 }
+
+//*********************************************************************
+//                      setRoot
+//*********************************************************************
+// Moves every path above from /home/realms/realms/ to root (which ends in
+// a slash), so a copy of a world can be run somewhere else. Python looks in
+// root's config/code/python/ first, then in the usual places.
+
+void Path::setRoot(const std::string& root) {
+    static const std::string_view oldRoot = "/home/realms/realms/";
+    // The pointers have to stay good for the life of the server
+    static std::list<std::string> held;
+
+    const char** paths[] = {
+        &Bin, &Log, &BugLog, &StaffLog, &BankLog, &GuildBankLog,
+        &UniqueRoom, &AreaRoom, &Monster, &Object, &Player, &PlayerBackup,
+        &Config, &Code, &Game, &AreaData, &Talk, &Desc, &Sign,
+        &PlayerData, &Bank, &GuildBank, &History, &Post,
+        &BaseHelp, &Help, &CreateHelp, &Wiki, &DMHelp, &BuilderHelp, &HelpTemplate
+    };
+    for(const char** path : paths) {
+        std::string_view current = *path;
+        if(!current.starts_with(oldRoot))
+            continue;
+        held.push_back(root + std::string(current.substr(oldRoot.size())));
+        *path = held.back().c_str();
+    }
+
+    held.push_back(root + "config/code/python/:" + Python);
+    Python = held.back().c_str();
+}
 //*********************************************************************
 //                      path functions
 //*********************************************************************
@@ -28,6 +28,7 @@
 #include "cmd.hpp"                                  // for cmd
 #include "flags.hpp"                                // for M_ANTI_MAGIC_AURA
 #include "free_crt.hpp"                             // for free_crt
+#include "keyIndex.hpp"                             // for KeyIndex, KEYINDEX_MIN
 #include "location.hpp"                             // for Location
 #include "mudObjects/areaRooms.hpp"                 // for AreaRoom
 #include "mudObjects/container.hpp"                 // for Container, Contai...
@@ -51,6 +52,24 @@ Container::Container() {
 
 }
 
+Container::Container(const Container& c): MudObject(c), players(c.players), monsters(c.monsters), objects(c.objects) {
+}
+
+Container& Container::operator=(const Container& c) {
+    if(this == &c)
+        return(*this);
+    players = c.players;
+    monsters = c.monsters;
+    objects = c.objects;
+    delete keyIndex;
+    keyIndex = nullptr;
+    return(*this);
+}
+
+Container::~Container() {
+    delete keyIndex;
+}
+
 
 bool Container::purge(bool includePets) {
     bool purgedAll = true;
@@ -83,6 +102,8 @@ bool Container::purgeMonsters(bool includePets) {
         }
 
         monsters.erase(prevIt);
+        if(keyIndex)
+            keyIndex->monsters.remove(mons);
         free_crt(mons);
     }
     return(purgedAll);
@@ -96,6 +117,8 @@ bool Container::purgeObjects() {
         obj = (*oIt++);
         if(!obj->flagIsSet(O_TEMP_PERM)) {
             objects.erase(prevIt);
+            if(keyIndex)
+                keyIndex->objects.remove(obj);
             delete obj;
         } else {
             purgedAll = false;
@@ -115,12 +138,18 @@ Container* Container::remove(Containable* toRemove) {
     bool toReturn;
     if(remObject) {
         objects.erase(remObject);
+        if(keyIndex)
+            keyIndex->objects.remove(remObject);
         toReturn = true;
     } else if(remPlayer) {
         players.erase(remPlayer);
+        if(keyIndex)
+            keyIndex->players.remove(remPlayer);
         toReturn = true;
     } else if(remMonster) {
         monsters.erase(remMonster);
+        if(keyIndex)
+            keyIndex->monsters.remove(remMonster);
         toReturn = true;
     } else {
         std::clog << "Don't know how to remove " << toRemove << std::endl;
@@ -157,12 +186,18 @@ bool Container::add(Containable* toAdd) {
     if(addObject) {
         std::pair<ObjectSet::iterator, bool> p = objects.insert(addObject);
         toReturn = p.second;
+        if(toReturn && keyIndex)
+            keyIndex->objects.add(addObject);
     } else if(addPlayer) {
         std::pair<PlayerSet::iterator, bool> p = players.insert(addPlayer);
         toReturn = p.second;
+        if(toReturn && keyIndex)
+            keyIndex->players.add(addPlayer);
     } else if(addMonster) {
         std::pair<MonsterSet::iterator, bool> p = monsters.insert(addMonster);
         toReturn = p.second;
+        if(toReturn && keyIndex)
+            keyIndex->monsters.add(addMonster);
     } else {
         std::clog << "Don't know how to add " << toAdd << std::endl;
         toReturn = false;
@@ -241,6 +276,24 @@ MudObject* Container::findTarget(const Creature* searcher, const std::string& na
     return(toReturn);
 }
 
+//*********************************************************************
+//                      findMatch
+//*********************************************************************
+// The num'th thing in targets the searcher can see that matches name;
+// match carries on counting from wherever the last search left it
+
+template <class Targets>
+static typename Targets::value_type findMatch(const Targets& targets, const Creature* searcher, const std::string& name, int num, bool exactMatch, int& match) {
+    for(auto* target : targets) {
+        if(isMatch(searcher, target, name, exactMatch, true)) {
+            match++;
+            if(match == num)
+                return(target);
+        }
+    }
+    return(nullptr);
+}
+
 // Wrapper for the real findObject to support legacy callers
 Object* Container::findObject(const Creature *searcher, const cmd* cmnd, int val) const {
     return(findObject(searcher, cmnd->str[val], cmnd->val[val]));
@@ -250,23 +303,9 @@ Object* Container::findObject(const Creature* searcher, const std::string& name,
     return(findObject(searcher, name, num,exactMatch, match));
 }
 Object* Container::findObject(const Creature* searcher, const std::string& name, const int num, bool exactMatch, int& match) const {
-    Object *target = nullptr;
-    for(Object* obj : objects) {
-        if(isMatch(searcher, obj, name, exactMatch, true)) {
-            match++;
-            if(match == num) {
-                if(exactMatch)
-                    return(obj);
-                else {
-                    target = obj;
-                    break;
-                }
-
-            }
-        }
-    }
-
-    return(target);
+    if(KeyIndex* index = useKeyIndex(name, exactMatch, objects.size()))
+        return(findMatch(index->objects.find(objects, keyTxtConvert(name)), searcher, name, num, exactMatch, match));
+    return(findMatch(objects, searcher, name, num, exactMatch, match));
 }
 
 
@@ -358,20 +397,14 @@ Monster* Container::findMonster(const Creature* searcher, const std::string& nam
 }
 Monster* Container::findMonster(const Creature* searcher, const std::string& name, const int num, bool firstAggro, bool exactMatch, int& match) const {
     Monster* target = nullptr;
-    for(Monster* mons : searcher->getParent()->monsters) {
-        if(isMatch(searcher, mons, name, exactMatch, true)) {
-            match++;
-            if(match == num) {
-                if(exactMatch)
-                    return(mons);
-                else {
-                    target = mons;
-                    break;
-                }
+    const Container* room = searcher->getParent();
+    if(KeyIndex* index = room->useKeyIndex(name, exactMatch, room->monsters.size()))
+        target = findMatch(index->monsters.find(room->monsters, keyTxtConvert(name)), searcher, name, num, exactMatch, match);
+    else
+        target = findMatch(room->monsters, searcher, name, num, exactMatch, match);
+    if(exactMatch)
+        return(target);
 
-            }
-        }
-    }
     if(firstAggro && target) {
         if(num < 2 && searcher->pFlagIsSet(P_KILL_AGGROS))
             return(getFirstAggro(target, searcher));
@@ -389,15 +422,25 @@ Player* Container::findPlayer(const Creature* searcher, const std::string& name,
     return(findPlayer(searcher, name, num, exactMatch, match));
 }
 Player* Container::findPlayer(const Creature* searcher, const std::string& name, const int num, bool exactMatch, int& match) const {
-    for(Player* ply : searcher->getParent()->players) {
-        if(isMatch(searcher, ply, name, exactMatch, true)) {
-            match++;
-            if(match == num) {
-                return(ply);
-            }
-        }
-    }
-    return(nullptr);
+    const Container* room = searcher->getParent();
+    if(KeyIndex* index = room->useKeyIndex(name, exactMatch, room->players.size()))
+        return(findMatch(index->players.find(room->players, keyTxtConvert(name)), searcher, name, num, exactMatch, match));
+    return(findMatch(room->players, searcher, name, num, exactMatch, match));
+}
+
+//*********************************************************************
+//                      useKeyIndex
+//*********************************************************************
+// The key index, if it can answer a search for name: only for big
+// containers, and only for names it can be trusted with. Ids and anything
+// with color in it are left to isMatch on every item.
+
+KeyIndex* Container::useKeyIndex(const std::string& name, bool exactMatch, size_t size) const {
+    if(exactMatch || size < KEYINDEX_MIN || name.empty() || name.find_first_of("^0123456789") != std::string::npos)
+        return(nullptr);
+    if(!keyIndex)
+        keyIndex = new KeyIndex();
+    return(keyIndex);
 }
 
 
@@ -645,7 +645,8 @@ void doDemographics() {
 
 void runDemographics() {
 #ifndef NODEMOGRAPHICS
-    if(!fork()) {
+    Async async;
+    if(async.branch(nullptr, ChildType::DEMOGRAPHICS) == AsyncExternal) {
         doDemographics();
         exit(0);
     }
@@ -30,10 +30,12 @@
 #include <utility>                             // for pair
 #include <vector>                              // for vector
 
+#include "async.hpp"                           // for AsyncPool
 #include "color.hpp"                           // for escapeColor
 #include "communication.hpp"                   // for getChannelByDiscordCha...
 #include "config.hpp"                          // for Config, gConfig, Disco...
 #include "flags.hpp"                           // for P_DM_INVIS
+#include "mailbox.hpp"                         // for DiscordMessage, DiscordWho
 #include "mudObjects/players.hpp"              // for Player
 #include "server.hpp"                          // for Server, PlayerMap, gSe...
 
@@ -47,6 +49,7 @@ std::string getUsername(dpp::guild *guild, const dpp::user& author) {
 }
 
 
+// Game loop only
 std::string getWho() {
     bool found = false;
     std::ostringstream whoStr;
@@ -78,6 +81,7 @@ bool Server::initDiscordBot() {
 
     std::cout << "Initializing Discord bot" << std::endl;
     discordBot = new dpp::cluster(gConfig->getBotToken());
+    discordOut = new AsyncPool(1);
 
     /* Create command handler, and specify prefixes */
     commandHandler = new dpp::commandhandler (discordBot);
@@ -94,61 +98,58 @@ bool Server::initDiscordBot() {
                 {},
                 /* Command handler */
                 [command_handler](const std::string& command, const dpp::parameter_list_t& parameters, dpp::command_source src) {
-                    command_handler->reply(dpp::message().add_embed((dpp::embed().set_title("Players currently online").set_description(getWho()))), src);
+                    // The player list belongs to the game loop; it answers when it gets to it
+                    gServer->postEvent(DiscordWho{[command_handler, src](const std::string& who) {
+                        command_handler->reply(dpp::message().add_embed((dpp::embed().set_title("Players currently online").set_description(who))), src);
+                    }});
                 },
                 /* Command description */
                 "Get a list of who is currently logged into the mud."
         );
     });
 
-    discordBot->on_message_create([bot=this->discordBot](const dpp::message_create_t & event) {
+    // Runs on DPP's thread: gather what we need from the message and leave
+    // the rest to the game loop
+    discordBot->on_message_create([](const dpp::message_create_t & event) {
         if (event.msg.author.is_bot()) {
             // Don't respond to bot messages
             return;
         }
 
-        channelPtr chan = getChannelByDiscordChannel(event.msg.channel_id);
         auto guild = dpp::find_guild(event.msg.guild_id);
-        if (chan) {
-            // Second: See if we have a channel
-            const std::string username = getUsername(guild, event.msg.author) + " [Discord]";
-            std::ostringstream contentStr;
-
-            if (!event.msg.content.empty()) {
-                std::string content = event.msg.content;
-
-                // Replace all mentions with the actual users
-                for (auto &[user, guildMember]: event.msg.mentions) {
-                    const auto &mentionName = !guildMember.nickname.empty() ? guildMember.nickname : user.username;
-                    boost::replace_all(content, fmt::format("<@!{}>", guildMember.user_id), fmt::format("@{}", mentionName) );
-                }
-
-                for (auto &mention: event.msg.mention_channels) {
-                    boost::replace_all(content, fmt::format("<#{}>", mention.id), fmt::format("#{}", mention.name));
-                }
-                for (auto &mention: event.msg.mention_roles) {
-                    boost::replace_all(content, fmt::format("<@&{}>", mention), fmt::format("@{}", dpp::find_role(mention)->name));
-                }
-                contentStr << content;
+        std::ostringstream contentStr;
+
+        if (!event.msg.content.empty()) {
+            std::string content = event.msg.content;
+
+            // Replace all mentions with the actual users
+            for (auto &[user, guildMember]: event.msg.mentions) {
+                const auto &mentionName = !guildMember.nickname.empty() ? guildMember.nickname : user.username;
+                boost::replace_all(content, fmt::format("<@!{}>", guildMember.user_id), fmt::format("@{}", mentionName) );
             }
 
-            if (!event.msg.attachments.empty())
-                for (auto& attachment : event.msg.attachments)
-                    contentStr << attachment.url;
-
-            if (!event.msg.embeds.empty())
-                for (auto& embed: event.msg.embeds)
-                    contentStr << embed.url;
-
-            sendGlobalComm(nullptr, escapeColor(contentStr.str()), "", 0, chan, "", username, username);
-        } else {
-            // Third? Generic fallback... or do nothing
-            std::cout << "Got msg " << event.msg.content << " in channel " << event.msg.channel_id << " from "
-                      << event.msg.author.username << " isBot: " << event.msg.author.is_bot() << std::endl;
-            if (event.msg.content == "!ping") {
-                bot->message_create(dpp::message(event.msg.channel_id, "Pong!"));
+            for (auto &mention: event.msg.mention_channels) {
+                boost::replace_all(content, fmt::format("<#{}>", mention.id), fmt::format("#{}", mention.name));
+            }
+            for (auto &mention: event.msg.mention_roles) {
+                if (const dpp::role* role = dpp::find_role(mention))
+                    boost::replace_all(content, fmt::format("<@&{}>", mention), fmt::format("@{}", role->name));
             }
+            contentStr << content;
         }
+
+        if (!event.msg.attachments.empty())
+            for (auto& attachment : event.msg.attachments)
+                contentStr << attachment.url;
+
+        if (!event.msg.embeds.empty())
+            for (auto& embed: event.msg.embeds)
+                contentStr << embed.url;
+
+        // Direct messages have no guild
+        const std::string username = (guild ? getUsername(guild, event.msg.author) : event.msg.author.username) + " [Discord]";
+        gServer->postEvent(DiscordMessage{event.msg.channel_id, username,
+            contentStr.str(), event.msg.content, event.msg.author.username});
     });
     discordBot->start(true);
 
@@ -157,10 +158,56 @@ bool Server::initDiscordBot() {
 
 
 void Server::cleanupDiscordBot() {
+    delete discordOut;
+    discordOut = nullptr;
     delete commandHandler;
     delete discordBot;
 }
 
+//*********************************************************************
+//                      handleDiscordMessage
+//*********************************************************************
+
+void Server::handleDiscordMessage(const DiscordMessage& message) {
+    channelPtr chan = getChannelByDiscordChannel(message.channelId);
+    if (chan) {
+        // Second: See if we have a channel
+        sendGlobalComm(nullptr, escapeColor(message.text), "", 0, chan, "", message.name, message.name);
+    } else {
+        // Third? Generic fallback... or do nothing
+        std::cout << "Got msg " << message.content << " in channel " << message.channelId << " from "
+                  << message.author << std::endl;
+        if (message.content == "!ping") {
+            sendToDiscord([bot=discordBot, channel=message.channelId] {
+                bot->message_create(dpp::message(channel, "Pong!"));
+            });
+        }
+    }
+}
+
+//*********************************************************************
+//                      handleDiscordWho
+//*********************************************************************
+
+void Server::handleDiscordWho(const DiscordWho& who) {
+    sendToDiscord([reply=who.reply, list=getWho()] { reply(list); });
+}
+
+//*********************************************************************
+//                      sendToDiscord
+//*********************************************************************
+// Talking to Discord can block, so it happens on its own thread, in the
+// order it was asked for
+
+void Server::sendToDiscord(std::function<void()> job) {
+    if(!discordOut)
+        return;
+    discordOut->run([job=std::move(job)]() -> AsyncCallback {
+        job();
+        return(nullptr);
+    });
+}
+
 
 bool Server::sendDiscordWebhook(long webhookID, int type, const std::string &author, const std::string &msg) {
     if(!discordBot)
@@ -190,7 +237,6 @@ bool Server::sendDiscordWebhook(long webhookID, int type, const std::string &aut
     }
     wh.id = webhookID;
 
-
-    discordBot->execute_webhook(wh, myMessage);
+    sendToDiscord([bot=discordBot, wh, myMessage] { bot->execute_webhook(wh, myMessage); });
     return true;
 }
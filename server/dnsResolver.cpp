@@ -0,0 +1,173 @@
+/*
+ * dnsResolver.cpp
+ *   Background reverse DNS lookups for incoming connections
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <netdb.h>              // for getnameinfo, EAI_...
+#include <sys/eventfd.h>        // for eventfd, EFD_NONBLOCK
+#include <sys/socket.h>         // for sockaddr
+#include <unistd.h>             // for close, read, write
+#include <cstdint>              // for uint64_t
+#include <iostream>             // for operator<<, basic_ostream, clog
+#include <thread>               // for thread
+
+#include "dnsResolver.hpp"
+
+//********************************************************************
+//                      DnsResolver
+//********************************************************************
+
+DnsResolver::DnsResolver(int pThreads): numThreads(pThreads), shared(std::make_shared<Shared>()) {
+    shared->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(shared->eventFd == -1)
+        std::clog << "DNS: Unable to create resolver eventfd\n";
+}
+
+// Threads still waiting on a lookup find out we've stopped when it returns
+DnsResolver::~DnsResolver() {
+    {
+        std::lock_guard<std::mutex> guard(shared->lock);
+        shared->stopping = true;
+        shared->requests.clear();
+    }
+    shared->wake.notify_all();
+}
+
+DnsResolver::Shared::~Shared() {
+    if(eventFd != -1)
+        close(eventFd);
+}
+
+int DnsResolver::getFd() const {
+    return(shared->eventFd);
+}
+
+size_t DnsResolver::inFlight() const {
+    return(pending.size());
+}
+
+//********************************************************************
+//                      lookup
+//********************************************************************
+
+bool DnsResolver::lookup(std::string_view ip, const sockaddr_in& addr) {
+    std::string key(ip);
+    if(!pending.insert(key).second)
+        return(false);
+
+    // Threads are only started once we actually need one
+    if(!started) {
+        for(int i = 0; i < numThreads; i++)
+            std::thread(&DnsResolver::work, shared).detach();
+        started = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(shared->lock);
+        shared->requests.emplace_back(std::move(key), addr);
+    }
+    shared->wake.notify_one();
+    return(true);
+}
+
+//********************************************************************
+//                      takeResults
+//********************************************************************
+
+std::list<DnsResolver::Result> DnsResolver::takeResults() {
+    uint64_t count = 0;
+    // Clear the eventfd; we take everything that's queued regardless of the count
+    if(shared->eventFd != -1)
+        (void)read(shared->eventFd, &count, sizeof(count));
+
+    std::list<Result> done;
+    {
+        std::lock_guard<std::mutex> guard(shared->lock);
+        done.swap(shared->results);
+    }
+    for(const Result& result : done)
+        pending.erase(result.ip);
+    return(done);
+}
+
+//********************************************************************
+//                      work
+//********************************************************************
+
+void DnsResolver::work(std::shared_ptr<Shared> shared) {
+    for(;;) {
+        std::pair<std::string, sockaddr_in> request;
+        {
+            std::unique_lock<std::mutex> guard(shared->lock);
+            shared->wake.wait(guard, [&shared] { return(shared->stopping || !shared->requests.empty()); });
+            if(shared->stopping)
+                return;
+            request = std::move(shared->requests.front());
+            shared->requests.pop_front();
+        }
+
+        std::string hostName = resolve(request.first, request.second);
+
+        {
+            std::lock_guard<std::mutex> guard(shared->lock);
+            if(shared->stopping)
+                return;
+            shared->results.push_back({std::move(request.first), std::move(hostName)});
+        }
+        uint64_t one = 1;
+        if(shared->eventFd != -1)
+            (void)write(shared->eventFd, &one, sizeof(one));
+    }
+}
+
+//********************************************************************
+//                      resolve
+//********************************************************************
+
+std::string DnsResolver::resolve(const std::string& ip, sockaddr_in addr) {
+    int tries = 0, res = 0;
+    char hbuf[NI_MAXHOST];
+
+    while(tries < 5 && tries >= 0) {
+        res = getnameinfo((struct sockaddr*) &addr, sizeof(addr), hbuf, sizeof(hbuf), nullptr, 0, NI_NAMEREQD);
+
+        if (res != 0) {
+            switch(res) {
+                case EAI_FAIL:
+                case EAI_BADFLAGS:
+                case EAI_MEMORY:
+                case EAI_OVERFLOW:
+                case EAI_SYSTEM:
+                    std::clog << "DNS Error: Unrecoverable error for " << ip << std::endl;
+                    tries = -1;
+                    break;
+                case EAI_NONAME:
+                    std::clog << "DNS Error: Host not found for " << ip << std::endl;
+                    tries = -1;
+                    break;
+                case EAI_AGAIN:
+                default:
+                    std::clog << "DNS Error: Try again for " << ip << std::endl;
+                    tries++;
+                    break;
+            }
+        } else {
+            break;
+        }
+    }
+    std::clog << "DNS: Resolver finished for " << ip << "(" << (!res ? hbuf : ip.c_str()) << ")" << std::endl;
+    return(!res ? std::string(hbuf) : ip);
+}
@@ -0,0 +1,337 @@
+/*
+ * goldLog.cpp
+ *   Background writer for the gold transaction log
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <algorithm>        // for min
+#include <chrono>           // for seconds
+#include <cstdio>           // for remove
+#include <cstdlib>          // for strtoul
+#include <ctime>            // for time
+#include <fstream>          // for ofstream, ifstream
+#include <iostream>         // for clog
+
+#include "goldLog.hpp"      // for GoldLogWriter, GoldEvent, GoldSink
+
+//*********************************************************************
+//                      GoldEvent
+//*********************************************************************
+
+static void appendField(std::string& line, const std::string& field) {
+    for(char ch : field) {
+        if(ch == '\\')      line += "\\\\";
+        else if(ch == '\t') line += "\\t";
+        else if(ch == '\n') line += "\\n";
+        else                line += ch;
+    }
+}
+
+std::string GoldEvent::toLine() const {
+    std::string line;
+    for(const std::string* field : {&player, &id, &target, &source, &room, &type}) {
+        appendField(line, *field);
+        line += '\t';
+    }
+    line += std::to_string(gold) + '\t';
+    appendField(line, direction);
+    return(line);
+}
+
+bool GoldEvent::fromLine(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for(size_t i = 0; i < line.size(); i++) {
+        char ch = line[i];
+        if(ch == '\t') {
+            fields.emplace_back();
+        } else if(ch == '\\' && i + 1 < line.size()) {
+            ch = line[++i];
+            fields.back() += ch == 't' ? '\t' : ch == 'n' ? '\n' : ch;
+        } else {
+            fields.back() += ch;
+        }
+    }
+    if(fields.size() != 8)
+        return(false);
+
+    player = fields[0];
+    id = fields[1];
+    target = fields[2];
+    source = fields[3];
+    room = fields[4];
+    type = fields[5];
+    gold = strtoul(fields[6].c_str(), nullptr, 10);
+    direction = fields[7];
+    return(true);
+}
+
+//*********************************************************************
+//                      FileGoldSink
+//*********************************************************************
+
+FileGoldSink::FileGoldSink(std::string pPath): path(std::move(pPath)) {
+}
+
+bool FileGoldSink::connect() {
+    std::ofstream out(path, std::ios::app);
+    connected = out.good();
+    return(connected);
+}
+
+bool FileGoldSink::insert(const std::vector<GoldEvent>& batch) {
+    std::string text;
+    for(const GoldEvent& event : batch)
+        text += event.toLine() + "\n";
+
+    std::ofstream out(path, std::ios::app);
+    out << text;
+    out.flush();
+    return(out.good());
+}
+
+void FileGoldSink::disconnect() {
+    connected = false;
+}
+
+bool FileGoldSink::isConnected() const {
+    return(connected);
+}
+
+// Every event in a journal or spill file, in the order they were written
+static std::vector<GoldEvent> readEvents(const std::string& path) {
+    std::vector<GoldEvent> fileEvents;
+    std::ifstream in(path);
+    std::string line;
+    GoldEvent event;
+    while(std::getline(in, line)) {
+        if(event.fromLine(line))
+            fileEvents.push_back(event);
+    }
+    return(fileEvents);
+}
+
+//*********************************************************************
+//                      GoldLogWriter
+//*********************************************************************
+
+GoldLogWriter::GoldLogWriter(std::unique_ptr<GoldSink> pSink, std::string pJournal): sink(std::move(pSink)), journalPath(std::move(pJournal)) {
+    spillPath = journalPath + ".spill";
+    // Left behind by a crash: still newer than the journal
+    spilling = std::ifstream(spillPath).good();
+    thread = std::thread(&GoldLogWriter::work, this);
+}
+
+GoldLogWriter::~GoldLogWriter() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    sink->disconnect();
+}
+
+GoldLogWriter::Stats GoldLogWriter::getStats() const {
+    return(Stats{queued, flushed, journaled, spilled, replayed, dropped, batches, pending, connected});
+}
+
+//*********************************************************************
+//                      post
+//*********************************************************************
+
+void GoldLogWriter::post(GoldEvent event) {
+    queued++;
+
+    // Too far behind: keep memory bounded and put it on disk ourselves. Once
+    // we start, everything goes there until the writer takes the spill back,
+    // or newer events would get to the sink ahead of older ones.
+    if(spilling || pending >= GOLDLOG_QUEUE) {
+        std::lock_guard<std::mutex> guard(spillLock);
+        if(spilling || pending >= GOLDLOG_QUEUE) {
+            spilling = true;
+            std::ofstream out(spillPath, std::ios::app);
+            out << event.toLine() << "\n";
+            out.flush();
+            if(out.good())
+                spilled++;
+            else
+                dropped++;
+            return;
+        }
+    }
+
+    pending++;
+    events.post(std::move(event));
+    if(pending >= GOLDLOG_BATCH)
+        wake.notify_one();
+}
+
+//*********************************************************************
+//                      work
+//*********************************************************************
+
+void GoldLogWriter::work() {
+    std::vector<GoldEvent> batch;
+    batch.reserve(GOLDLOG_BATCH);
+
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> guard(wakeLock);
+            wake.wait_for(guard, std::chrono::seconds(GOLDLOG_INTERVAL), [this] {
+                return(stopping || pending >= GOLDLOG_BATCH);
+            });
+        }
+        bool stop = stopping;
+
+        // Always have one last try on the way out
+        time_t now = time(nullptr);
+        if(!sink->isConnected() && (stop || now - lastAttempt >= GOLDLOG_RETRY)) {
+            lastAttempt = now;
+            if(sink->connect())
+                std::clog << "Gold log: connected." << std::endl;
+        }
+        connected = sink->isConnected();
+
+        // Anything journaled goes first, so the sink sees events in order
+        if(connected)
+            replay();
+
+        GoldEvent event;
+        while(events.pop(event)) {
+            pending--;
+            batch.push_back(std::move(event));
+            if(batch.size() >= GOLDLOG_BATCH)
+                flush(batch);
+        }
+        if(!batch.empty())
+            flush(batch);
+
+        if(spilling)
+            unspill();
+
+        if(stop)
+            return;
+    }
+}
+
+//*********************************************************************
+//                      flush
+//*********************************************************************
+
+void GoldLogWriter::flush(std::vector<GoldEvent>& batch) {
+    if(sink->isConnected() && sink->insert(batch)) {
+        flushed += batch.size();
+        batches++;
+    } else {
+        if(sink->isConnected()) {
+            std::clog << "Gold log: insert failed, journaling until we can reconnect." << std::endl;
+            sink->disconnect();
+            connected = false;
+        }
+        if(journal(batch))
+            journaled += batch.size();
+        else
+            dropped += batch.size();
+    }
+    batch.clear();
+}
+
+//*********************************************************************
+//                      journal
+//*********************************************************************
+
+bool GoldLogWriter::journal(const std::vector<GoldEvent>& toJournal) {
+    std::string text;
+    for(const GoldEvent& event : toJournal)
+        text += event.toLine() + "\n";
+
+    std::ofstream out(journalPath, std::ios::app);
+    out << text;
+    out.flush();
+    return(out.good());
+}
+
+//*********************************************************************
+//                      replay
+//*********************************************************************
+// Moves the journal into the sink. Whatever doesn't make it goes back in
+// the journal; only this thread writes it, so nothing newer is there yet.
+
+bool GoldLogWriter::replay() {
+    if(!std::ifstream(journalPath))
+        return(true);
+    std::vector<GoldEvent> journaledEvents = readEvents(journalPath);
+    remove(journalPath.c_str());
+    if(journaledEvents.empty())
+        return(true);
+
+    std::clog << "Gold log: replaying " << journaledEvents.size() << " journaled events." << std::endl;
+    size_t done = 0;
+    while(done < journaledEvents.size()) {
+        size_t count = std::min<size_t>(GOLDLOG_BATCH, journaledEvents.size() - done);
+        std::vector<GoldEvent> batch(journaledEvents.begin() + done, journaledEvents.begin() + done + count);
+        if(!sink->insert(batch))
+            break;
+        done += count;
+        replayed += count;
+        batches++;
+    }
+    if(done == journaledEvents.size())
+        return(true);
+
+    std::clog << "Gold log: replay failed, " << journaledEvents.size() - done << " events back to the journal." << std::endl;
+    sink->disconnect();
+    connected = false;
+
+    std::ofstream out(journalPath, std::ios::trunc);
+    for(size_t i = done; i < journaledEvents.size(); i++)
+        out << journaledEvents[i].toLine() << "\n";
+    return(false);
+}
+
+//*********************************************************************
+//                      unspill
+//*********************************************************************
+// Takes back what the game loop put on disk while we were behind. Anything
+// still in the queue was posted before the spill began, so it goes first;
+// once the flag is off the game loop posts to the queue again, and all of
+// that is newer than the spill.
+
+void GoldLogWriter::unspill() {
+    std::vector<GoldEvent> older, spilledEvents;
+    {
+        std::lock_guard<std::mutex> guard(spillLock);
+        GoldEvent event;
+        while(events.pop(event)) {
+            pending--;
+            older.push_back(std::move(event));
+        }
+        spilledEvents = readEvents(spillPath);
+        remove(spillPath.c_str());
+        spilling = false;
+    }
+
+    std::vector<GoldEvent> batch;
+    batch.reserve(GOLDLOG_BATCH);
+    for(std::vector<GoldEvent>* list : {&older, &spilledEvents}) {
+        for(GoldEvent& event : *list) {
+            batch.push_back(std::move(event));
+            if(batch.size() >= GOLDLOG_BATCH)
+                flush(batch);
+        }
+    }
+    if(!batch.empty())
+        flush(batch);
+}
@@ -162,6 +162,7 @@ bool Hooks::execute(const std::string &event, MudObject* target, const std::stri
 
         broadcast(seeHooks, fmt::format("^orunning hook {}: {}^o on {}^o{}: ^x{}", event,
             hookMudObjName(parent), hookMudObjName(target), params, it->second).c_str());
+        gServer->getProfiler().note(fmt::format("hook {} on {}", event, parent ? parent->getName() : "nothing"));
         gServer->runPython(it->second, param1 + "," + param2 + "," + param3, parent, target);
     }
     return(ran);
@@ -188,6 +189,7 @@ bool Hooks::executeWithReturn(const std::string &event, MudObject* target, const
         broadcast(seeHooks, fmt::format("^orunning hook {}: {}^o on {}^o{}: ^x", event,
             hookMudObjName(parent), hookMudObjName(target), params).c_str());
 
+        gServer->getProfiler().note(fmt::format("hook {} on {}", event, parent ? parent->getName() : "nothing"));
         returnValue = gServer->runPythonWithReturn(it->second, param1 + "," + param2 + "," + param3, parent, target);
     }
     return(returnValue);
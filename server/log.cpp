@@ -16,20 +16,307 @@
  *
  */
 
-#include <fcntl.h>    // for open, O_RDWR, O_CREAT
-#include <unistd.h>   // for close, lseek, write
+#include <unistd.h>   // for getpid
+#include <chrono>     // for milliseconds, steady_clock
 #include <cstdarg>    // for va_end, va_list, va_start
-#include <cstdio>     // for sprintf, vsnprintf, fclose, fopen, fprintf, snp...
-#include <cstdlib>    // for free
+#include <cstdio>     // for fopen, fwrite, fclose, fflush, rename
+#include <cstdlib>    // for free, atexit
 #include <cstring>    // for strlen, strcpy
-#include <ctime>      // for ctime, time, time_t
+#include <ctime>      // for ctime, ctime_r, time, strftime, strptime
 #include <iostream>   // for std::clog
+#include <thread>     // for sleep_for
 #include <ostream>    // for operator<<, basic_ostream, char_traits, ostream.
 
-#include "mud.hpp"    // for ACC
+#include "logger.hpp" // for Logger, LogRing
 #include "paths.hpp"  // for Log
 
-// TODO: Rework these to avoid redundant code
+//*********************************************************************
+//                      LogRing
+//*********************************************************************
+
+LogRing::LogRing(size_t size): slots(new Slot[size]), mask(size - 1) {
+    for(size_t i = 0; i < size; i++)
+        slots[i].seq.store(i, std::memory_order_relaxed);
+}
+
+bool LogRing::push(LogLine&& line) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    for(;;) {
+        Slot& slot = slots[pos & mask];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+        if(diff == 0) {
+            // Slot is free; try to claim it
+            if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.line = std::move(line);
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return(true);
+            }
+        } else if(diff < 0) {
+            // The consumer hasn't got to this slot yet: we're full
+            return(false);
+        } else {
+            // Another producer beat us to it
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogRing::pop(LogLine& line) {
+    Slot& slot = slots[tail & mask];
+    size_t seq = slot.seq.load(std::memory_order_acquire);
+    if(static_cast<std::ptrdiff_t>(seq - (tail + 1)) < 0)
+        return(false);
+
+    line = std::move(slot.line);
+    slot.seq.store(tail + mask + 1, std::memory_order_release);
+    tail++;
+    return(true);
+}
+
+//*********************************************************************
+//                      Logger
+//*********************************************************************
+// Never destroyed: forked children would otherwise try to join a writer
+// thread that only exists in the parent.
+
+Logger* Logger::getInstance() {
+    static auto* logger = new Logger();
+    return(logger);
+}
+
+Logger::Logger(): ring(LOG_RING_SIZE), owner(getpid()) {
+}
+
+static void stopLogger() {
+    Logger::getInstance()->stop();
+}
+
+void flushLogs() {
+    Logger::getInstance()->flush();
+}
+
+//*********************************************************************
+//                      write
+//*********************************************************************
+
+void Logger::write(std::string_view file, std::string text) {
+    if(getpid() != owner || stopped) {
+        writeNow(std::string(file), text);
+        return;
+    }
+
+    if(!running) {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        if(!running) {
+            thread = std::thread(&Logger::work, this);
+            running = true;
+            atexit(stopLogger);
+        }
+    }
+
+    LogLine line{std::string(file), std::move(text)};
+    if(!ring.push(std::move(line))) {
+        // Writer can't keep up. Wait for room rather than write the line
+        // ourselves, or it would land ahead of the ones already queued.
+        overflows++;
+        do {
+            if(stopped) {
+                writeNow(line.file, line.text);
+                return;
+            }
+            wake.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(LOG_FULL_WAIT));
+        } while(!ring.push(std::move(line)));
+    }
+
+    // The writer wakes up on its own every so often; only poke it if the ring is filling up
+    if(++queued - written > LOG_RING_SIZE / 2)
+        wake.notify_one();
+}
+
+//*********************************************************************
+//                      flush
+//*********************************************************************
+
+void Logger::flush() {
+    if(!running || getpid() != owner)
+        return;
+
+    unsigned long target = queued;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOG_FLUSH_WAIT);
+    wake.notify_one();
+    while(written < target && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+//*********************************************************************
+//                      stop
+//*********************************************************************
+
+void Logger::stop() {
+    if(!running || getpid() != owner)
+        return;
+
+    stopping = true;
+    wake.notify_one();
+    thread.join();
+
+    // Anything that slipped in while the writer was finishing up; from here
+    // on lines are written as they're logged, and once the ring is empty
+    // that keeps them in order
+    drain();
+    stopped = true;
+    drain();
+    closeIdle(0, true);
+    running = false;
+
+    if(overflows)
+        std::clog << "Logger: " << overflows << " line(s) had to wait because the ring was full.\n";
+}
+
+//*********************************************************************
+//                      work
+//*********************************************************************
+
+void Logger::work() {
+    for(;;) {
+        drain();
+        if(stopping) {
+            drain();
+            closeIdle(0, true);
+            return;
+        }
+        closeIdle(time(nullptr));
+
+        std::unique_lock<std::mutex> guard(wakeLock);
+        wake.wait_for(guard, std::chrono::milliseconds(50));
+    }
+}
+
+void Logger::drain() {
+    LogLine line;
+    unsigned long count = 0;
+    time_t now = time(nullptr);
+
+    while(ring.pop(line)) {
+        writeLine(line, now);
+        count++;
+    }
+    if(!count)
+        return;
+
+    for(auto& [path, file] : files) {
+        if(file.fp)
+            fflush(file.fp);
+    }
+    written += count;
+}
+
+//*********************************************************************
+//                      writeLine
+//*********************************************************************
+
+void Logger::writeLine(const LogLine& line, time_t now) {
+    auto it = files.find(line.file);
+    if(it == files.end()) {
+        LogFile file;
+        if(!open(line.file, file))
+            return;
+        it = files.emplace(line.file, file).first;
+    }
+
+    LogFile& file = it->second;
+    if(file.size >= LOG_ROTATE_SIZE || (file.oldest && now - file.oldest >= LOG_ROTATE_AGE))
+        rotate(line.file, file, now);
+    if(!file.fp)
+        return;
+
+    fwrite(line.text.data(), 1, line.text.length(), file.fp);
+    file.size += line.text.length();
+    if(!file.oldest)
+        file.oldest = now;
+    file.lastUsed = now;
+}
+
+//*********************************************************************
+//                      open
+//*********************************************************************
+
+bool Logger::open(const std::string& path, LogFile& file) {
+    file.fp = fopen(path.c_str(), "a");
+    if(!file.fp) {
+        std::clog << "Unable to open '" << path << "'\n";
+        return(false);
+    }
+    fseek(file.fp, 0, SEEK_END);
+    file.size = ftell(file.fp);
+    file.oldest = 0;
+    file.lastUsed = time(nullptr);
+
+    // Every line starts with the ctime it was logged at, so the first one tells
+    // us how old the file is
+    if(file.size > 0) {
+        FILE* fp = fopen(path.c_str(), "r");
+        char first[32] = {};
+        if(fp && fgets(first, 25, fp)) {
+            struct tm tm{};
+            if(strptime(first, "%a %b %d %H:%M:%S %Y", &tm)) {
+                tm.tm_isdst = -1;
+                file.oldest = mktime(&tm);
+            }
+        }
+        if(fp)
+            fclose(fp);
+    }
+    return(true);
+}
+
+//*********************************************************************
+//                      rotate
+//*********************************************************************
+
+void Logger::rotate(const std::string& path, LogFile& file, time_t now) {
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+
+    if(file.fp)
+        fclose(file.fp);
+    file.fp = nullptr;
+    std::string rotated = path + "." + stamp;
+    if(rename(path.c_str(), rotated.c_str()) != 0)
+        std::clog << "Unable to rotate '" << path << "'\n";
+    open(path, file);
+}
+
+//*********************************************************************
+//                      closeIdle
+//*********************************************************************
+
+void Logger::closeIdle(time_t now, bool all) {
+    for(auto it = files.begin(); it != files.end() ; ) {
+        if(all || now - it->second.lastUsed >= LOG_IDLE) {
+            if(it->second.fp)
+                fclose(it->second.fp);
+            it = files.erase(it);
+        } else
+            it++;
+    }
+}
+
+//*********************************************************************
+//                      writeNow
+//*********************************************************************
+
+void Logger::writeNow(const std::string& path, const std::string& text) {
+    FILE* fp = fopen(path.c_str(), "a");
+    if(fp == nullptr) {
+        std::clog << "Unable to open '" << path << "'\n";
+        return;
+    }
+    fwrite(text.data(), 1, text.length(), fp);
+    fclose(fp);
+}
 
 //*********************************************************************
 //                      getTimeStr
@@ -50,6 +337,33 @@ char *getTimeStr() {
     return(timestr);
 }
 
+//*********************************************************************
+//                      logTo
+//*********************************************************************
+// Timestamps a formatted printf string and queues it for the given log
+
+static void logTo(const std::string& filename, const char *fmt, va_list ap) {
+    char    *str;
+
+    if(vasprintf(&str, fmt, ap) == -1) {
+        std::clog << "Error logging to " << filename << "\n";
+        return;
+    }
+    // ctime_r rather than getTimeStr: this can be called off the main thread
+    char    timestr[32];
+    time_t  t = time(nullptr);
+    ctime_r(&t, timestr);
+    timestr[strlen(timestr)-1] = 0;
+
+    // TODO: put the \n at the end of this
+    std::string text = timestr;
+    text += ": ";
+    text += str;
+    free(str);
+
+    Logger::getInstance()->write(filename, std::move(text));
+}
+
 //**********************************************************************
 //                      logn
 //**********************************************************************
@@ -57,69 +371,25 @@ char *getTimeStr() {
 // "name" in the log directory.
 
 void logn(const char *name, const char *fmt, ...) {
-    char    filename[80];
-    char    *str;
-    FILE    *fp;
     va_list ap;
 
     va_start(ap, fmt);
-
-    sprintf(filename, "%s/%s.txt", Path::Log, name);
-    fp = fopen(filename, "a");
-    
-    if(fp == nullptr) {
-        std::clog << "Unable to open '" << filename << "'\n";
-        return;
-    }
-    if(vasprintf(&str, fmt, ap) == -1) {
-        std::clog << "Error in logn\n";
-        return; 
-    }
+    logTo(std::string(Path::Log) + "/" + name + ".txt", fmt, ap);
     va_end(ap);
-    // TODO: put the \n at the end of this 
-    fprintf(fp, "%s: %s", getTimeStr(), str);
-
-    free(str);  
-    fclose(fp);
 }
 
 //**********************************************************************
 //                      loge
 //**********************************************************************
 // This function writes a formatted printf string to a logfile called
-// "log" in the player directory.
+// "log" in the log directory.
 
 void loge(const char *fmt, ...) {
-    char    file[80];
-    char    str[4048];
-    int     fd;
-    time_t  t;
     va_list ap;
 
     va_start(ap, fmt);
-
-    sprintf(file, "%s/log.txt", Path::Log);
-    fd = open(file, O_RDWR, 0);
-    if(fd < 0) {
-        fd = open(file, O_RDWR | O_CREAT, ACC);
-        if(fd < 0)
-            return;
-    }
-    lseek(fd, 0L, 2);
-    t = time(nullptr);
-    strcpy(str, ctime(&t));
-    str[24] = ':';
-    str[25] = ' ';
-    vsnprintf(str + 26, 2000, fmt, ap);
+    logTo(std::string(Path::Log) + "/log.txt", fmt, ap);
     va_end(ap);
-
-//  vsnprintf(str, 4000, fmt, ap);
-//  va_end(ap);
-//  snprintf(str, 4195, "%s: %s", getTimeStr(), str);
-    write(fd, str, strlen(str));
-
-    close(fd);
-
 }
 
 //**********************************************************************
@@ -128,27 +398,9 @@ void loge(const char *fmt, ...) {
 // Logs stuff in the active log
 
 void loga(const char *fmt,...) {
-    char    file[80];
-    char    str[4048];
-    int     fd;
     va_list ap;
 
     va_start(ap, fmt);
-
-    sprintf(file, "%s/log.active.txt", Path::Log);
-    fd = open(file, O_RDWR, 0);
-    if(fd < 0) {
-        fd = open(file, O_RDWR | O_CREAT, ACC);
-        if(fd < 0)
-            return;
-    }
-    lseek(fd, 0L, 2);
-    
-    vsnprintf(str, 4000, fmt, ap);
+    logTo(std::string(Path::Log) + "/log.active.txt", fmt, ap);
     va_end(ap);
-    snprintf(str, 4045, "%s: %s", getTimeStr(), str);
-
-    write(fd, str, strlen(str));
-
-    close(fd);
 }
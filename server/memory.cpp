@@ -32,10 +32,12 @@
 #include "mudObjects/objects.hpp"      // for Object
 #include "mudObjects/players.hpp"      // for Player
 #include "mudObjects/uniqueRooms.hpp"  // for UniqueRoom
+#include "pool.hpp"                    // for TypePool, PoolStats
 #include "proto.hpp"                   // for loge
 #include "server.hpp"                  // for Server, gServer, RoomCache
 #include "socket.hpp"                  // for Socket
 #include "structs.hpp"                 // for ttag
+#include "webNotifier.hpp"             // for WebNotifier
 
 //*********************************************************************
 //                      sizeInfo
@@ -164,6 +166,20 @@ void Server::showMemory(Socket* sock, bool extended) {
     sock->print("Room: %s\n", gServer->roomCache.get_stat_info(extended).c_str());
     sock->print("Monster: %s\n", gServer->monsterCache.get_stat_info(extended).c_str());
     sock->print("Object: %s\n", gServer->objectCache.get_stat_info(extended).c_str());
+
+    sock->print("\n");
+    sock->print("Pools:\n");
+    for(const PoolStats& stats : TypePool::getAllStats()) {
+        sock->print("%-11s live: %-8lu peak: %-8lu allocs: %-10lu held: %s%s\n", stats.name,
+            stats.live, stats.peak, stats.allocs, sizeInfo((long)stats.reserved).c_str(),
+            stats.systemAlloc ? " (system allocator)" : "");
+    }
+
+    if(webNotifier) {
+        sock->print("\n");
+        sock->print("Webserver Notifications:\n");
+        sock->print("%s", webNotifier->getStatsString().c_str());
+    }
 }
 
 //*********************************************************************
@@ -18,6 +18,7 @@
 
 #include <arpa/telnet.h>               // for IAC, SB, SE
 #include <cmath>                       // for floor, round
+#include <ctime>                       // for time
 #include <functional>                  // for function, operator==
 #include <list>                        // for operator==, list, _List_const_...
 #include <map>                         // for operator==, map, _Rb_tree_iter...
@@ -48,24 +49,70 @@
 
 #define MSDP_DEBUG
 
+void debugMsdp(std::string_view str);
+
 void Server::processMsdp() {
+    time_t now = time(nullptr);
     for(auto &sock : sockets) {
         if(sock.getState() == CON_DISCONNECTING)
             continue;
 
-        if(sock.mccpEnabled()) {
-            for(auto& [vName, var] : sock.msdpReporting) {
-                if(var.getRequiresPlayer() && (!sock.getPlayer() || sock.getState() != CON_PLAYING)) continue;
-                if(!var.checkTimer()) continue;
-
-                var.update();
-                if(!var.isDirty()) continue;
+        if(sock.mccpEnabled())
+            sock.msdpSendChanges(now);
+    }
+}
 
-                var.send(sock);
-                var.setDirty(false);
-            }
+static std::string msdpPair(std::string_view variable, std::string_view value) {
+    std::ostringstream oStr;
+    oStr    << (unsigned char) IAC << (unsigned char) SB << (unsigned char) TELOPT_MSDP
+            << (unsigned char) MSDP_VAR << variable
+            << (unsigned char) MSDP_VAL << value
+            << (unsigned char) IAC << (unsigned char) SE;
+    return(oStr.str());
+}
+
+//*********************************************************************
+//                      msdpSendChanges
+//*********************************************************************
+// Sends every reported variable whose value changed, all in one write.
+// Watched variables are only worked out again once something they're
+// worked out from has changed; the rest are polled on their timers.
+
+void Socket::msdpSendChanges(time_t now) {
+    Player* player = getPlayer();
+    std::string batch;
+
+    for(auto& [vName, var] : msdpReporting) {
+        if(var.getRequiresPlayer() && (!player || getState() != CON_PLAYING)) continue;
+        msdpStats.checked++;
+        if(!var.isStale(player, now)) continue;
+        if(!var.checkTimer()) continue;
+
+        msdpStats.computed++;
+        var.update();
+        var.markSeen(player, now);
+        if(!var.isDirty()) continue;
+
+        // The same pair msdpSendPair would have sent on its own
+        std::string value = var.getValue();
+        if(!value.empty() && msdpEnabled()) {
+            batch += msdpPair(var.getName(), value);
+            msdpStats.sent++;
         }
+        var.setDirty(false);
     }
+
+    if(batch.empty())
+        return;
+#ifdef MSDP_DEBUG
+    debugMsdp(batch);
+#endif
+    msdpStats.bytes += batch.size();
+    write(batch);
+}
+
+const Socket::MsdpStats& Socket::getMsdpStats() const {
+    return(msdpStats);
 }
 
 bool Socket::processMsdpVarVal(const std::string &variable, const std::string &value) {
@@ -341,17 +388,12 @@ bool Socket::msdpSendPair(std::string_view variable, std::string_view value) {
     if (variable.empty() || value.empty())
         return false;
 
-    std::ostringstream oStr;
+    std::string toSend;
 
     if (this->msdpEnabled()) {
         std::clog << "SendPair:MSDP" << std::endl;
-        oStr
-                << (unsigned char) IAC << (unsigned char) SB << (unsigned char) TELOPT_MSDP
-                << (unsigned char) MSDP_VAR << variable
-                << (unsigned char) MSDP_VAL << value
-                << (unsigned char) IAC << (unsigned char) SE;
+        toSend = msdpPair(variable, value);
     }
-    std::string toSend = oStr.str();
 
 #ifdef MSDP_DEBUG
     debugMsdp(toSend);
@@ -378,6 +420,8 @@ ReportedMsdpVariable::ReportedMsdpVariable(const MsdpVariable* mv, Socket* sock)
     updateable = mv->updateable;
     updateInterval = mv->getUpdateInterval();
     reportable = mv->isReportable();
+    watches = mv->watches;
+    targetWatches = mv->targetWatches;
     timer.setDelay(updateInterval);
 
     dirty = true;
@@ -408,6 +452,10 @@ int MsdpVariable::getUpdateInterval() const {
     return(updateInterval);
 }
 
+bool MsdpVariable::isWatched() const {
+    return(watches || targetWatches);
+}
+
 bool MsdpVariable::hasValueFn() const {
     return(valueFn != nullptr);
 }
@@ -482,6 +530,29 @@ void ReportedMsdpVariable::setDirty(bool pDirty) {
     dirty = pDirty;
 }
 
+unsigned long ReportedMsdpVariable::countChanges(const Player* player) const {
+    if(!player)
+        return(0);
+    unsigned long count = player->getChanges(watches);
+    if(targetWatches && player->myTarget)
+        count += player->myTarget->getChanges(targetWatches);
+    return(count);
+}
+
+bool ReportedMsdpVariable::isStale(const Player* player, time_t now) const {
+    if(!isWatched() || !seenAt || now - seenAt >= MSDP_REFRESH)
+        return(true);
+    const Creature* target = player ? player->myTarget : nullptr;
+    return(player != seenPlayer || target != seenTarget || countChanges(player) != seenChanges);
+}
+
+void ReportedMsdpVariable::markSeen(const Player* player, time_t now) {
+    seenPlayer = player;
+    seenTarget = player ? player->myTarget : nullptr;
+    seenChanges = countChanges(player);
+    seenAt = now;
+}
+
 std::string BaseRoom::getExitsMsdp() const {
     std::ostringstream oStr;
 
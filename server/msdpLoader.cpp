@@ -20,6 +20,7 @@
 #include <utility>                   // for move
 
 #include "builders/msdpBuilder.hpp"  // for MsdpBuilder
+#include "changeWatch.hpp"           // for CHANGE_MASK, StateChange
 #include "config.hpp"                // for Config, MsdpVariableMap
 #include "msdp.hpp"                  // for MsdpVariable, getArmor, getArmor...
 
@@ -43,54 +44,67 @@ bool Config::initMsdp() {
     addToSet(MsdpBuilder().name("HEALTH").valueFn(msdp::getHealth)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_HEALTH))
       , msdpVariables);
     addToSet(MsdpBuilder().name("HEALTH_MAX").valueFn(msdp::getHealthMax)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_HEALTH))
       , msdpVariables);
     addToSet(MsdpBuilder().name("MANA").valueFn(msdp::getMana)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_MANA))
       , msdpVariables);
     addToSet(MsdpBuilder().name("MANA_MAX").valueFn(msdp::getManaMax)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_MANA))
       , msdpVariables);
     addToSet(MsdpBuilder().name("EXPERIENCE").valueFn(msdp::getExperience)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_EXPERIENCE))
       , msdpVariables);
     addToSet(MsdpBuilder().name("EXPERIENCE_MAX").valueFn(msdp::getExperienceMax)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_EXPERIENCE))
       , msdpVariables);
     addToSet(MsdpBuilder().name("EXPERIENCE_TNL").valueFn(msdp::getExperienceTNL)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_EXPERIENCE))
       , msdpVariables);
     addToSet(MsdpBuilder().name("EXPERIENCE_TNL_MAX").valueFn(msdp::getExperienceTNLMax)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_EXPERIENCE))
       , msdpVariables);
     addToSet(MsdpBuilder().name("WIMPY").valueFn(msdp::getWimpy)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_WIMPY))
       , msdpVariables);
     addToSet(MsdpBuilder().name("MONEY").valueFn(msdp::getMoney)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_MONEY))
       , msdpVariables);
     addToSet(MsdpBuilder().name("BANK").valueFn(msdp::getBank)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_BANK))
       , msdpVariables);
     addToSet(MsdpBuilder().name("ARMOR").valueFn(msdp::getArmor)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_ARMOR))
       , msdpVariables);
     addToSet(MsdpBuilder().name("ARMOR_ABSORB").valueFn(msdp::getArmorAbsorb)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_ARMOR))
       , msdpVariables);
     addToSet(MsdpBuilder().name("GROUP").valueFn(msdp::getGroup)
         .reportable(true).requiresPlayer(true).configurable(false)
@@ -99,26 +113,32 @@ bool Config::initMsdp() {
     addToSet(MsdpBuilder().name("TARGET").valueFn(msdp::getTarget)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_TARGET))
       , msdpVariables);
     addToSet(MsdpBuilder().name("TARGET_ID").valueFn(msdp::getTargetID)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_TARGET))
       , msdpVariables);
     addToSet(MsdpBuilder().name("TARGET_HEALTH").valueFn(msdp::getTargetHealth)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_TARGET)).targetWatches(CHANGE_MASK(CHANGE_HEALTH))
       , msdpVariables);
     addToSet(MsdpBuilder().name("TARGET_HEALTH_MAX").valueFn(msdp::getTargetHealthMax)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_TARGET))
       , msdpVariables);
     addToSet(MsdpBuilder().name("TARGET_STRENGTH").valueFn(msdp::getTargetStrength)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(10).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_TARGET))
       , msdpVariables);
     addToSet(MsdpBuilder().name("ROOM").valueFn(msdp::getRoom)
         .reportable(true).requiresPlayer(true).configurable(false)
         .writeOnce(false).updateInterval(5).updateable(true).isGroup(false)
+        .watches(CHANGE_MASK(CHANGE_ROOM))
       , msdpVariables);
     addToSet(MsdpBuilder().name("CLIENT_ID")
         .reportable(true).requiresPlayer(false).configurable(true)
@@ -43,6 +43,11 @@ void MudObject::setName(std::string_view newName) {
     addToSet();
 }
 
+void MudObject::keysChanged() {
+    removeFromSet();
+    addToSet();
+}
+
 const std::string & MudObject::getName() const {
     return(name);
 }
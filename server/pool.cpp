@@ -0,0 +1,137 @@
+/*
+ * pool.cpp
+ *   Fixed size allocation for the types the game makes and throws away most
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <algorithm>        // for max
+#include <mutex>            // for mutex, lock_guard
+#include <new>              // for operator new, operator delete
+
+#include "pool.hpp"         // for TypePool, PoolStats
+
+#ifdef POOL_SYSTEM_ALLOC
+static bool systemAllocDefault = true;
+#else
+static bool systemAllocDefault = false;
+#endif
+
+// Every pool there is, for showMemory
+static std::mutex poolsLock;
+static std::vector<TypePool*>& getPools() {
+    static auto* pools = new std::vector<TypePool*>();
+    return(*pools);
+}
+
+//*********************************************************************
+//                      getPool
+//*********************************************************************
+
+TypePool* TypePool::getPool(const char* pName, size_t pSize) {
+    std::lock_guard<std::mutex> guard(poolsLock);
+    auto* pool = new TypePool(pName, pSize);
+    getPools().push_back(pool);
+    return(pool);
+}
+
+TypePool::TypePool(const char* pName, size_t pSize): name(pName), objectSize(pSize), systemAlloc(systemAllocDefault) {
+    // Big enough to hold the free list link, and keeps every block aligned
+    // the way operator new would
+    size_t align = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    blockSize = (std::max(pSize, sizeof(void*)) + align - 1) / align * align;
+}
+
+//*********************************************************************
+//                      setSystemAlloc
+//*********************************************************************
+
+void TypePool::setSystemAlloc(bool system) {
+    std::lock_guard<std::mutex> guard(poolsLock);
+    systemAllocDefault = system;
+}
+
+bool TypePool::getSystemAlloc() {
+    std::lock_guard<std::mutex> guard(poolsLock);
+    return(systemAllocDefault);
+}
+
+//*********************************************************************
+//                      allocate
+//*********************************************************************
+
+void* TypePool::allocate(size_t size) {
+    if(size != objectSize)
+        return(::operator new(size));
+
+    void* ptr;
+    if(systemAlloc) {
+        ptr = ::operator new(size);
+    } else {
+        if(!freeList) {
+            size_t perChunk = std::max<size_t>(1, POOL_CHUNK_BYTES / blockSize);
+            char* chunk = static_cast<char*>(::operator new(perChunk * blockSize));
+            chunks.push_back(chunk);
+            for(size_t i = perChunk; i-- > 0; ) {
+                void* block = chunk + i * blockSize;
+                *static_cast<void**>(block) = freeList;
+                freeList = block;
+            }
+        }
+        ptr = freeList;
+        freeList = *static_cast<void**>(ptr);
+    }
+    allocs++;
+    if(++live > peak)
+        peak = live;
+    return(ptr);
+}
+
+//*********************************************************************
+//                      deallocate
+//*********************************************************************
+
+void TypePool::deallocate(void* ptr, size_t size) {
+    if(!ptr)
+        return;
+    if(size != objectSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    live--;
+    if(systemAlloc) {
+        ::operator delete(ptr);
+    } else {
+        *static_cast<void**>(ptr) = freeList;
+        freeList = ptr;
+    }
+}
+
+//*********************************************************************
+//                      getStats
+//*********************************************************************
+
+PoolStats TypePool::getStats() {
+    size_t perChunk = std::max<size_t>(1, POOL_CHUNK_BYTES / blockSize);
+    return(PoolStats{name, blockSize, live, peak, allocs, chunks.size() * perChunk * blockSize, systemAlloc});
+}
+
+std::vector<PoolStats> TypePool::getAllStats() {
+    std::vector<PoolStats> stats;
+    std::lock_guard<std::mutex> guard(poolsLock);
+    for(TypePool* pool : getPools())
+        stats.push_back(pool->getStats());
+    return(stats);
+}
@@ -0,0 +1,272 @@
+/*
+ * profiler.cpp
+ *   Per-phase timing of the main loop
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <fmt/format.h>     // for format
+#include <algorithm>        // for sort, min
+#include <bit>              // for bit_width
+#include <ctime>            // for time, localtime, strftime
+#include <fstream>          // for ofstream
+#include <numeric>          // for iota
+
+#include "profiler.hpp"     // for Profiler, ProfileScope
+
+//*********************************************************************
+//                      Histogram
+//*********************************************************************
+
+void Profiler::Histogram::add(long micros) {
+    micros = std::max(0L, micros);
+    size_t bucket = std::min<size_t>(std::bit_width(static_cast<unsigned long>(micros)), PROFILE_BUCKETS - 1);
+    buckets[bucket]++;
+    count++;
+    total += micros;
+    max = std::max(max, micros);
+}
+
+void Profiler::Histogram::merge(const Histogram& other) {
+    for(size_t i = 0; i < PROFILE_BUCKETS; i++)
+        buckets[i] += other.buckets[i];
+    count += other.count;
+    total += other.total;
+    max = std::max(max, other.max);
+}
+
+// Upper edge of the bucket the percentile falls in, so at most twice the real figure
+long Profiler::Histogram::percentile(int pct) const {
+    if(!count)
+        return(0);
+    unsigned long want = (count * pct + 99) / 100, seen = 0;
+    for(size_t i = 0; i < PROFILE_BUCKETS; i++) {
+        seen += buckets[i];
+        if(seen >= want)
+            return(std::min(1L << i, max));
+    }
+    return(max);
+}
+
+//*********************************************************************
+//                      Profiler
+//*********************************************************************
+
+Profiler::Profiler() {
+    reset();
+}
+
+void Profiler::reset() {
+    epoch = frameStart = Clock::now();
+    windowStart = time(nullptr);
+    current = {};
+    previous = {};
+    framePhases = {};
+    frameNotes.clear();
+    frameSpans.clear();
+    slowFrames.clear();
+    trace.clear();
+}
+
+long Profiler::sinceEpoch(Clock::time_point point) const {
+    return(std::chrono::duration_cast<std::chrono::microseconds>(point - epoch).count());
+}
+
+const char* Profiler::getPhaseName(ProfilePhase phase) {
+    switch(phase) {
+        case PROF_FRAME:        return("frame");
+        case PROF_CHILDREN:     return("children");
+        case PROF_POLL:         return("poll");
+        case PROF_DNS:          return("dns");
+        case PROF_ASYNC:        return("async");
+        case PROF_MAILBOX:      return("mailbox");
+        case PROF_CHECK_NEW:    return("checkNew");
+        case PROF_INPUT:        return("processInput");
+        case PROF_COMMANDS:     return("processCommands");
+        case PROF_COMBAT:       return("playerCombat");
+        case PROF_GAME:         return("updateGame");
+        case PROF_GAME_SECOND:  return("second");
+        case PROF_GAME_TICKS:   return("pulseTicks");
+        case PROF_GAME_EFFECTS: return("pulseEffects");
+        case PROF_GAME_RANDOM:  return("updateRandom");
+        case PROF_GAME_ACTIVE:  return("updateActive");
+        case PROF_GAME_SHIPS:   return("updateShips");
+        case PROF_MSDP:         return("processMsdp");
+        case PROF_OUTPUT:       return("processOutput");
+        case PROF_CLEANUP:      return("cleanUp");
+        case PROF_WEB:          return("webInterface");
+        default:                return("unknown");
+    }
+}
+
+//*********************************************************************
+//                      startFrame
+//*********************************************************************
+
+void Profiler::startFrame() {
+    frameStart = Clock::now();
+    framePhases = {};
+    frameNotes.clear();
+
+    // Reuse the oldest frame's storage once the trace is full
+    if(trace.size() >= PROFILE_TRACE_FRAMES) {
+        frameSpans.swap(trace.front());
+        trace.pop_front();
+    }
+    frameSpans.clear();
+}
+
+//*********************************************************************
+//                      endFrame
+//*********************************************************************
+
+void Profiler::endFrame(long slowAfter) {
+    Clock::time_point now = Clock::now();
+    record(PROF_FRAME, frameStart, now);
+    trace.push_back(std::move(frameSpans));
+    frameSpans = std::vector<Span>();
+
+    long length = framePhases[PROF_FRAME];
+    if(length > slowAfter) {
+        if(slowFrames.size() >= PROFILE_SLOW_FRAMES)
+            slowFrames.pop_front();
+        slowFrames.push_back({time(nullptr), length, framePhases, std::move(frameNotes)});
+        frameNotes = std::vector<std::string>();
+    }
+
+    time_t t = time(nullptr);
+    if(t - windowStart >= PROFILE_WINDOW) {
+        previous = current;
+        current = {};
+        windowStart = t;
+    }
+}
+
+//*********************************************************************
+//                      record
+//*********************************************************************
+
+void Profiler::record(ProfilePhase phase, Clock::time_point start, Clock::time_point end) {
+    long micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    current[phase].add(micros);
+    framePhases[phase] += micros;
+    frameSpans.push_back({phase, sinceEpoch(start), micros});
+}
+
+//*********************************************************************
+//                      note
+//*********************************************************************
+
+void Profiler::note(std::string text) {
+    if(frameNotes.size() < PROFILE_FRAME_NOTES)
+        frameNotes.push_back(std::move(text));
+}
+
+//*********************************************************************
+//                      getReport
+//*********************************************************************
+
+std::string Profiler::getReport() const {
+    std::array<Histogram, PROF_PHASE_COUNT> merged = previous;
+    for(size_t i = 0; i < PROF_PHASE_COUNT; i++)
+        merged[i].merge(current[i]);
+
+    long frameTotal = std::max(1L, merged[PROF_FRAME].total);
+    long seconds = time(nullptr) - windowStart + (previous[PROF_FRAME].count ? PROFILE_WINDOW : 0);
+    std::string report = fmt::format("Frame phases over the last {} seconds (times in microseconds):\n", seconds);
+    report += fmt::format("{:<18} {:>9} {:>9} {:>9} {:>9} {:>9} {:>7}\n", "Phase", "Calls", "Avg", "p50", "p99", "Max", "Share");
+    for(size_t i = 0; i < PROF_PHASE_COUNT; i++) {
+        const Histogram& hist = merged[i];
+        if(!hist.count)
+            continue;
+        // updateGame's sub-steps are indented under it
+        std::string name = getPhaseName(static_cast<ProfilePhase>(i));
+        if(i >= PROF_GAME_SECOND && i <= PROF_GAME_SHIPS)
+            name = "  " + name;
+        report += fmt::format("{:<18} {:>9} {:>9} {:>9} {:>9} {:>9} {:>6.1f}%\n",
+            name, hist.count, hist.total / (long)hist.count,
+            hist.percentile(50), hist.percentile(99), hist.max, hist.total * 100.0 / frameTotal);
+    }
+    report += fmt::format("{} slow frame{} kept.\n", slowFrames.size(), slowFrames.size() == 1 ? "" : "s");
+    return(report);
+}
+
+//*********************************************************************
+//                      getSlowFrames
+//*********************************************************************
+
+std::string Profiler::getSlowFrames() const {
+    if(slowFrames.empty())
+        return("No slow frames.\n");
+
+    std::string report;
+    char timeStr[32];
+    for(const SlowFrame& frame : slowFrames) {
+        strftime(timeStr, sizeof(timeStr), "%H:%M:%S", localtime(&frame.when));
+
+        // Biggest three phases, not counting the frame itself or updateGame's total
+        std::array<int, PROF_PHASE_COUNT> order{};
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&frame](int a, int b) { return(frame.phases[a] > frame.phases[b]); });
+
+        report += fmt::format("{}  {:.1f}ms:", timeStr, frame.length / 1000.0);
+        int shown = 0;
+        for(int phase : order) {
+            if(phase == PROF_FRAME || phase == PROF_GAME || !frame.phases[phase])
+                continue;
+            report += fmt::format(" {} {:.1f}ms", getPhaseName(static_cast<ProfilePhase>(phase)), frame.phases[phase] / 1000.0);
+            if(++shown == 3)
+                break;
+        }
+        report += "\n";
+        for(const std::string& text : frame.notes)
+            report += "    " + text + "\n";
+    }
+    return(report);
+}
+
+//*********************************************************************
+//                      writeTrace
+//*********************************************************************
+// Chrome trace event format: one complete ("X") event per phase per frame
+
+bool Profiler::writeTrace(const std::string& filename) const {
+    std::ofstream out(filename);
+    if(!out)
+        return(false);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for(const std::vector<Span>& frame : trace) {
+        for(const Span& span : frame) {
+            out << (first ? "\n" : ",\n")
+                << fmt::format(R"({{"name":"{}","ph":"X","pid":1,"tid":1,"ts":{},"dur":{}}})",
+                    getPhaseName(span.phase), span.start, span.length);
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return(out.good());
+}
+
+//*********************************************************************
+//                      ProfileScope
+//*********************************************************************
+
+ProfileScope::ProfileScope(Profiler& pProfiler, ProfilePhase pPhase): profiler(pProfiler), phase(pPhase), start(Profiler::Clock::now()) {
+}
+
+ProfileScope::~ProfileScope() {
+    profiler.record(phase, start, Profiler::Clock::now());
+}
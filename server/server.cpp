@@ -28,9 +28,9 @@
 #include <sys/socket.h>                             // for AF_INET, accept
 #include <sys/stat.h>                               // for umask
 #include <sys/time.h>                               // for timeval
-#include <sys/wait.h>                               // for wait3, waitpid
+#include <sys/wait.h>                               // for waitpid, WNOHANG
 #include <unistd.h>                                 // for close, unlink, read
-#include <algorithm>                                // for find
+#include <algorithm>                                // for find, clamp
 #include <boost/algorithm/string/replace.hpp>       // for replace_all
 #include <boost/iterator/iterator_traits.hpp>       // for iterator_value<>:...
 #include <boost/lexical_cast/bad_lexical_cast.hpp>  // for bad_lexical_cast
@@ -57,10 +57,12 @@
 #include "color.hpp"                                // for stripColor
 #include "config.hpp"                               // for Config, gConfig
 #include "delayedAction.hpp"                        // for DelayedAction
+#include "dnsResolver.hpp"                          // for DnsResolver
 #include "factions.hpp"                             // for Faction
 #include "flags.hpp"                                // for M_PERMENANT_MONSTER
 #include "free_crt.hpp"                             // for free_crt
 #include "global.hpp"                               // for FATAL, ALLITEMS
+#include "goldLog.hpp"                              // for GoldLogWriter, GoldEvent
 #include "lasttime.hpp"                             // for lasttime
 #include "login.hpp"                                // for CON_DISCONNECTING
 #include "magic.hpp"                                // for S_CURE_POISON
@@ -87,6 +89,7 @@
 #include "stats.hpp"                                // for Stat
 #include "structs.hpp"                              // for daily
 #include "version.hpp"                              // for VERSION
+#include "webNotifier.hpp"                          // for WebNotifier
 #include "wanderInfo.hpp"                           // for WanderInfo
 #include "xml.hpp"                                  // for copyToNum, newNum...
 
@@ -153,16 +156,12 @@ Server::Server(): roomCache(RQMAX, true), monsterCache(MQMAX, false), objectCach
     running = false;
     pulse = 0;
     webInterface = nullptr;
-    lastDnsPrune = lastUserUpdate = lastRoomPulseUpdate = lastRandomUpdate = lastActiveUpdate = 0;
+    lastUserUpdate = lastRandomUpdate = lastActiveUpdate = 0;
     maxPlayerId = maxObjectId = maxMonsterId = 0;
     loadDnsCache();
     pythonHandler = nullptr;
     idDirty = false;
 
-#ifdef SQL_LOGGER
-    connActive = false;
-#endif // SQL_LOGGER
-
 }
 
 //********************************************************************
@@ -184,11 +183,12 @@ Server::~Server() {
     cleanupDiscordBot();
 
     clearAreas();
-    delete vSockets;
-
-#ifdef SQL_LOGGER
-    cleanUpSql();
-#endif // SQL_LOGGER
+    clearEffectQueue();
+    delete resolver;
+    delete asyncPool;
+    delete compressPool;
+    delete webNotifier;
+    stopGoldLog();
 
 }
 
@@ -254,13 +254,7 @@ bool Server::init() {
 
 
 
-#ifdef SQL_LOGGER
-    std::clog <<  "Initializing SQL Logger...";
-    if(initSql())
-        std::clog << "done." << std::endl;
-    else
-        std::clog << "failed." << std::endl;
-#endif // SQL_LOGGER
+    initGoldLog();
 
     umask(000);
     srand(getpid() + time(nullptr));
@@ -295,8 +289,6 @@ void Server::installSignalHandlers() {
     }
     signal(SIGPIPE, SIG_IGN);
     std::clog << ".";
-    signal(SIGCHLD, SIG_IGN);
-    std::clog << ".";
 
     struct sigaction shutdown_sa{};
     shutdown_sa.sa_handler = shutdown_now;
@@ -314,6 +306,7 @@ void Server::setRebooting() { rebooting = true; }
 void Server::setValgrind() { valgrind = true; }
 bool Server::isRebooting() { return(rebooting); }
 bool Server::isValgrind() { return(valgrind); }
+bool Server::isRunning() const { return(running); }
 size_t Server::getNumSockets() const { return(sockets.size()); }
 
 // End - Constructors, Destructors, etc
@@ -344,13 +337,13 @@ void Server::destroyInstance() {
 
 
 
+// Sockets that connect during the frame wait for the next one. Each frame
+// starts one socket further along, so nobody is always first.
 void Server::populateVSockets() {
-    if(vSockets)
+    if(vSocketsReady)
         return;
-    vSockets = new SocketVector();
-    for(auto &sock : sockets) vSockets->push_back(&sock);
-
-    Random::shuffle(vSockets->begin(), vSockets->end());
+    sockets.getRotated(vSockets);
+    vSocketsReady = true;
 }
 
 
@@ -359,51 +352,61 @@ void Server::populateVSockets() {
 //********************************************************************
 
 int Server::run() {
-    ServerTimer timer{};
     if(!running) {
         std::cerr << "Not bound to any ports, exiting." << std::endl;
         exit(-1);
     }
 
-    while(running) {
-        if(!children.empty()) reapChildren();
-
-        processChildren();
-        timer.start(); // Start the timer
-
-        populateVSockets();
-
-        poll();
+    while(running)
+        runOnce();
 
-        checkNew();
-
-        processInput();
+    return(0);
+}
 
-        processCommands();
+//********************************************************************
+//                      runOnce
+//********************************************************************
+// One frame of the main loop, sleeping off whatever's left of it
 
-        updatePlayerCombat();
+void Server::runOnce() {
+    timer.start(); // Start the timer
+    profiler.startFrame();
 
-        // Update game here
-        updateGame();
+    {
+        ProfileScope scope(profiler, PROF_CHILDREN);
+        if(!children.empty() || !unreaped.empty()) reapChildren();
+        processChildren();
+    }
 
-        processMsdp();
+    populateVSockets();
 
-        processOutput();
+    { ProfileScope scope(profiler, PROF_POLL); poll(); }
+    { ProfileScope scope(profiler, PROF_DNS); processDns(); }
+    { ProfileScope scope(profiler, PROF_ASYNC); processAsync(); }
+    { ProfileScope scope(profiler, PROF_MAILBOX); processMailbox(); }
+    { ProfileScope scope(profiler, PROF_CHECK_NEW); checkNew(); }
+    { ProfileScope scope(profiler, PROF_INPUT); processInput(); }
+    { ProfileScope scope(profiler, PROF_COMMANDS); processCommands(); }
+    { ProfileScope scope(profiler, PROF_COMBAT); updatePlayerCombat(); }
 
-        cleanUp();
-        // Temp
-        pulse++;
+    // Update game here
+    { ProfileScope scope(profiler, PROF_GAME); updateGame(); }
 
-        checkWebInterface();
+    { ProfileScope scope(profiler, PROF_MSDP); processMsdp(); }
+    { ProfileScope scope(profiler, PROF_OUTPUT); processOutput(); }
+    { ProfileScope scope(profiler, PROF_CLEANUP); cleanUp(); }
+    // Temp
+    pulse++;
 
-        delete vSockets;
-        vSockets = nullptr;
+    { ProfileScope scope(profiler, PROF_WEB); checkWebInterface(); }
 
-        timer.end(); // End the timer
-        timer.sleep();
-    }
+    vSockets.clear();
+    vSocketsReady = false;
 
-    return(0);
+    timer.end(); // End the timer
+    long frameLength = 1000000 / std::clamp(gConfig->getTickRate(), 1, TICK_SLOTS);
+    profiler.endFrame(frameLength);
+    timer.sleep(frameLength);
 }
 
 //********************************************************************
@@ -489,6 +492,18 @@ int Server::poll() {
         FD_SET(sock.getFd(), &excSet);
     }
 
+    if(resolver && resolver->getFd() != -1) {
+        if(resolver->getFd() > maxFd)
+            maxFd = resolver->getFd();
+        FD_SET(resolver->getFd(), &inSet);
+    }
+
+    if(asyncPool && asyncPool->getFd() != -1) {
+        if(asyncPool->getFd() > maxFd)
+            maxFd = asyncPool->getFd();
+        FD_SET(asyncPool->getFd(), &inSet);
+    }
+
     if(select(maxFd+1, &inSet, &outSet, &excSet, &noTime) < 0)
         return(-1);
 
@@ -572,15 +587,33 @@ int Server::processInput() {
 //                      processCommands
 //********************************************************************
 
+// Runs queued commands round-robin: every socket gets one command per pass
+// (vSockets starts one further along every tick, so nobody is always first)
+// until no one has both a command waiting and budget left for this tick.
+
 int Server::processCommands() {
-    for(Socket *sock : *vSockets) {
-        if(sock != nullptr && sock->hasCommand() && sock->getState() != CON_DISCONNECTING) {
+    for(Socket *sock : vSockets) {
+        if(sock == nullptr)
+            continue;
+        bool staff = sock->hasPlayer() && sock->getPlayer()->isStaff();
+        sock->refillCommandTokens(gConfig->getCommandRate(staff), gConfig->getCommandBurst(staff));
+    }
+
+    bool ran;
+    do {
+        ran = false;
+        for(Socket *sock : vSockets) {
+            if(sock == nullptr || !sock->hasCommand() || sock->getState() == CON_DISCONNECTING)
+                continue;
+            if(!sock->takeCommandToken())
+                continue;
+            ran = true;
             if(sock->processOneCommand() == -1) {
                 sock->setState(CON_DISCONNECTING);
                 continue;
             }
         }
-    }
+    } while(ran);
     return(0);
 }
 
@@ -589,7 +622,7 @@ int Server::processCommands() {
 //********************************************************************
 
 int Server::updatePlayerCombat() {
-    for(Socket * sock : *vSockets) {
+    for(Socket * sock : vSockets) {
         Player* player=sock->getPlayer();
         if(player) {
             if(player->isFleeing() && player->canFlee(false)) {
@@ -613,7 +646,9 @@ int Server::updatePlayerCombat() {
 int Server::processOutput() {
     // This can be called outside of the normal server loop so verify VSockets is populated
     populateVSockets();
-    for(Socket * sock : *vSockets) {
+    time_t t = time(nullptr);
+    for(Socket * sock : vSockets) {
+        sock->checkCompress(t);
         if(FD_ISSET(sock->getFd(), &outSet) && sock->hasOutput()) {
             sock->flush();
         }
@@ -649,6 +684,9 @@ bool isDisconnecting(Socket &sock) {
 
 int Server::cleanUp() {
     sockets.remove_if(isDisconnecting);
+    // Some of this frame's sockets may be gone now
+    vSockets.clear();
+    vSocketsReady = false;
     return(0);
 }
 
@@ -665,64 +703,52 @@ std::string Server::getDnsCacheString() {
     dnsStr << "---------------------------------------------------------------\n";
 
     dnsStr.setf(std::ios::left, std::ios::adjustfield);
-    for(dnsCache & dns : cachedDns) {
+    for(const auto& [ip, dns] : cachedDns) {
         dnsStr << "^c" << std::setw(16) << dns.ip << " | ^C" << dns.hostName << "\n";
         num++;
     }
 
-    dnsStr << "\n\n^x Found " << num << " cached item(s).\n";
+    dnsStr << "\n\n^x Found " << num << " cached item(s)";
+    if(resolver)
+        dnsStr << ", " << resolver->inFlight() << " lookup(s) in flight";
+    dnsStr << ".\n";
     return(dnsStr.str());
 }
 
 //********************************************************************
 //                      getDnsCache
 //********************************************************************
+// Entries older than DNS_CACHE_TTL are dropped when looked up, and skipped
+// when the cache is saved or loaded.
 
 bool Server::getDnsCache(std::string &ip, std::string &hostName) {
-    for(dnsCache & dns : cachedDns) {
-        if(dns.ip == ip) {
-            // Got a match
-            hostName = dns.hostName;
-            std::clog << "DNS: Found " << ip << " in dns cache\n";
-            return(true);
-        }
-    }
-    return(false);
-}
-
-//********************************************************************
-//                      pruneDns
-//********************************************************************
-
-void Server::pruneDns() {
-    long fifteenDays = 60*60*24*15;
-    long currentTime = time(nullptr);
-    std::list<dnsCache>::iterator it;
-    std::list<dnsCache>::iterator oldIt;
+    auto it = cachedDns.find(ip);
+    if(it == cachedDns.end())
+        return(false);
 
-    std::clog << "Pruning DNS\n";
-    for( it = cachedDns.begin(); it != cachedDns.end() ; ) {
-        oldIt = it++;
-        if(currentTime - (*oldIt).time >= fifteenDays) {
-            cachedDns.erase(oldIt);
-        }
+    if(time(nullptr) - it->second.time >= DNS_CACHE_TTL) {
+        cachedDns.erase(it);
+        return(false);
     }
-    saveDnsCache();
-    lastDnsPrune = currentTime;
+
+    // Got a match
+    hostName = it->second.hostName;
+    std::clog << "DNS: Found " << ip << " in dns cache\n";
+    return(true);
 }
 
 //********************************************************************
 //                      pulseTicks
 //********************************************************************
 
-void Server::pulseTicks(long t) {
+void Server::pulseTicks(const TickSlice& slice) {
 
-    for(Socket* sock : *vSockets) {
+    for(Socket* sock : vSockets) {
         Player* player=sock->getPlayer();
-        if(player) {
-            player->pulseTick(t);
+        if(player && slice.contains(player)) {
+            player->pulseTick(slice.t);
             if(player->isPlaying())
-                player->pulseSong(t);
+                player->pulseSong(slice.t);
         }
     }
 }
@@ -737,7 +763,7 @@ void Server::updateUsers(long t) {
     int tout;
     lastUserUpdate = t;
 
-    for(Socket* sock : *vSockets) {
+    for(Socket* sock : vSockets) {
 
         Player* player= sock->getPlayer();
 
@@ -767,7 +793,7 @@ void Server::updateUsers(long t) {
 // have entered them.  If it is determined that random monster should enter
 // a room, it is loaded and items it is carrying will be loaded with it.
 
-void Server::updateRandom(long t) {
+void Server::updateRandom(const TickSlice& slice) {
     Monster* monster=nullptr;
     BaseRoom* room=nullptr;
     UniqueRoom* uRoom=nullptr;
@@ -777,10 +803,10 @@ void Server::updateRandom(long t) {
     int     num=0, l=0;
     std::map<std::string, bool> check;
 
-    lastRandomUpdate = t;
+    lastRandomUpdate = slice.t;
 
     Player* player;
-    for(Socket * sock : *vSockets) {
+    for(Socket * sock : vSockets) {
         player = sock->getPlayer();
 
         if(!player || !player->getRoomParent())
@@ -789,6 +815,10 @@ void Server::updateRandom(long t) {
         aRoom = player->getAreaRoomParent();
         room = player->getRoomParent();
 
+        // Slice by room rather than player so a room only gets one roll
+        if(!slice.contains(room))
+            continue;
+
         if(uRoom) {
             // handle monsters arriving in unique rooms
             if(!uRoom->info.id)
@@ -877,11 +907,12 @@ void Server::updateRandom(long t) {
 // active (ie. monsters on the active list). Usually this is reserved
 // for monsters in rooms that are occupied by players.
 
-void Server::updateActive(long t) {
+void Server::updateActive(const TickSlice& slice) {
     Creature* target = nullptr;
     Monster* monster = nullptr;
     BaseRoom* room = nullptr;
 
+    long    t = slice.t;
     long    tt = gConfig->currentHour();
     int     timetowander=0, immort=0;
     bool    print=false;
@@ -898,6 +929,8 @@ void Server::updateActive(long t) {
 
         // Better be a monster to be on the active list
         ASSERTLOG(monster);
+        if(!slice.contains(monster))
+            continue;
 
         if(!monster->inRoom()) {
             broadcast(isStaff, "^y%s without a parent/area room on the active list. Info: %s. Deleting.",
@@ -1161,6 +1194,8 @@ void Server::addActive(Monster* monster) {
     monster->validateId();
 
     activeList.push_back(monster);
+    // effects on inactive monsters are dropped from the effect queue, so pick them back up
+    monster->effects.schedule();
 }
 
 //*********************************************************************
@@ -1217,138 +1252,121 @@ bool Server::isActive(Monster* monster) {
 //********************************************************************
 //                      reapChildren
 //********************************************************************
+// Checks, without blocking, for children that have closed their pipe and
+// gives their handler one last look at the output.
+//
+// Only our own children are waited on, by pid: other threads run programs
+// of their own (WebNotifier's wget) and wait for them themselves, so SIGCHLD
+// is left alone and nothing here waits on any child.
 
 int Server::reapChildren() {
     int status;
-    bool dnsChild = false;
-    childProcess myChild;
-    const childProcess* cp;
-    bool found=false;
-    std::cout << "Reaping Children (maybe)\n";
-    pollfd *fds = nullptr;
-
-    while(!children.empty()) {
-        delete fds;
-        fds = new pollfd[children.size()];
-        int i = 0;
-        for(const childProcess& c : children) {
-            fds[i].fd = c.fd;
-            fds[i++].events = POLLHUP;
-        }
-        int ret = ::poll(fds, i, -1);
-        if (ret <= 0) break;
+    std::vector<pollfd> fds;
 
-        std::list<childProcess>::const_iterator it, oldIt;
-        for( it = children.begin(), i=0; it != children.end() ; i++) {
-            cp = &*it;
-            oldIt = it++;
+    std::erase_if(unreaped, [&status](int pid) { return(waitpid(pid, &status, WNOHANG) != 0); });
+    if(children.empty())
+        return(0);
 
-            if(fds[i].revents == 0) {
-                continue;
-            } else if (fds[i].revents != POLLHUP) {
-                std::cout << "Unexpected revent " << fds[i].revents << std::endl;
-                continue;
-            }
-
-            std::cout << "waitpid " << cp->pid << std::endl;
-            waitpid(cp->pid, &status, WNOHANG);
-
-            if(cp->type == ChildType::DNS_RESOLVER) {
-                char tmpBuf[1024];
-                memset(tmpBuf, '\0', sizeof(tmpBuf));
-                // Read in the results from the resolver
-                size_t n = read(cp->fd, tmpBuf, 1023);
-
-                // Close the read fd in the pipe now, won't need it anymore
-                close(cp->fd);
-                // If we have an error reading, just use the ip address then
-                if( n <= 0 ) {
-                    if(errno == EWOULDBLOCK)
-                        std::clog << "DNS ReapChildren: Error would block\n";
-                    else
-                        std::clog << "DNS ReapChildren: Error\n";
-                    strcpy(tmpBuf, cp->extra.c_str());
-                }
+    fds.reserve(children.size());
+    for(const childProcess& c : children)
+        fds.push_back({c.fd, POLLHUP, 0});
 
-                // Add dns to cache
-                addCache(cp->extra, tmpBuf);
-                dnsChild = true;
+    if(::poll(fds.data(), fds.size(), 0) <= 0)
+        return(0);
 
-                // Now we want to look through all connected sockets and update dns where appropriate
-                for(Socket &sock : sockets) {
-                    if(sock.getState() == LOGIN_DNS_LOOKUP && sock.getIp() == cp->extra) {
-                        // Be sure to set the hostname first, then check for lockout
-                        sock.setHostname(tmpBuf);
-                        sock.checkLockOut();
-                    }
-                }
-                std::clog << "Reaped DNS child (" << cp->pid << "-" << tmpBuf << ")\n";
-            } else if(cp->type == ChildType::LISTER) {
-                std::clog << "Reaping LISTER child (" << cp->pid << "-" << cp->extra << ")" << std::endl;
-                processListOutput(*cp);
-                // Don't forget to close the pipe!
-                close(cp->fd);
-            } else if(cp->type == ChildType::SWAP_FINISH) {
-                std::clog << "Reaping MoveRoom Finish child (" << cp->pid << "-" << cp->extra << ")" << std::endl;
-                myChild = *it;
-                found = true;
-            } else if(cp->type == ChildType::PRINT) {
-                //broadcast(isDm, "Reaping Print Child (%d-%s)",pid, cp->extra.c_str());
-                std::clog << "Reaping Print child (" << cp->pid << "-" << cp->extra << ")" << std::endl;
-                myChild = *it;
-                found = true;
-            } else {
-                std::clog << "ReapChildren: Unknown child type " << (int)cp->type << std::endl;
-            }
-            children.erase(oldIt);
-
-            // finish swap after they've been deleted from the list
-            if(found) {
-                found = false;
-                if(myChild.type == ChildType::SWAP_FIND) {
-                    gConfig->findNextEmpty(myChild, true);
-                } else if(myChild.type == ChildType::SWAP_FINISH) {
-                    gConfig->offlineSwap(myChild, true);
-                } else if(myChild.type == ChildType::PRINT) {
-                    const Player* player = gServer->findPlayer(myChild.extra);
-                    std::string output = gServer->simpleChildRead(myChild);
-                    if(player && !output.empty())
-                        player->printColor("%s\n", output.c_str());
-                }
-                // Don't forget to close the pipe!
-                close(myChild.fd);
-            }
+    size_t i = 0;
+    // Handlers may start new children; those are only checked next time around
+    for(auto it = children.begin(); it != children.end() && i < fds.size() ; i++) {
+        if(fds[i].revents == 0) {
+            it++;
+            continue;
+        } else if (!(fds[i].revents & POLLHUP)) {
+            std::cout << "Unexpected revent " << fds[i].revents << std::endl;
+            it++;
+            continue;
         }
+
+        // Take it off the list before handling it; swap handlers check the
+        // list to see if a search is still running.
+        childProcess child = std::move(*it);
+        it = children.erase(it);
+
+        std::clog << "Reaping child " << (int)child.type << " (" << child.pid << "-" << child.extra << ")" << std::endl;
+        // The pipe can close a moment before the child is gone
+        if(waitpid(child.pid, &status, WNOHANG) == 0)
+            unreaped.push_back(child.pid);
+
+        if(child.handler)
+            child.handler(child, true);
+        else
+            std::clog << "ReapChildren: No handler for child type " << (int)child.type << std::endl;
+
+        // Don't forget to close the pipe!
+        close(child.fd);
     }
-    if(dnsChild)
-        saveDnsCache();
-    if(fds != nullptr) {
-        delete fds;
-        fds = nullptr;
-    }
-    // just in case, kill off any zombies
-    wait3(&status, WNOHANG, (struct rusage *)nullptr);
     return(0);
 }
 
+//********************************************************************
+//                      childHandler
+//********************************************************************
+// The default handler for each type of child.
+
+ChildHandler Server::childHandler(ChildType type) {
+    switch(type) {
+        case ChildType::LISTER:
+            return([this](childProcess& child, bool onReap) {
+                processListOutput(child);
+            });
+        case ChildType::SWAP_FIND:
+            return([](childProcess& child, bool onReap) {
+                gConfig->findNextEmpty(child, onReap);
+            });
+        case ChildType::SWAP_FINISH:
+            return([](childProcess& child, bool onReap) {
+                gConfig->offlineSwap(child, onReap);
+            });
+        case ChildType::DEMOGRAPHICS:
+            // The results are written to a file; just drain the pipe
+            return([this](childProcess& child, bool onReap) {
+                simpleChildRead(child);
+            });
+        case ChildType::PRINT:
+            return([this](childProcess& child, bool onReap) {
+                const Player* player = findPlayer(child.extra);
+                std::string output = simpleChildRead(child);
+                if(player && !output.empty())
+                    player->printColor("%s\n", output.c_str());
+            });
+        default:
+            return(nullptr);
+    }
+}
+
 //********************************************************************
 //                      processListOutput
 //********************************************************************
 
-int Server::processListOutput(const childProcess &lister) {
-    bool found = false;
-    Socket* foundSock;
-    for(auto& sock : sockets) {
-        if(sock.getPlayer() && lister.extra == sock.getPlayer()->getName()) {
-            found = true;
-            foundSock = &sock;
-            break;
+// The output goes to whoever asked for it, if they're still connected;
+// without a handle, to whoever's playing the character that asked.
+
+int Server::processListOutput(const childProcess &lister, SocketHandle requester) {
+    Socket* foundSock = nullptr;
+    if(requester.isSet()) {
+        foundSock = sockets.get(requester);
+    } else {
+        for(auto& sock : sockets) {
+            if(sock.getPlayer() && lister.extra == sock.getPlayer()->getName()) {
+                foundSock = &sock;
+                break;
+            }
         }
     }
+    bool found = foundSock != nullptr;
 
     char tmpBuf[4096];
     std::string toWrite;
-    size_t n;
+    ssize_t n;
     for(;;) {
         // Even if no socket is found, read in all the data
         memset(tmpBuf, '\0', sizeof(tmpBuf));
@@ -1371,91 +1389,59 @@ int Server::processListOutput(const childProcess &lister) {
 
 int Server::processChildren() {
     for(childProcess & child : children) {
-        if(child.type == ChildType::DNS_RESOLVER) {
-            // Ignore, will be handled by reapChildren
-        } else if(child.type == ChildType::LISTER) {
-            processListOutput(child);
-        } else if(child.type == ChildType::SWAP_FIND) {
-            gConfig->findNextEmpty(child, false);
-        } else if(child.type == ChildType::SWAP_FINISH) {
-            gConfig->offlineSwap(child, false);
-        } else if(child.type == ChildType::PRINT) {
-            const Player* player = gServer->findPlayer(child.extra);
-            std::string output = gServer->simpleChildRead(child);
-            if(player && !output.empty())
-                player->printColor("%s\n", output.c_str());
-        } else {
-            std::clog << "processChildren: Unknown child type " << (int)child.type << std::endl;
-        }
+        if(child.handler)
+            child.handler(child, false);
+        else
+            std::clog << "processChildren: No handler for child type " << (int)child.type << std::endl;
     }
     return(1);
 }
 
 
 //********************************************************************
-//                      startDnsLookup
+//                      processDns
 //********************************************************************
+// Picks up lookups the resolver threads have finished, caches them and
+// lets any sockets waiting on that ip carry on logging in.
 
-int Server::startDnsLookup(Socket* sock, struct sockaddr_in addr) {
-    int fds[2];
-    int pid;
-
-    // We're going to make a pipe here.
-    // The child process will write the
-    if(pipe(fds) == -1) {
-        std::clog << "DNS: Error with pipe!\n";
-        abort();
-    }
-    pid = fork();
-    if(!pid) {
-        // Child Process: Close the reading end, we'll only be writing
-        close(fds[0]);
-        int tries = 0, res = 0;
-        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-
-        while(tries < 5 && tries >= 0) {
-            res = getnameinfo((struct sockaddr*) &addr, sizeof(addr), hbuf, sizeof(hbuf), sbuf, sizeof(sbuf), NI_NAMEREQD);
-
-            if (res != 0) {
-                switch(res) {
-                    case EAI_FAIL:
-                    case EAI_BADFLAGS:
-                    case EAI_MEMORY:
-                    case EAI_OVERFLOW:
-                    case EAI_SYSTEM:
-                        std::clog << "DNS Error: Unrecoverable error for " << sock->getIp() << std::endl;
-                        tries = -1;
-                        break;
-                    case EAI_NONAME:
-                        std::clog << "DNS Error: Host not found for " << sock->getIp() << std::endl;
-                        tries = -1;
-                        break;
-                    case EAI_AGAIN:
-                    default:
-                        std::clog << "DNS Error: Try again for " << sock->getIp() << std::endl;
-                        tries++;
-                        break;
-                }
-            } else {
-                break;
+int Server::processDns() {
+    if(!resolver || resolver->getFd() == -1 || !FD_ISSET(resolver->getFd(), &inSet))
+        return(0);
+
+    std::list<DnsResolver::Result> results = resolver->takeResults();
+    for(const DnsResolver::Result& result : results) {
+        // Add dns to cache
+        addCache(result.ip, result.hostName);
+
+        // Now we want to look through all connected sockets and update dns where appropriate
+        for(Socket &sock : sockets) {
+            if(sock.getState() == LOGIN_DNS_LOOKUP && sock.getIp() == result.ip) {
+                // Be sure to set the hostname first, then check for lockout
+                sock.setHostname(result.hostName);
+                sock.checkLockOut();
             }
         }
-        std::clog << "DNS: Resolver finished for " << sock->getIp() << "(" << (!res ? hbuf : sock->getIp()) << ")" << std::endl;
-        if(res == 0) {
-            // Found a hostname so print it
-            write(fds[1], hbuf, strlen(hbuf));
-        } else {
-            // Didn't find a hostname, print the ip
-            write(fds[1], sock->getIp().data(), sock->getIp().length());
-        }
-        exit(0);
-    } else { // pid != 0
-        // Parent Process: Close the writing end, we'll only be reading
-        close(fds[1]);
-        std::clog << "Watching Child DNS Resolver for(" << sock->getIp() << ") running with pid " << pid << " reading from fd " << fds[0] << std::endl;
-        // Let the server know we're monitoring this child process
-        addChild(pid, ChildType::DNS_RESOLVER, fds[0], sock->getIp());
     }
+    if(!results.empty())
+        saveDnsCache();
+    return(static_cast<int>(results.size()));
+}
+
+//********************************************************************
+//                      startDnsLookup
+//********************************************************************
+// Hands the lookup to the resolver threads; processDns finishes the job. A
+// second connection from an ip we're already resolving just waits for the
+// first lookup to come back.
+
+int Server::startDnsLookup(Socket* sock, struct sockaddr_in addr) {
+    if(!resolver)
+        resolver = new DnsResolver();
+
+    if(resolver->lookup(sock->getIp(), addr))
+        std::clog << "DNS: Queued lookup for " << sock->getIp() << std::endl;
+    else
+        std::clog << "DNS: Lookup for " << sock->getIp() << " already in flight" << std::endl;
     return(0);
 }
 
@@ -1466,16 +1452,88 @@ int Server::startDnsLookup(Socket* sock, struct sockaddr_in addr) {
 void Server::addCache(std::string_view ip, std::string_view hostName, time_t t) {
     if(t == -1)
         t = time(nullptr);
-    cachedDns.emplace_back(ip, hostName, t);
+    cachedDns.insert_or_assign(std::string(ip), dnsCache(ip, hostName, t));
 }
 
 //********************************************************************
 //                      addChild
 //********************************************************************
 
-void Server::addChild(int pid, ChildType pType, int pFd, std::string_view pExtra) {
+void Server::addChild(int pid, ChildType pType, int pFd, std::string_view pExtra, ChildHandler handler) {
     std::clog << "Adding pid " << pid << " as child type " << (int)pType << ", watching " << pFd << "\n";
-    children.emplace_back(pid, pType, pFd, pExtra);
+    if(!handler)
+        handler = childHandler(pType);
+    children.emplace_back(pid, pType, pFd, pExtra, std::move(handler));
+}
+
+//********************************************************************
+//                      runAsync
+//********************************************************************
+
+void Server::runAsync(AsyncJob job) {
+    if(!asyncPool)
+        asyncPool = new AsyncPool();
+    asyncPool->run(std::move(job));
+}
+
+//********************************************************************
+//                      getCompressPool
+//********************************************************************
+// One thread of its own, so compression never waits behind slow jobs
+
+AsyncPool* Server::getCompressPool() {
+    if(!compressPool)
+        compressPool = new AsyncPool(1);
+    return(compressPool);
+}
+
+//********************************************************************
+//                      notifyWebserver
+//********************************************************************
+
+bool Server::notifyWebserver(std::string_view url, std::string_view userAgent) {
+    if(!webNotifier)
+        webNotifier = new WebNotifier();
+    return(webNotifier->notify(url, userAgent));
+}
+
+//********************************************************************
+//                      processAsync
+//********************************************************************
+
+int Server::processAsync() {
+    if(!asyncPool || asyncPool->getFd() == -1 || !FD_ISSET(asyncPool->getFd(), &inSet))
+        return(0);
+    return(asyncPool->runCallbacks());
+}
+
+//********************************************************************
+//                      postEvent
+//********************************************************************
+// Safe from any thread. Other threads must never touch game state
+// themselves; they post an event and the game loop handles it.
+
+void Server::postEvent(GameEvent event) {
+    mailbox.post(std::move(event));
+}
+
+//********************************************************************
+//                      processMailbox
+//********************************************************************
+
+int Server::processMailbox() {
+    GameEvent event;
+    int handled = 0;
+    while(handled < MAILBOX_FRAME_MAX && mailbox.pop(event)) {
+        handled++;
+        if(auto* message = std::get_if<DiscordMessage>(&event))
+            handleDiscordMessage(*message);
+        else if(auto* who = std::get_if<DiscordWho>(&event))
+            handleDiscordWho(*who);
+        else if(auto* callback = std::get_if<GameCallback>(&event); callback && *callback)
+            (*callback)();
+    }
+    return(handled);
 }
 
 // End - Children Control
@@ -1495,12 +1553,14 @@ void Server::saveDnsCache() {
     rootNode = xmlNewDocNode(xmlDoc, nullptr, BAD_CAST "DnsCache", nullptr);
     xmlDocSetRootElement(xmlDoc, rootNode);
 
-    std::list<dnsCache>::iterator it;
-    for( it = cachedDns.begin(); it != cachedDns.end() ; it++) {
+    time_t now = time(nullptr);
+    for(const auto& [ip, dns] : cachedDns) {
+        if(now - dns.time >= DNS_CACHE_TTL)
+            continue;
         curNode = xmlNewChild(rootNode, nullptr, BAD_CAST"Dns", nullptr);
-        xml::newStringChild(curNode, "Ip", (*it).ip.c_str());
-        xml::newStringChild(curNode, "HostName", (*it).hostName.c_str());
-        xml::newNumChild(curNode, "Time", (long)(*it).time);
+        xml::newStringChild(curNode, "Ip", dns.ip.c_str());
+        xml::newStringChild(curNode, "HostName", dns.hostName.c_str());
+        xml::newNumChild(curNode, "Time", (long)dns.time);
     }
 
     sprintf(filename, "%s/dns.xml", Path::Config);
@@ -1523,6 +1583,7 @@ void Server::loadDnsCache() {
     if(xmlDoc == nullptr)
         return;
 
+    long now = ::time(nullptr);
     curNode = xmlDocGetRootElement(xmlDoc);
 
     curNode = curNode->children;
@@ -1545,7 +1606,8 @@ void Server::loadDnsCache() {
                     xml::copyToString(hostname, childNode);
                 } else if(NODE_NAME(childNode, "Time")) {
                     xml::copyToNum(time, childNode);
-                    addCache(ip, hostname, time);
+                    if(now - time < DNS_CACHE_TTL)
+                        addCache(ip, hostname, time);
                 }
                 childNode = childNode->next;
             }
@@ -1590,6 +1652,7 @@ bool Server::startReboot(bool resetShips) {
             }
             player->save(true);
             players[player->getName()] = nullptr;
+            channels.remove(player);
             player->uninit();
             free_crt(player);
             player = nullptr;
@@ -1606,6 +1669,8 @@ bool Server::startReboot(bool resetShips) {
     if(resetShips)
         Config::resetShipsFile();
 
+    stopGoldLog();
+
     char port[10], path[80];
 
     sprintf(port, "%d", Port);
@@ -1866,11 +1931,15 @@ void Server::saveAllPly() {
 // This will NOT free up the player, it will just remove them from the list
 
 bool Server::clearPlayer(const std::string &name) {
+    auto it = players.find(name);
+    if(it != players.end() && it->second)
+        channels.remove(it->second);
     players.erase(name);
     return(true);
 }
 
 bool Server::clearPlayer(Player* player) {
+    channels.remove(player);
     players.erase(player->getName());
     player->unRegisterMo();
     return(true);
@@ -1884,7 +1953,10 @@ bool Server::addPlayer(Player* player) {
     player->validateId();
     players[player->getName()] = player;
     player->getSock()->addToPlayerList();
+    // effects on players who aren't in the game are dropped from the effect queue
+    player->effects.schedule();
     player->registerMo();
+    channels.add(player);
     return(true);
 }
 
@@ -2278,6 +2350,45 @@ void Server::saveIds() {
     idDirty = false;
 }
 
+//*********************************************************************
+//                      initGoldLog
+//*********************************************************************
+// LogDatabaseType "file" writes to a file instead of a database, which is
+// also handy for testing without one
+
+void Server::initGoldLog() {
+    std::unique_ptr<GoldSink> sink;
+    if(gConfig->getLogDbType() == "file") {
+        sink = std::make_unique<FileGoldSink>(std::string(Path::Log) + "/goldlog.txt");
+    } else {
+#ifdef SQL_LOGGER
+        std::clog << "Initializing SQL Logger." << std::endl;
+        sink = std::make_unique<SqlGoldSink>(gConfig->getDbConnectionString());
+#endif // SQL_LOGGER
+    }
+    if(sink)
+        goldLog = new GoldLogWriter(std::move(sink), std::string(Path::Log) + "/goldlog.journal");
+}
+
+void Server::stopGoldLog() {
+    delete goldLog;
+    goldLog = nullptr;
+}
+
+const GoldLogWriter* Server::getGoldLog() const {
+    return(goldLog);
+}
+
+#ifdef SQL_LOGGER
+bool Server::getConnStatus() {
+    return(goldLog && goldLog->getStats().connected);
+}
+#endif // SQL_LOGGER
+
+//*********************************************************************
+//                      logGold
+//*********************************************************************
+
 void Server::logGold(GoldLog dir, Player* player, Money amt, MudObject* target, std::string_view logType) {
     std::string pName = player->getName();
     std::string pId = player->getId();
@@ -2307,9 +2418,8 @@ void Server::logGold(GoldLog dir, Player* player, Money amt, MudObject* target,
     std::string direction = (dir == GOLD_IN ? "In" : "Out");
     std::clog << direction << ": P:" << pName << " I:" << pId << " T: " << targetStr << " S:" << source << " R: " << room << " Type:" << logType << " G:" << amt.get(GOLD) << std::endl;
 
-#ifdef SQL_LOGGER
-    logGoldSql(pName, pId, targetStr, source, room, logType, amt.get(GOLD), direction);
-#endif // SQL_LOGGER
+    if(gServer->goldLog)
+        gServer->goldLog->post(GoldEvent{pName, pId, targetStr, source, room, std::string(logType), amt.get(GOLD), direction});
 }
 
 //*********************************************************************
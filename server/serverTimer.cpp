@@ -16,8 +16,9 @@
  *
  */
 
-#include <sys/select.h>     // for select
-#include <sys/time.h>       // for timeval, gettimeofday
+#include <sys/time.h>       // for timeval
+#include <algorithm>        // for nth_element
+#include <thread>           // for sleep_until
 
 #include "serverTimer.hpp"  // for ServerTimer
 
@@ -53,25 +54,13 @@ void timeDiff(const struct timeval& x, const struct timeval& y, struct timeval&
     }
 }
 
-//*********************************************************************
-//                          reset
-//*********************************************************************
-
-void ServerTimer::reset() {
-    timeZero(timePassed);
-    timeZero(startTime);
-    timeZero(endTime);
-    running = 0;
-}
-
 //*********************************************************************
 //                          start
 //*********************************************************************
 
 void ServerTimer::start() {
-    reset();
-    running = 1;
-    gettimeofday(&startTime, nullptr);
+    running = true;
+    startTime = Clock::now();
 }
 
 //*********************************************************************
@@ -79,25 +68,56 @@ void ServerTimer::start() {
 //*********************************************************************
 
 void ServerTimer::end() {
-    gettimeofday(&endTime, nullptr);
-    timeDiff(endTime,startTime, timePassed);
+    timePassed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count();
     running = false;
+
+    if(history.size() < FRAME_HISTORY) {
+        history.push_back(timePassed);
+    } else {
+        history[historyPos] = timePassed;
+        historyPos = (historyPos + 1) % FRAME_HISTORY;
+    }
 }
 
 //*********************************************************************
 //                          sleep
 //*********************************************************************
 
-void ServerTimer::sleep() {
+void ServerTimer::sleep(long frameLength) {
     // Only sleep if we're not running!
     if(running)
         return;
-    if(timePassed.tv_sec > 0 || timePassed.tv_usec > 100000) {
-        //Do nothing
-    } else {
-        struct timeval toSleep{};
-        timeZero(toSleep);
-        toSleep.tv_usec = 100000 - timePassed.tv_usec;
-        select(0,nullptr,nullptr,nullptr,&toSleep);
-    }
+
+    Clock::time_point now = Clock::now();
+    if(nextFrame.time_since_epoch().count() == 0)
+        nextFrame = startTime;
+    nextFrame += std::chrono::microseconds(frameLength);
+
+    // Too far behind to make it up; start counting from now
+    if(nextFrame + std::chrono::microseconds(frameLength) < now)
+        nextFrame = now;
+
+    if(nextFrame > now)
+        std::this_thread::sleep_until(nextFrame);
+}
+
+//*********************************************************************
+//                          get
+//*********************************************************************
+
+long ServerTimer::getLast() const {
+    return(timePassed);
+}
+
+size_t ServerTimer::getSamples() const {
+    return(history.size());
+}
+
+long ServerTimer::getPercentile(int pct) const {
+    if(history.empty())
+        return(0);
+    std::vector<long> sorted = history;
+    size_t idx = std::min(sorted.size() - 1, sorted.size() * pct / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    return(sorted[idx]);
 }
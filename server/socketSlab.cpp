@@ -0,0 +1,179 @@
+/*
+ * socketSlab.cpp
+ *   Where the server keeps its sockets, and handles that outlive them
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <new>                  // for operator new, align_val_t
+
+#include "socket.hpp"           // for Socket
+#include "socketSlab.hpp"       // for SocketSlab, SocketHandle
+
+// Sanitizer builds poison a slot while there's no socket in it, so a Socket*
+// kept past remove_if is caught the way it was when they were freed
+#if defined(__SANITIZE_ADDRESS__)
+#define SOCKETSLAB_POISON
+#endif
+#if !defined(SOCKETSLAB_POISON) && defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SOCKETSLAB_POISON
+#endif
+#endif
+
+#ifdef SOCKETSLAB_POISON
+#include <sanitizer/asan_interface.h>   // for ASAN_POISON_MEMORY_REGION
+#define POISON_SOCKETS(ptr, count)      ASAN_POISON_MEMORY_REGION(ptr, sizeof(Socket) * (count))
+#define UNPOISON_SOCKETS(ptr, count)    ASAN_UNPOISON_MEMORY_REGION(ptr, sizeof(Socket) * (count))
+#else
+#define POISON_SOCKETS(ptr, count)
+#define UNPOISON_SOCKETS(ptr, count)
+#endif
+
+SocketSlab::~SocketSlab() {
+    clear();
+    for(void* chunk : chunks) {
+        UNPOISON_SOCKETS(chunk, SOCKETSLAB_CHUNK);
+        ::operator delete(chunk, std::align_val_t(alignof(Socket)));
+    }
+}
+
+//*********************************************************************
+//                      emplace_back
+//*********************************************************************
+
+Socket& SocketSlab::emplace_back(int fd) {
+    uint32_t index = claim();
+    try {
+        new(slots[index].socket) Socket(fd);
+    } catch(...) {
+        POISON_SOCKETS(slots[index].socket, 1);
+        freed.push_back(index);
+        throw;
+    }
+    return(finish(index));
+}
+
+Socket& SocketSlab::emplace_back(int fd, sockaddr_in addr, bool dnsDone) {
+    uint32_t index = claim();
+    try {
+        new(slots[index].socket) Socket(fd, addr, dnsDone);
+    } catch(...) {
+        POISON_SOCKETS(slots[index].socket, 1);
+        freed.push_back(index);
+        throw;
+    }
+    return(finish(index));
+}
+
+// A free slot to build a socket in; a new chunk of them if there are none
+uint32_t SocketSlab::claim() {
+    if(freed.empty()) {
+        auto* chunk = static_cast<Socket*>(::operator new(sizeof(Socket) * SOCKETSLAB_CHUNK, std::align_val_t(alignof(Socket))));
+        POISON_SOCKETS(chunk, SOCKETSLAB_CHUNK);
+        chunks.push_back(chunk);
+        // Backwards, so the first of them is used first
+        for(int i = SOCKETSLAB_CHUNK - 1; i >= 0; i--) {
+            freed.push_back(slots.size() + i);
+        }
+        for(int i = 0; i < SOCKETSLAB_CHUNK; i++) {
+            slots.push_back(Slot{chunk + i});
+        }
+    }
+    uint32_t index = freed.back();
+    freed.pop_back();
+    UNPOISON_SOCKETS(slots[index].socket, 1);
+    return(index);
+}
+
+Socket& SocketSlab::finish(uint32_t index) {
+    Slot& slot = slots[index];
+    slot.used = true;
+    slot.socket->handle = SocketHandle{index, slot.generation};
+    live.push_back(index);
+    return(*slot.socket);
+}
+
+//*********************************************************************
+//                      remove_if
+//*********************************************************************
+// Everything pred picks is out of the iteration order before any of them
+// are destroyed, so a destructor that looks through the sockets won't find
+// one that's half gone.
+
+void SocketSlab::remove_if(const std::function<bool(Socket&)>& pred) {
+    std::vector<uint32_t> removed;
+    size_t kept = 0;
+    for(size_t i = 0; i < live.size(); i++) {
+        if(pred(*slots[live[i]].socket))
+            removed.push_back(live[i]);
+        else
+            live[kept++] = live[i];
+    }
+    live.resize(kept);
+    destroy(removed);
+}
+
+void SocketSlab::clear() {
+    std::vector<uint32_t> removed;
+    removed.swap(live);
+    destroy(removed);
+}
+
+void SocketSlab::destroy(const std::vector<uint32_t>& indexes) {
+    for(uint32_t index : indexes) {
+        Slot& slot = slots[index];
+        // Handles to it stop working before it's gone
+        slot.used = false;
+        if(++slot.generation == 0)
+            slot.generation = 1;
+        slot.socket->~Socket();
+        POISON_SOCKETS(slot.socket, 1);
+        freed.push_back(index);
+    }
+}
+
+//*********************************************************************
+//                      get
+//*********************************************************************
+
+Socket* SocketSlab::get(const SocketHandle& handle) const {
+    if(!handle.isSet() || handle.index >= slots.size())
+        return(nullptr);
+    const Slot& slot = slots[handle.index];
+    if(!slot.used || slot.generation != handle.generation)
+        return(nullptr);
+    return(slot.socket);
+}
+
+size_t SocketSlab::size() const {
+    return(live.size());
+}
+
+bool SocketSlab::empty() const {
+    return(live.empty());
+}
+
+//*********************************************************************
+//                      getRotated
+//*********************************************************************
+
+void SocketSlab::getRotated(std::vector<Socket*>& order) {
+    order.clear();
+    if(live.empty())
+        return;
+    size_t start = rotation++ % live.size();
+    for(size_t i = 0; i < live.size(); i++)
+        order.push_back(slots[live[(start + i) % live.size()]].socket);
+}
@@ -18,6 +18,7 @@
 
 #ifdef SQL_LOGGER
 
+#include <memory>
 #include <sstream>
 
 #include <odbc++/drivermanager.h>
@@ -27,6 +28,7 @@
 #include <odbc++/preparedstatement.h>
 
 #include "config.hpp"
+#include "goldLog.hpp"
 #include "mud.hpp"
 #include "server.hpp"
 
@@ -44,6 +46,10 @@ std::string Config::getDbConnectionString() {
     } else if (logDbType == "postgres" || logDbType == "postgresql") {
         // Untested
         connStr << "Driver=PostgreSQL ANSI;";
+    } else if (logDbType == "dsn") {
+        // A DSN from odbc.ini, such as a local SQLite database
+        connStr << "DSN=" << logDbDatabase << ";";
+        return(connStr.str());
     }
     connStr << "Server=localhost;";
     connStr << "Database=" << logDbDatabase << ";";
@@ -62,73 +68,75 @@ std::string Config::getDbConnectionString() {
 }
 
 //################################################################################
-//#    Server::initSql()
+//#    SqlGoldSink
 //################################################################################
+// Runs on the gold log's writer thread, never the game loop
 
-bool Server::initSql() {
-    if(connActive) {
-        return(false);
-    }
+SqlGoldSink::SqlGoldSink(std::string pConnStr): connStr(std::move(pConnStr)) {
+}
+
+SqlGoldSink::~SqlGoldSink() {
+    disconnect();
+    odbc::DriverManager::shutdown();
+}
+
+bool SqlGoldSink::connect() {
+    if(conn)
+        return(true);
 
     try {
         odbc::DriverManager::setLoginTimeout(0);
-        conn = odbc::DriverManager::getConnection(gConfig->getDbConnectionString());
-        connActive = true;
-
+        conn = odbc::DriverManager::getConnection(connStr);
     } catch(odbc::SQLException& e) {
-        std::cerr << e.getMessage() << std::endl;
+        std::clog << "Gold log: " << e.getMessage() << std::endl;
+        conn = nullptr;
         return(false);
     }
     return(true);
 }
 
-void Server::cleanUpSql() {
-    if(!connActive)
-        return;
-    std::clog << "Cleaning up SQL." << std::endl;
-
+void SqlGoldSink::disconnect() {
     delete conn;
-    odbc::DriverManager::shutdown();
-    connActive = false;
+    conn = nullptr;
 }
 
-bool Server::logGoldSql(std::string& pName, std::string& pId, std::string& targetStr, std::string& source, std::string& room,
-                        std::string& logType, unsigned long amt, std::string& direction)
-{
-    if (!connActive)
-        return (false);
+bool SqlGoldSink::isConnected() const {
+    return(conn != nullptr);
+}
 
-    try {
-        odbc::PreparedStatement* stmt = conn->prepareStatement("INSERT INTO goldlog(PlayerName,PlayerID,Target,"
-            "Source,Room,LogType,Gold,Direction) VALUES (?,?,?,?,?,?,?,?)");
-
-        stmt->setString(1, pName);
-        stmt->setString(2, pId);
-        stmt->setString(3, targetStr);
-        stmt->setString(4, source);
-        stmt->setString(5, room);
-        stmt->setString(6, logType);
-        stmt->setLong(7, amt);
-        stmt->setString(8, direction);
-        stmt->executeUpdate();
+bool SqlGoldSink::insert(const std::vector<GoldEvent>& batch) {
+    if(!conn)
+        return(false);
 
-        delete stmt;
-        //conn->unregisterStatement(stmt);
+    // One statement for the whole batch
+    std::string sql = "INSERT INTO goldlog(PlayerName,PlayerID,Target,Source,Room,LogType,Gold,Direction) VALUES ";
+    for(size_t i = 0; i < batch.size(); i++)
+        sql += i ? ",(?,?,?,?,?,?,?,?)" : "(?,?,?,?,?,?,?,?)";
 
+    try {
+        std::unique_ptr<odbc::PreparedStatement> stmt(conn->prepareStatement(sql));
+        int col = 1;
+        for(const GoldEvent& event : batch) {
+            stmt->setString(col++, event.player);
+            stmt->setString(col++, event.id);
+            stmt->setString(col++, event.target);
+            stmt->setString(col++, event.source);
+            stmt->setString(col++, event.room);
+            stmt->setString(col++, event.type);
+            stmt->setLong(col++, event.gold);
+            stmt->setString(col++, event.direction);
+        }
+        stmt->executeUpdate();
         return(true);
     } catch (odbc::SQLException &e ) {
-
-        std::cerr << e.getMessage() << std::endl;
-        broadcast(isDm, "%s", e.getMessage().c_str());
-        cleanUpSql();
+        std::string error = e.getMessage();
+        std::cerr << error << std::endl;
+        // Let the DMs know, from the game loop
+        gServer->postEvent(GameCallback([error] { broadcast(isDm, "%s", error.c_str()); }));
         return(false);
     }
 }
 
-bool Server::getConnStatus() {
-    return(connActive);
-}
-
 int Server::getConnTimeout() {
     return(odbc::DriverManager::getLoginTimeout());
 }
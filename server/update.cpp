@@ -19,8 +19,12 @@
 #include <unistd.h>                              // for getpid
 #include <boost/algorithm/string/case_conv.hpp>  // for to_lower_copy
 #include <boost/iterator/iterator_facade.hpp>    // for operator!=
+#include <fmt/format.h>                          // for format
+#include <algorithm>                             // for clamp, min
 #include <cctype>                                // for isdigit
+#include <chrono>                                // for steady_clock, duration_cast
 #include <csignal>                               // for signal, SIG_DFL, kill
+#include <cstdint>                               // for uint64_t, uintptr_t
 #include <cstdlib>                               // for free, exit, atoi
 #include <cstring>                               // for strcpy, strlen
 #include <ctime>                                 // for time, ctime
@@ -42,6 +46,7 @@
 #include "hooks.hpp"                             // for Hooks
 #include "lasttime.hpp"                          // for lasttime
 #include "libxml/parser.h"                       // for xmlCleanupParser
+#include "logger.hpp"                            // for flushLogs
 #include "mud.hpp"                               // for Weather, DL_BROAD
 #include "mudObjects/container.hpp"              // for PlayerSet, MonsterSet
 #include "mudObjects/creatures.hpp"              // for Creature
@@ -76,66 +81,144 @@ short           Action_update_interval = 6;
 // off from the main clock. this variable will help us keep
 // things in check
 
+//*********************************************************************
+//                      TickSlice
+//*********************************************************************
+
+int TickSlice::slotOf(const void* ptr) {
+    // Allocations are aligned, so drop the low bits before mixing
+    auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr) >> 4);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return(static_cast<int>((h >> 32) % TICK_SLOTS));
+}
+
+bool TickSlice::contains(const void* ptr) const {
+    int slot = slotOf(ptr);
+    return(slot >= begin && slot < end);
+}
+
+bool TickSlice::isFirst() const {
+    return(begin == 0);
+}
+
 //*********************************************************************
 //                      update_game
 //*********************************************************************
 // This function handles all the updates that occur while players are
-// typing.
+// typing. Once-a-second work that walks a list is spread over the second
+// by the clock (see TickSlice): each frame handles the slots that come due
+// by the time it ends. Everything else still runs in the first frame of the
+// second.
 
 void Server::updateGame() {
     long    t = time(nullptr);
+    auto    now = std::chrono::steady_clock::now();
+
+    // The clock ticked over before the last second was all handed out; finish
+    // it off now, so slow frames never stretch a game second past a real one
+    if(tickDone < TICK_SLOTS && t != last_update)
+        runTickSlots(TICK_SLOTS);
+
+    if(tickDone >= TICK_SLOTS) {
+        if(t == last_update)
+            return;
+        last_update = t;
+        ProfileScope scope(profiler, PROF_GAME_SECOND);
+
+        tickStart = now;
+        tickDone = 0;
+        tickSlice.t = t;
+        tickPulse = t - lastTickUpdate >= 1;
+        tickShips = t%2;    // Run ships every other second.
+        tickRandom = t - lastRandomUpdate >= Random_update_interval;
+        tickActive = t != lastActiveUpdate;
+
+        gServer->parseDelayedActions(t);
+
+        // update on the hour: ie, 3:00
+        // Sometimes on startup, we don't get to this section of the code in 1 second,
+        // meaning this won't run until 1 hour after the game has started. Throwing in
+        // or-firstLoop gives us 2 seconds of time.
+        if(!gConfig->currentMinutes() && (!(t%2) || firstLoop))
+            update_time(t);
+
+        if(t - lastUserUpdate >= 20) {
+            updateUsers(t);
+        }
 
-    if(t == last_update)
-        return;
-    last_update = t;
+        if(t - last_track_update >= 20)
+            gServer->updateTrack(t);
+        if(t - last_weather_update >= 60)
+            gServer->updateWeather(t);
+        if(t - last_action_update >= Action_update_interval)
+            gServer->updateAction(t);
+        if(last_dust_output && last_dust_output < t)
+            update_dust_oldPrint(t);
+        if(t > gConfig->getLotteryRunTime())
+            gConfig->runLottery();
+
+        if(Shutdown.ltime && t - last_shutdown_update >= 30)
+            if(Shutdown.ltime + Shutdown.interval <= t+500)
+                update_shutdown(t);
+    }
 
-    gServer->parseDelayedActions(t);
+    // Slots due by the end of this frame, going by how far into the second we are
+    long frame = 1000000 / std::clamp(gConfig->getTickRate(), 1, TICK_SLOTS);
+    long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - tickStart).count();
+    runTickSlots(static_cast<int>(std::min<long>(TICK_SLOTS, (elapsed + frame) * TICK_SLOTS / 1000000)));
+}
 
-    // update on the hour: ie, 3:00
-    // Sometimes on startup, we don't get to this section of the code in 1 second,
-    // meaning this won't run until 1 hour after the game has started. Throwing in
-    // or-firstLoop gives us 2 seconds of time.
-    if(!gConfig->currentMinutes() && (!(t%2) || firstLoop))
-        update_time(t);
+//*********************************************************************
+//                      runTickSlots
+//*********************************************************************
+// Handles the current game second's slots from where we left off up to due
 
-    // Run ships every other second.
-    if(t%2)
-        gServer->updateShips();
+void Server::runTickSlots(int due) {
+    if(due <= tickDone)
+        return;
+    tickSlice.begin = tickDone;
+    tickSlice.end = due;
 
-    // Prune Dns once a day
-    if(t - lastDnsPrune >= 86400)
-        pruneDns();
-    if(t - lastTickUpdate >= 1) {
-        pulseTicks(t);
-        pulseCreatureEffects(t);
+    if(tickPulse) {
+        { ProfileScope scope(profiler, PROF_GAME_TICKS); pulseTicks(tickSlice); }
+        { ProfileScope scope(profiler, PROF_GAME_EFFECTS); pulseEffects(tickSlice); }
+    }
+    if(tickRandom) {
+        ProfileScope scope(profiler, PROF_GAME_RANDOM);
+        updateRandom(tickSlice);
+    }
+    if(tickActive) {
+        ProfileScope scope(profiler, PROF_GAME_ACTIVE);
+        updateActive(tickSlice);
     }
 
-    // pulse effects
-    if(t - lastUserUpdate >= 20) {
-        updateUsers(t);
+    // Ships move as a whole, so they go with whichever frame reaches the middle of the second
+    if(tickShips && tickDone <= TICK_SLOTS / 2 && due > TICK_SLOTS / 2) {
+        ProfileScope scope(profiler, PROF_GAME_SHIPS);
+        gServer->updateShips();
     }
-    // same cycle length as creature pulses, but offset 10 seconds
-    if(t - lastRoomPulseUpdate >= 20)
-        pulseRoomEffects(t);
-
-    if(t - last_track_update >= 20)
-        gServer->updateTrack(t);
-    if(t - lastRandomUpdate >= Random_update_interval)
-        updateRandom(t);
-    if(t != lastActiveUpdate)
-        updateActive(t);
-    if(t - last_weather_update >= 60)
-        gServer->updateWeather(t);
-    if(t - last_action_update >= Action_update_interval)
-        gServer->updateAction(t);
-    if(last_dust_output && last_dust_output < t)
-        update_dust_oldPrint(t);
-    if(t > gConfig->getLotteryRunTime())
-        gConfig->runLottery();
-
-    if(Shutdown.ltime && t - last_shutdown_update >= 30)
-        if(Shutdown.ltime + Shutdown.interval <= t+500)
-            update_shutdown(t);
+
+    tickDone = due;
+}
+
+//*********************************************************************
+//                      getFrameStats
+//*********************************************************************
+
+Profiler& Server::getProfiler() {
+    return(profiler);
+}
+
+// Microseconds of work in the last frame, not counting the sleep
+long Server::getLastFrameTime() const {
+    return(timer.getLast());
+}
+
+std::string Server::getFrameStats() const {
+    int rate = std::clamp(gConfig->getTickRate(), 1, TICK_SLOTS);
+    return(fmt::format("Frame rate: {}/sec ({}ms)   Work per frame over the last {} frames: {:.1f}ms p50, {:.1f}ms p99, {:.1f}ms last\n",
+        rate, 1000 / rate, timer.getSamples(), timer.getPercentile(50) / 1000.0, timer.getPercentile(99) / 1000.0,
+        timer.getLast() / 1000.0));
 }
 
 
@@ -904,6 +987,8 @@ void doCrash(int sig) {
     // Turning this off because of the xp->ext = nullptr bug which is erasing exits
 //    gConfig->resaveAllRooms(1);
     gServer->saveAllPly();
+    // Before the server goes away with everything else
+    gServer->stopGoldLog();
 
     cleanUpMemory();
 
@@ -913,6 +998,7 @@ void doCrash(int sig) {
     logn("log.crash", oStr.str().c_str());
 
     std::clog << "The mud has crashed :(.\n";
+    flushLogs();
 
     if(sig != -69) {
         signal(sig, SIG_DFL);
@@ -21,7 +21,7 @@
 #include <libxml/parser.h>                       // for xmlDocSetRootElement
 #include <libxml/xmlstring.h>                    // for BAD_CAST
 #include <sys/stat.h>                            // for stat, mkfifo, S_IFIFO
-#include <unistd.h>                              // for unlink, close, fork
+#include <unistd.h>                              // for unlink, close
 #include <algorithm>                             // for replace
 #include <boost/algorithm/string/case_conv.hpp>  // for to_lower, to_lower_copy
 #include <boost/algorithm/string/replace.hpp>    // for replace_all
@@ -965,7 +965,8 @@ std::string webwho() {
 //                      callWebserver
 //*********************************************************************
 // load the webserver with no return value
-// wget must be installed for this call to work
+// the request is queued and sent in the background by the WebNotifier;
+// wget must be installed if the webserver is https
 // questionMark: is a question mark has already been added to the url (for GET parameters)
 
 void callWebserver(std::string url, bool questionMark, bool silent) {
@@ -984,21 +985,8 @@ void callWebserver(std::string url, bool questionMark, bool silent) {
         url += gConfig->getQS();
     }
 
-    // build command here incase we ever want to audit
-    char command[512];
-    sprintf(command, "wget \"%s%s\" -q -O /dev/null", gConfig->getWebserver().c_str(), url.c_str());
-
-    // set the user agent, if applicable
-    if(!gConfig->getUserAgent().empty()) {
-        strcat(command, " -U \"");
-        strcat(command, gConfig->getUserAgent().c_str());
-        strcat(command, "\"");
-    }
-
-    if(!fork()) {
-        system(command);
-        exit(0);
-    }
+    if(!gServer->notifyWebserver(gConfig->getWebserver() + url, gConfig->getUserAgent()))
+        broadcast(isDm, "^yWebserver queue is full, notification dropped.");
 }
 
 //*********************************************************************
@@ -0,0 +1,488 @@
+/*
+ * webNotifier.cpp
+ *   Background queue of notifications sent to the webserver
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <fcntl.h>                  // for fcntl, F_GETFL, F_SETFL, O_NONBLOCK
+#include <netdb.h>                  // for addrinfo, getaddrinfo, freeaddrinfo
+#include <poll.h>                   // for poll, pollfd, POLLIN, POLLOUT
+#include <spawn.h>                  // for posix_spawnp
+#include <sys/socket.h>             // for connect, getsockopt, send, recv
+#include <sys/wait.h>               // for waitpid
+#include <unistd.h>                 // for close
+#include <boost/algorithm/string/case_conv.hpp>  // for to_lower_copy
+#include <boost/algorithm/string/predicate.hpp>  // for istarts_with
+#include <boost/algorithm/string/trim.hpp>       // for trim
+#include <algorithm>                // for min, max
+#include <cerrno>                   // for errno, EINPROGRESS, EINTR, ECONNRESET
+#include <cstdio>                   // for snprintf
+#include <cstdlib>                  // for strtol, strtoul
+#include <iostream>                 // for operator<<, basic_ostream, clog
+#include <sstream>                  // for ostringstream
+
+#include "webNotifier.hpp"
+
+extern char **environ;
+
+//*********************************************************************
+//                      encodeUrl
+//*********************************************************************
+// wget used to tidy up whatever we handed it; spaces and control characters
+// can't go on the request line as-is.
+
+static std::string encodeUrl(std::string_view url) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string encoded;
+    encoded.reserve(url.length());
+    for(char c : url) {
+        auto u = static_cast<unsigned char>(c);
+        if(u <= 0x20 || u >= 0x7f || c == '"') {
+            encoded += '%';
+            encoded += hex[u >> 4];
+            encoded += hex[u & 0x0f];
+        } else {
+            encoded += c;
+        }
+    }
+    return(encoded);
+}
+
+//*********************************************************************
+//                      WebNotifier
+//*********************************************************************
+
+WebNotifier::WebNotifier(size_t pMaxDepth, int pMaxTries): maxDepth(pMaxDepth), maxTries(pMaxTries) {
+    thread = std::thread(&WebNotifier::work, this);
+}
+
+WebNotifier::~WebNotifier() {
+    size_t unsent;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        unsent = requests.size();
+    }
+    wake.notify_all();
+    thread.join();
+    disconnect();
+    if(unsent)
+        std::clog << "WebNotifier: " << unsent << " notification(s) were never sent\n";
+}
+
+//*********************************************************************
+//                      notify
+//*********************************************************************
+
+bool WebNotifier::notify(std::string_view url, std::string_view userAgent) {
+    Request request;
+    request.url = encodeUrl(url);
+    request.userAgent = userAgent;
+    request.queued = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(queuedUrls.count(request.url)) {
+            stats.coalesced++;
+            return(true);
+        }
+        if(requests.size() >= maxDepth) {
+            stats.dropped++;
+            return(false);
+        }
+        Clock::time_point due = request.queued;
+        queuedUrls.insert(request.url);
+        requests.emplace(due, std::move(request));
+        stats.depth = requests.size();
+        stats.peakDepth = std::max(stats.peakDepth, stats.depth);
+    }
+    wake.notify_one();
+    return(true);
+}
+
+//*********************************************************************
+//                      getStats
+//*********************************************************************
+
+WebNotifier::Stats WebNotifier::getStats() {
+    std::lock_guard<std::mutex> guard(lock);
+    return(stats);
+}
+
+std::string WebNotifier::getStatsString() {
+    Stats s = getStats();
+    std::ostringstream oStr;
+    oStr << "Queued: " << s.depth << " (peak " << s.peakDepth << ", max " << maxDepth << ")"
+         << "  Sent: " << s.sent << "  Failed: " << s.failed << "  Retried: " << s.retried
+         << "  Coalesced: " << s.coalesced << "  Dropped: " << s.dropped
+         << "  Connects: " << s.connects << "\n";
+    oStr << "Latency: last " << s.lastLatency << "ms, max " << s.maxLatency << "ms, avg "
+         << (s.sent ? s.totalLatency / (long)s.sent : 0) << "ms\n";
+    return(oStr.str());
+}
+
+//*********************************************************************
+//                      work
+//*********************************************************************
+
+void WebNotifier::work() {
+    std::unique_lock<std::mutex> guard(lock);
+    for(;;) {
+        if(stopping)
+            return;
+        if(requests.empty()) {
+            // Keep the connection around for a little while in case more follow,
+            // but don't hold it open forever
+            if(fd != -1) {
+                if(!wake.wait_for(guard, std::chrono::milliseconds(WEB_NOTIFY_IDLE), [this] { return(stopping || !requests.empty()); })) {
+                    guard.unlock();
+                    disconnect();
+                    guard.lock();
+                }
+                continue;
+            }
+            wake.wait(guard);
+            continue;
+        }
+
+        auto it = requests.begin();
+        if(it->first > Clock::now()) {
+            wake.wait_until(guard, it->first);
+            continue;
+        }
+
+        Request request = std::move(it->second);
+        requests.erase(it);
+        queuedUrls.erase(request.url);
+        guard.unlock();
+
+        bool ok = send(request);
+        auto now = Clock::now();
+
+        guard.lock();
+        request.tries++;
+        if(ok) {
+            long latency = std::chrono::duration_cast<std::chrono::milliseconds>(now - request.queued).count();
+            stats.sent++;
+            stats.lastLatency = latency;
+            stats.maxLatency = std::max(stats.maxLatency, latency);
+            stats.totalLatency += latency;
+        } else if(request.tries < maxTries) {
+            stats.retried++;
+            // Queued again in the meantime? Then that one will do.
+            if(queuedUrls.insert(request.url).second) {
+                auto backoff = std::chrono::seconds(std::min(1 << (request.tries - 1), WEB_NOTIFY_MAX_BACKOFF));
+                requests.emplace(now + backoff, std::move(request));
+            }
+        } else {
+            stats.failed++;
+            std::clog << "WebNotifier: giving up on " << request.url << "\n";
+        }
+        stats.depth = requests.size();
+    }
+}
+
+//*********************************************************************
+//                      send
+//*********************************************************************
+
+bool WebNotifier::send(const Request& request) {
+    std::string_view url = request.url;
+
+    if(boost::istarts_with(url, "https://"))
+        return(sendWget(request));
+
+    if(boost::istarts_with(url, "http://"))
+        url.remove_prefix(7);
+
+    std::string_view hostPort = url.substr(0, url.find('/'));
+    std::string path = hostPort.length() < url.length() ? std::string(url.substr(hostPort.length())) : "/";
+    std::string host(hostPort), port = "80";
+
+    std::string::size_type colon = host.find(':');
+    if(colon != std::string::npos) {
+        port = host.substr(colon + 1);
+        host.erase(colon);
+    }
+    if(host.empty())
+        return(false);
+
+    return(sendHttp(host, port, path, request));
+}
+
+//*********************************************************************
+//                      sendHttp
+//*********************************************************************
+
+bool WebNotifier::sendHttp(const std::string& host, const std::string& port, const std::string& path, const Request& request) {
+    std::ostringstream oStr;
+    oStr << "GET " << path << " HTTP/1.1\r\n"
+         << "Host: " << host << (port != "80" ? ":" + port : "") << "\r\n"
+         << "User-Agent: " << (request.userAgent.empty() ? "RealmsCode" : request.userAgent) << "\r\n"
+         << "Connection: keep-alive\r\n\r\n";
+    std::string data = oStr.str();
+
+    // A kept-alive connection may have been closed by the webserver since we last used
+    // it; if the request never got through on it, try once more on a fresh connection.
+    for(int attempt = 0; attempt < 2; attempt++) {
+        bool reused = fd != -1 && host == connHost && port == connPort;
+        if(!reused && !connectTo(host, port))
+            return(false);
+
+        int status = 0;
+        received = 0;
+        closedByPeer = false;
+        bool written = writeAll(data);
+        if(written && readResponse(status)) {
+            if(status >= 200 && status < 400)
+                return(true);
+            std::clog << "WebNotifier: " << host << " returned " << status << " for " << path << "\n";
+            return(false);
+        }
+        disconnect();
+        // Once it's been written, the webserver may have acted on it: only a
+        // connection it hung up without answering is safe to send it on again.
+        // Anything else is left to the retries, so it isn't delivered twice.
+        if(!reused || (written && (!closedByPeer || received)))
+            break;
+    }
+    return(false);
+}
+
+//*********************************************************************
+//                      sendWget
+//*********************************************************************
+
+bool WebNotifier::sendWget(const Request& request) {
+    std::string url = request.url;
+    std::string agent = request.userAgent;
+    std::string wget = "wget", quiet = "-q", output = "-O", devNull = "/dev/null", agentFlag = "-U";
+
+    char* argv[] = { wget.data(), quiet.data(), output.data(), devNull.data(), url.data(),
+                     agent.empty() ? nullptr : agentFlag.data(), agent.data(), nullptr };
+    pid_t pid = 0;
+    if(posix_spawnp(&pid, "wget", nullptr, nullptr, argv, environ) != 0)
+        return(false);
+
+    // The server leaves SIGCHLD alone and only ever waits on its own children
+    // by pid, so this one's exit status is ours to collect
+    int status = 0;
+    while(waitpid(pid, &status, 0) == -1) {
+        if(errno != EINTR) {
+            std::clog << "WebNotifier: lost track of wget for " << request.url << "\n";
+            return(false);
+        }
+    }
+    return(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+//*********************************************************************
+//                      connectTo
+//*********************************************************************
+
+bool WebNotifier::connectTo(const std::string& host, const std::string& port) {
+    disconnect();
+
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) {
+        std::clog << "WebNotifier: unable to resolve " << host << "\n";
+        return(false);
+    }
+
+    for(addrinfo* ai = res; ai && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if(fd == -1)
+            continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        if(connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            int err = errno;
+            if(err == EINPROGRESS) {
+                pollfd pfd{fd, POLLOUT, 0};
+                socklen_t len = sizeof(err);
+                if(::poll(&pfd, 1, WEB_NOTIFY_TIMEOUT) != 1 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+                    err = ETIMEDOUT;
+            }
+            if(err != 0 && err != EINPROGRESS) {
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+    freeaddrinfo(res);
+
+    if(fd == -1) {
+        std::clog << "WebNotifier: unable to connect to " << host << ":" << port << "\n";
+        return(false);
+    }
+
+    connHost = host;
+    connPort = port;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.connects++;
+    }
+    return(true);
+}
+
+void WebNotifier::disconnect() {
+    if(fd != -1)
+        close(fd);
+    fd = -1;
+    connHost.clear();
+    connPort.clear();
+    readBuf.clear();
+}
+
+//*********************************************************************
+//                      writeAll
+//*********************************************************************
+
+bool WebNotifier::writeAll(const std::string& data) {
+    size_t done = 0;
+    while(done < data.length()) {
+        ssize_t n = ::send(fd, data.data() + done, data.length() - done, MSG_NOSIGNAL);
+        if(n > 0) {
+            done += n;
+            continue;
+        }
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd{fd, POLLOUT, 0};
+            if(::poll(&pfd, 1, WEB_NOTIFY_TIMEOUT) == 1)
+                continue;
+        }
+        return(false);
+    }
+    return(true);
+}
+
+//*********************************************************************
+//                      readMore
+//*********************************************************************
+
+bool WebNotifier::readMore() {
+    char buf[4096];
+    for(;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if(n > 0) {
+            readBuf.append(buf, n);
+            received += n;
+            return(true);
+        }
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd{fd, POLLIN, 0};
+            if(::poll(&pfd, 1, WEB_NOTIFY_TIMEOUT) == 1)
+                continue;
+        }
+        // Closed, timed out, or an error
+        closedByPeer = n == 0 || (n == -1 && errno == ECONNRESET);
+        return(false);
+    }
+}
+
+bool WebNotifier::readLine(std::string& line) {
+    std::string::size_type pos;
+    while((pos = readBuf.find("\r\n")) == std::string::npos) {
+        if(!readMore())
+            return(false);
+    }
+    line = readBuf.substr(0, pos);
+    readBuf.erase(0, pos + 2);
+    return(true);
+}
+
+bool WebNotifier::readBody(size_t length) {
+    while(readBuf.length() < length) {
+        if(!readMore())
+            return(false);
+    }
+    readBuf.erase(0, length);
+    return(true);
+}
+
+//*********************************************************************
+//                      readResponse
+//*********************************************************************
+// Reads the status line and skips past the rest of the response, so the
+// connection is ready for the next request.
+
+bool WebNotifier::readResponse(int& status) {
+    std::string line;
+    if(!readLine(line) || !boost::istarts_with(line, "HTTP/") || line.length() < 12)
+        return(false);
+    status = (int)strtol(line.c_str() + 9, nullptr, 10);
+
+    long contentLength = -1;
+    bool chunked = false, closeAfter = false;
+    for(;;) {
+        if(!readLine(line))
+            return(false);
+        if(line.empty())
+            break;
+        std::string::size_type colon = line.find(':');
+        if(colon == std::string::npos)
+            continue;
+        std::string name = boost::to_lower_copy(line.substr(0, colon));
+        std::string value = boost::to_lower_copy(line.substr(colon + 1));
+        boost::trim(value);
+        if(name == "content-length")
+            contentLength = strtol(value.c_str(), nullptr, 10);
+        else if(name == "transfer-encoding")
+            chunked = value.find("chunked") != std::string::npos;
+        else if(name == "connection")
+            closeAfter = value == "close";
+    }
+
+    bool ok = true;
+    if(status == 204 || status == 304 || (status >= 100 && status < 200)) {
+        // No body
+    } else if(chunked) {
+        for(;;) {
+            if(!readLine(line)) {
+                ok = false;
+                break;
+            }
+            size_t size = strtoul(line.c_str(), nullptr, 16);
+            if(size == 0) {
+                // Trailers, then a blank line
+                while((ok = readLine(line)) && !line.empty()) {}
+                break;
+            }
+            if(!readBody(size + 2)) {
+                ok = false;
+                break;
+            }
+        }
+    } else if(contentLength >= 0) {
+        ok = readBody(contentLength);
+    } else {
+        // Body runs until the webserver closes the connection
+        while(readMore())
+            readBuf.clear();
+        closeAfter = true;
+    }
+
+    if(!ok)
+        return(false);
+    if(closeAfter)
+        disconnect();
+    return(true);
+}
@@ -683,5 +683,16 @@ bool Config::loadSkills() {
         .group("craft")
         .gainType(SkillGainType::MEDIUM)
     , skills);
+
+    // Hand out dense ids so creatures can keep their skills in a flat table
+    int nextId = 0;
+    for(auto& [skillName, skillInfo] : skills) {
+        skillInfo.id = nextId++;
+        skillIds.emplace(skillInfo.getName(), skillInfo.id);
+    }
+    for(auto& [skillName, skillInfo] : skills) {
+        if(skillInfo.hasBaseSkill())
+            skillInfo.baseSkillId = getSkillId(skillInfo.getBaseSkill());
+    }
     return true;
 }
\ No newline at end of file
@@ -64,6 +64,12 @@ bool SkillInfo::isKnownOnly() const {
 bool SkillInfo::hasBaseSkill() const {
     return (!baseSkill.empty());
 }
+int SkillInfo::getId() const {
+    return (id);
+}
+int SkillInfo::getBaseSkillId() const {
+    return (baseSkillId);
+}
 
 bool Config::isKnownOnly(const std::string &skillName) const {
     auto it = skills.find(skillName);
@@ -280,8 +286,7 @@ bool Creature::knowsSkill(const std::string& skillName) const {
     if (skillName.empty())
         return (false);
 
-    std::map<std::string, Skill*>::const_iterator csIt;
-    return !((csIt = skills.find(skillName)) == skills.end());
+    return (getSkill(skillName, false) != nullptr);
 }
 
 //********************************************************************
@@ -293,6 +298,11 @@ Skill* Creature::getSkill(const std::string&  skillName, bool useBase) const {
     if (skillName.empty())
         return (nullptr);
 
+    int skillId = gConfig->getSkillId(skillName);
+    if (skillId != -1)
+        return (getSkillById(skillId, useBase));
+
+    // Skills that are no longer in the config aren't in the skill table
     auto csIt = skills.find(skillName);
     if (csIt == skills.end())
         return (nullptr);
@@ -310,6 +320,26 @@ Skill* Creature::getSkill(const std::string&  skillName, bool useBase) const {
     }
 }
 
+//********************************************************************
+//                      getSkillById
+//********************************************************************
+
+Skill* Creature::getSkillById(int skillId, bool useBase) const {
+    if (skillId < 0 || skillId >= (int)skillTable.size())
+        return (nullptr);
+
+    Skill* toReturn = skillTable[skillId];
+    if (toReturn && useBase) {
+        int baseSkillId = toReturn->getSkillInfo()->getBaseSkillId();
+        if (baseSkillId != -1) {
+            Skill* baseSkill = getSkillById(baseSkillId);
+            if (baseSkill)
+                return (baseSkill);
+        }
+    }
+    return (toReturn);
+}
+
 //*********************************************************************
 //                      setSkill
 //*********************************************************************
@@ -348,7 +378,7 @@ void Creature::addSkill(const std::string& skillName, int gained) {
         return;
 
     auto* skill = new Skill(skillName, gained);
-    skills[skillName] = skill;
+    insertSkill(skill);
 
     // Add any base skill we need as well
     const SkillInfo* skillInfo = skill->getSkillInfo();
@@ -373,10 +403,44 @@ void Creature::remSkill(const std::string& skillName) {
 
     if (!skill)
         return;
+    if (skill->getSkillInfo())
+        skillTable[skill->getSkillInfo()->getId()] = nullptr;
     delete skill;
     skills.erase(skillName);
 }
 
+//********************************************************************
+//                      insertSkill
+//********************************************************************
+// Takes ownership of the skill; fails and deletes it if the creature
+// already has a skill of that name
+
+bool Creature::insertSkill(Skill* skill) {
+    if (!skills.emplace(skill->getName(), skill).second) {
+        delete skill;
+        return (false);
+    }
+
+    const SkillInfo* skillInfo = skill->getSkillInfo();
+    if (skillInfo) {
+        if (skillInfo->getId() >= (int)skillTable.size())
+            skillTable.resize(gConfig->skills.size(), nullptr);
+        skillTable[skillInfo->getId()] = skill;
+    }
+    return (true);
+}
+
+//********************************************************************
+//                      clearSkills
+//********************************************************************
+
+void Creature::clearSkills() {
+    for (auto const& [skillName, skill] : skills)
+        delete skill;
+    skills.clear();
+    skillTable.clear();
+}
+
 #define SKILL_CHART_SIZE        21
 const char skillLevelStr[][SKILL_CHART_SIZE] = { "^rHorrible^x",          // 0-24
         "^rPoor^x",             // 25-49
@@ -811,7 +875,9 @@ void Config::clearSkills() {
 
     // Clear & delete skills
     skills.clear();
+    skillIds.clear();
     skillCommands.clear();
+    indexCommands();
 }
 
 //********************************************************************
@@ -833,6 +899,16 @@ const SkillInfo * Config::getSkill(const std::string &skillName) const {
     return it != skills.end() ? &((*it).second) : nullptr;
 }
 
+//********************************************************************
+//                      getSkillId
+//********************************************************************
+// Returns -1 if there's no such skill
+
+int Config::getSkillId(std::string_view skillName) const {
+    auto it = skillIds.find(skillName);
+    return it != skillIds.end() ? (*it).second : -1;
+}
+
 //********************************************************************
 //                      getSkillDisplayName
 //********************************************************************
@@ -19,10 +19,12 @@
 #include <fmt/format.h>                             // for format
 #include <unistd.h>                                 // for getpid
 #include <boost/lexical_cast/bad_lexical_cast.hpp>  // for bad_lexical_cast
+#include <algorithm>                                // for sort
 #include <cctype>                                   // for tolower
 #include <cstdio>                                   // for sprintf
 #include <cstring>                                  // for strcmp, strlen
 #include <ctime>                                    // for time
+#include <fstream>                                  // for ofstream
 #include <iomanip>                                  // for operator<<, setw
 #include <list>                                     // for list, operator==
 #include <locale>                                   // for locale
@@ -32,6 +34,7 @@
 #include <string>                                   // for string, allocator
 #include <type_traits>                              // for add_const<>::type
 #include <utility>                                  // for pair
+#include <vector>                                   // for vector, erase_if
 
 #include "area.hpp"                                 // for MapMarker, Area
 #include "carry.hpp"                                // for Carry
@@ -44,6 +47,7 @@
 #include "dm.hpp"                                   // for stat_rom, dmLastC...
 #include "flags.hpp"                                // for P_DM_INVIS, P_OUTLAW
 #include "global.hpp"                               // for CreatureClass
+#include "goldLog.hpp"                              // for GoldLogWriter
 #include "lasttime.hpp"                             // for crlasttime, lasttime
 #include "location.hpp"                             // for Location
 #include "magic.hpp"                                // for S_ANNUL_MAGIC
@@ -59,12 +63,14 @@
 #include "oldquest.hpp"                             // for quest, questPtr
 #include "os.hpp"                                   // for merror
 #include "paths.hpp"                                // for Log, BuilderHelp
+#include "profiler.hpp"                             // for Profiler, PROFILE_TRACE_FRAMES
 #include "proto.hpp"                                // for get_spell_name
 #include "quests.hpp"                               // for QuestInfo
 #include "random.hpp"                               // for Random
 #include "server.hpp"                               // for Server, gServer
 #include "socket.hpp"                               // for Socket, OutBytes
 #include "stats.hpp"                                // for Stat
+#include "structs.hpp"                              // for Command, CommandStats
 #include "toNum.hpp"                                // for toNum
 #include "track.hpp"                                // for Track
 #include "utils.hpp"                                // for MAX
@@ -185,7 +191,14 @@ int dmSockets(Player* player, cmd* cmnd) {
 
     for(Socket &sock : gServer->sockets) {
         num += 1;
-        player->bPrint(fmt::format("Fd: {:-2}   {} ({})\n", sock.getFd(), sock.getHostname(), sock.getIdle()));
+        const Socket::InputStats& stats = sock.getInputStats();
+        player->bPrint(fmt::format("Fd: {:-2}   {} ({})   Queue: {} (peak {})   Cmds: {}   Wait: {}ms avg, {}ms max\n",
+            sock.getFd(), sock.getHostname(), sock.getIdle(), sock.getInputDepth(), stats.peakDepth, stats.commands,
+            stats.commands ? stats.totalWait / (long)stats.commands : 0, stats.maxWait));
+        const Socket::MsdpStats& msdp = sock.getMsdpStats();
+        if(msdp.checked)
+            player->bPrint(fmt::format("        MSDP: {} checked, {} worked out, {} sent ({} bytes)\n",
+                msdp.checked, msdp.computed, msdp.sent, msdp.bytes));
     }
     player->print("%d total connection%s.\n", num, num != 1 ? "s" : "");
     return(PROMPT);
@@ -1158,6 +1171,12 @@ int dmGameStatus(Player* player, cmd* cmnd) {
 #ifdef SQL_LOGGER
      player->printColor("^CSQL Logger Connection: %s  Timeout: %d\n", (gServer->getConnStatus() == true ? "Active" : "Inactive"), gServer->getConnTimeout());
 #endif // SQL_LOGGER
+    if(const GoldLogWriter* goldLog = gServer->getGoldLog()) {
+        GoldLogWriter::Stats stats = goldLog->getStats();
+        player->printColor("^CGold Log: %s  Queued: %lu  Flushed: %lu (%lu batches)  Journaled: %lu  Spilled: %lu  Replayed: %lu  Dropped: %lu  Pending: %zu\n",
+            stats.connected ? "Connected" : "Journaling", stats.queued, stats.flushed, stats.batches,
+            stats.journaled, stats.spilled, stats.replayed, stats.dropped, stats.pending);
+    }
 
     player->printColor("\n^cDMs here are: ");
     strcpy(buf,"");
@@ -2179,10 +2198,16 @@ int dmInfo(Player* player, cmd* cmnd) {
     else
         player->print("Uptime: %ld days %02ld:%02ld:%02ld\n", days, hours, minutes, (t - StartTime) % 60L);
     player->print("\n    Bytes in:  %9ld\n    Bytes out: %9ld(%ld)[%f]\n", InBytes, OutBytes, UnCompressedBytes, (OutBytes*1.0)/(UnCompressedBytes*1.0));
+    for(Socket &sock : gServer->sockets) {
+        if(sock.hasCompressor())
+            player->bPrint(fmt::format("    Fd {:<3} {:<15} {}\n", sock.getFd(),
+                sock.getPlayer() ? sock.getPlayer()->getName() : sock.getIp(), sock.getCompressInfo()));
+    }
     player->print("\nInternal Cache Queue Sizes:\n");
     player->print("   Rooms: %-5d   Monsters: %-5d   Objects: %-5d\n\n",
             gServer->roomCache.size(), gServer->monsterCache.size(), gServer->objectCache.size());
     player->print("Wander update: %d\n", Random_update_interval);
+    player->print("%s", gServer->getFrameStats().c_str());
     if(player->isDm())
         player->print("      Players: %d\n\n", Socket::getNumSockets());
 
@@ -2192,6 +2217,94 @@ int dmInfo(Player* player, cmd* cmnd) {
     return(0);
 }
 
+//*********************************************************************
+//                      dmProfile
+//*********************************************************************
+
+int dmProfile(Player* player, cmd* cmnd) {
+    Profiler& profiler = gServer->getProfiler();
+
+    if(cmnd->num < 2) {
+        player->print("%s", profiler.getReport().c_str());
+        player->print("Also: *profile slow, *profile trace, *profile reset\n");
+    } else if(!strcmp(cmnd->str[1], "slow")) {
+        player->print("%s", profiler.getSlowFrames().c_str());
+    } else if(!strcmp(cmnd->str[1], "trace")) {
+        std::string filename = fmt::format("{}/profile.{}.json", Path::Log, time(nullptr));
+        if(profiler.writeTrace(filename))
+            player->print("Trace of the last %d frames written to %s.\n", PROFILE_TRACE_FRAMES, filename.c_str());
+        else
+            player->print("Unable to write %s.\n", filename.c_str());
+    } else if(!strcmp(cmnd->str[1], "reset")) {
+        profiler.reset();
+        player->print("Profiler reset.\n");
+    } else {
+        player->print("Syntax: *profile [slow|trace|reset]\n");
+    }
+    return(0);
+}
+
+//*********************************************************************
+//                      dmCmdStats
+//*********************************************************************
+// Which commands cost us the most, in time or memory
+
+int dmCmdStats(Player* player, cmd* cmnd) {
+    std::vector<const Command*> commands = gConfig->getCommandList();
+    std::string how = cmnd->num > 1 ? cmnd->str[1] : "time";
+
+    if(how == "reset") {
+        for(const Command* command : commands)
+            command->stats = CommandStats();
+        player->print("Command stats reset.\n");
+        return(0);
+    }
+
+    std::erase_if(commands, [](const Command* command) { return(!command->stats.calls); });
+
+    if(how == "csv") {
+        std::string filename = fmt::format("{}/cmdstats.{}.csv", Path::Log, time(nullptr));
+        std::ofstream out(filename);
+        out << "command,calls,total_us,avg_us,max_us,bytes,allocations\n";
+        for(const Command* command : commands) {
+            const CommandStats& stats = command->stats;
+            out << fmt::format("{},{},{},{},{},{},{}\n", command->getName(), stats.calls, stats.totalTime,
+                stats.totalTime / (long)stats.calls, stats.maxTime, stats.bytes, stats.allocations);
+        }
+        if(out.good())
+            player->print("%d commands written to %s.\n", (int)commands.size(), filename.c_str());
+        else
+            player->print("Unable to write %s.\n", filename.c_str());
+        return(0);
+    }
+
+    if(how == "bytes") {
+        std::sort(commands.begin(), commands.end(), [](const Command* a, const Command* b) { return(a->stats.bytes > b->stats.bytes); });
+    } else if(how == "calls") {
+        std::sort(commands.begin(), commands.end(), [](const Command* a, const Command* b) { return(a->stats.calls > b->stats.calls); });
+    } else if(how == "time") {
+        std::sort(commands.begin(), commands.end(), [](const Command* a, const Command* b) { return(a->stats.totalTime > b->stats.totalTime); });
+    } else {
+        player->print("Syntax: *cmdstats [time|bytes|calls|csv|reset]\n");
+        return(0);
+    }
+
+    std::ostringstream oStr;
+    oStr << fmt::format("{:<16} {:>8} {:>10} {:>8} {:>8} {:>10} {:>7}\n", "Command", "Calls", "Total ms", "Avg us", "Max us", "Bytes/call", "Allocs");
+    int shown = 0;
+    for(const Command* command : commands) {
+        const CommandStats& stats = command->stats;
+        oStr << fmt::format("{:<16} {:>8} {:>10.1f} {:>8} {:>8} {:>10} {:>7}\n", command->getName(), stats.calls,
+            stats.totalTime / 1000.0, stats.totalTime / (long)stats.calls, stats.maxTime,
+            stats.bytes / stats.calls, stats.allocations / stats.calls);
+        if(++shown == 40)
+            break;
+    }
+    oStr << fmt::format("{} command{} run since the last reset.\n", commands.size(), commands.size() == 1 ? "" : "s");
+    player->print("%s", oStr.str().c_str());
+    return(0);
+}
+
 int dmMd5(Player* player, cmd* cmnd) {
     std::string tohash = getFullstrText(cmnd->fullstr, 1, ' ');
     player->print("MD5: '%s' = '%s'\n", tohash.c_str(), md5(tohash).c_str());
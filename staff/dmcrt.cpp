@@ -2266,12 +2266,14 @@ int dmCrtName(Player* player, cmd* cmnd) {
         if(num) {
             if(text == "0" && target->key[num-1][0]) {
                 zero(target->key[num-1], sizeof(target->key[num-1]));
+                target->keysChanged();
                 player->print("Key #%d string cleared.\n", num);
                 return(0);
             } else {
                 if(text.length() > 19)
                     text = text.substr(0, 19);
                 strcpy(target->key[num-1], text.c_str());
+                target->keysChanged();
                 player->print("\nKey ");
                 strcpy(modstr, "desc key");
             }
@@ -1438,12 +1438,14 @@ int dmObjName(Player* player, cmd* cmnd) {
         if(num) {
             if(text == "0" && object->key[num-1][0]) {
                 zero(object->key[num-1], sizeof(object->key[num-1]));
+                object->keysChanged();
                 player->print("Key #%d string cleared.\n", num);
                 return(0);
             } else {
                 if(text.length() > OBJ_KEY_LENGTH-1)
                     text = text.substr(0, OBJ_KEY_LENGTH-1);
                 strcpy(object->key[num-1], text.c_str());
+                object->keysChanged();
                 player->print("\nKey ");
             }
         }
@@ -0,0 +1,180 @@
+/*
+ * banTest.cpp
+ *   BanMatcher finds the same ban Ban::matches would, first in the list, for every wildcard form
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <algorithm>            // for min
+#include <iostream>             // for cout, cerr
+#include <list>                 // for list
+#include <random>               // for mt19937
+#include <string>               // for string
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "bans.hpp"             // for Ban, BanMatcher
+#include "check.hpp"            // for CHECK, CHECK_EQ
+
+#define TEST_LISTS          50
+#define TEST_BANS           100     // In each list
+#define TEST_LOOKUPS        20000   // Against each list
+
+// What hosts and addresses are made of; few enough pieces that bans and
+// connections often share a prefix, a suffix or something in the middle
+static const char* siteParts[] = {
+    "1", "10", "127", "203", "0", "255", ".", ".", ".", "-", ":",
+    "dsl", "host", "example", "net", "com", "org", "a", "b", "Mud", "cable", "pool",
+    "42", "7", "88", "192", "168", "fe80", "2001", "db8", "::1", "static", "dyn",
+};
+
+static std::string randomSite(std::mt19937& rng) {
+    std::string site;
+    int count = 3 + rng() % 6;
+    for(int i = 0; i < count; i++)
+        site += siteParts[rng() % (sizeof(siteParts) / sizeof(siteParts[0]))];
+    return(site);
+}
+
+// A piece of a site someone's connected from, or just something made up
+static Ban* randomBan(std::mt19937& rng, const std::vector<std::string>& seen) {
+    auto* ban = new Ban();
+    std::string from = !seen.empty() && rng() % 4 ? seen[rng() % seen.size()] : randomSite(rng);
+    // Mostly long enough not to ban half the world; now and then nothing at all
+    size_t length = std::min(from.size(), 6 + rng() % from.size());
+    if(rng() % 2000 == 0)
+        length = 0;
+    size_t start = rng() % (from.size() - length + 1);
+
+    switch(rng() % 10) {
+        case 0:     // Everyone, now and then
+            if(rng() % 400 == 0) {
+                ban->site = "*";
+                if(rng() % 2)
+                    ban->isPrefix = ban->isSuffix = true;
+                break;
+            }
+            [[fallthrough]];
+        case 1:
+        case 2:     // "site*"
+            ban->site = from.substr(0, length);
+            ban->isPrefix = true;
+            break;
+        case 3:
+        case 4:     // "*site"
+            ban->site = from.substr(from.size() - length);
+            ban->isSuffix = true;
+            break;
+        case 5:
+        case 6:     // "*site*"
+            ban->site = from.substr(start, length);
+            ban->isPrefix = ban->isSuffix = true;
+            break;
+        default:    // Exactly this site
+            ban->site = rng() % 5 ? from : from.substr(start, length);
+            break;
+    }
+    return(ban);
+}
+
+// The way the list was checked before: first ban that matches
+static Ban* scan(const std::list<Ban*>& bans, const std::string& host, const std::string& ip) {
+    for(Ban* ban : bans) {
+        if(ban->matches(host) || ban->matches(ip))
+            return(ban);
+    }
+    return(nullptr);
+}
+
+static std::string describe(const Ban* ban) {
+    if(!ban)
+        return("nothing");
+    return(fmt::format("{}{}{}", ban->isSuffix ? "*" : "", ban->site, ban->isPrefix ? "*" : ""));
+}
+
+//*********************************************************************
+//                      wildcards
+//*********************************************************************
+
+static void wildcards() {
+    std::mt19937 rng(48);
+    unsigned long lookups = 0, banned = 0, differ = 0;
+    for(int list = 0; list < TEST_LISTS; list++) {
+        std::vector<std::string> seen;
+        for(int i = 0; i < 1000; i++)
+            seen.push_back(randomSite(rng));
+
+        std::list<Ban*> bans;
+        for(int i = 0; i < TEST_BANS; i++)
+            bans.push_back(randomBan(rng, seen));
+        BanMatcher matcher(bans);
+
+        for(int i = 0; i < TEST_LOOKUPS; i++) {
+            std::string host = rng() % 2 ? seen[rng() % seen.size()] : randomSite(rng);
+            std::string ip = rng() % 2 ? seen[rng() % seen.size()] : randomSite(rng);
+            Ban* expected = scan(bans, host, ip);
+            Ban* found = matcher.find(host, ip);
+            Ban* hostOnly = matcher.find(host);
+            Ban* expectedHost = scan(bans, host, host);
+            if(found != expected || hostOnly != expectedHost) {
+                if(differ < 10)
+                    std::cerr << fmt::format("host \"{}\" ip \"{}\": expected {} / {}, found {} / {}\n", host, ip,
+                        describe(expected), describe(expectedHost), describe(found), describe(hostOnly));
+                differ++;
+            }
+            lookups++;
+            if(expected)
+                banned++;
+        }
+        for(Ban* ban : bans)
+            delete ban;
+    }
+    std::cout << fmt::format("{} lookups, {} banned\n", lookups, banned);
+    CHECK(banned > lookups / 10);
+    CHECK(banned < lookups - lookups / 10);
+    CHECK_EQ(differ, 0UL);
+}
+
+//*********************************************************************
+//                      cidr
+//*********************************************************************
+// The one thing Ban::matches never did: an exact ban written as a block
+// covers every address in it, and still matches itself as typed
+
+static void cidr() {
+    std::list<Ban*> bans;
+    for(const char* site : {"10.1.0.0/16", "2001:db8::/32", "192.0.2.7"}) {
+        auto* ban = new Ban();
+        ban->site = site;
+        bans.push_back(ban);
+    }
+    BanMatcher matcher(bans);
+    CHECK(matcher.find("10.1.200.3") == bans.front());
+    CHECK(matcher.find("::ffff:10.1.0.1") == bans.front());
+    CHECK(matcher.find("10.1.0.0/16") == bans.front());
+    CHECK(matcher.find("10.2.0.1") == nullptr);
+    CHECK(matcher.find("2001:db8:5::1") == *std::next(bans.begin()));
+    CHECK(matcher.find("2001:db9::1") == nullptr);
+    CHECK(matcher.find("192.0.2.7") == bans.back());
+    CHECK(matcher.find("192.0.2.8") == nullptr);
+    for(Ban* ban : bans)
+        delete ban;
+}
+
+int main() {
+    wildcards();
+    cidr();
+    return(checkResult());
+}
@@ -0,0 +1,261 @@
+/*
+ * channelTest.cpp
+ *   Channel messages reach the same people, with the same text, in the same order as a full scan
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <algorithm>            // for is_sorted
+#include <iostream>             // for cerr
+#include <string>               // for string
+#include <vector>               // for vector
+
+#include <boost/algorithm/string/predicate.hpp>  // for icontains
+#include <boost/algorithm/string/replace.hpp>    // for replace_all
+#include <fmt/format.h>         // for format
+
+#include "channelIndex.hpp"     // for ChannelIndex, ChannelListener
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "communication.hpp"    // for sendGlobalComm, getChannelByName, mxpTag
+#include "config.hpp"           // for Config, gConfig
+#include "creatureStreams.hpp"  // for ColorOn, ColorOff
+#include "flags.hpp"            // for P_IGNORE_GOSSIP, P_EAVESDROPPER
+#include "login.hpp"            // for CON_PLAYING, CON_DISCONNECTING
+#include "mudObjects/players.hpp"       // for Player
+#include "proto.hpp"            // for watchingEaves, get_language_adj
+#include "server.hpp"           // for Server, gServer
+#include "socket.hpp"           // for Socket
+
+#define TEST_PLAYERS        60
+
+// A socket whose output the test can take
+class TestSocket : public Socket {
+public:
+    using Socket::Socket;
+    void setTermType(const std::string& type) { term.type = type; }
+    std::string take() {
+        std::string text;
+        text.swap(output);
+        return(text);
+    }
+};
+
+//*********************************************************************
+//                      scanGlobalComm
+//*********************************************************************
+// sendGlobalComm as it was before the subscriber sets: every player online
+// in gServer->players order, every rule checked for each one
+
+static void scanGlobalComm(const Player *player, const std::string &text, const std::string &extra, unsigned int check,
+                    const channelInfo *chan, const std::string &etxt, const std::string &oocName, const std::string &icName) {
+    // more complicated checks go here
+    Socket* sock=nullptr;
+    for(const auto& [pId, ply] : gServer->players) {
+        sock = ply->getSock();
+        if(!sock->isConnected())
+            continue;
+
+        // no gagging staff!
+        if(player && ply->isGagging(player->getName()) && !player->isCt())
+            continue;
+        // deaf people can always hear staff and themselves
+        if(ply->isEffected("deafness") && player && !player->isStaff() && ply != player)
+            continue;
+
+        // must satisfy all the basic canHear rules to hear this channel
+        if( (   (!chan->canHear || chan->canHear(sock)) &&
+                (!chan->flag || ply->flagIsSet(chan->flag)) &&
+                (!chan->not_flag || !ply->flagIsSet(chan->not_flag)) )
+            && ( // they must also satisfy any special conditions here
+                (chan->type != COM_CLASS || static_cast<int>(ply->getClass()) == check) &&
+                (chan->type != COM_RACE || ply->getDisplayRace() == check) &&
+                (chan->type != COM_CLAN || (ply->getDeity() ? ply->getDeityClan() : ply->getClan()) == check) ) )
+        {
+            if(!extra.empty())
+                *ply << ColorOn << ply->customColorize(chan->color) << extra << ColorOff;
+
+            std::string toPrint = chan->displayFmt;
+            std::string prompt;
+
+            if(boost::icontains(ply->getSock()->getTermType(), "MUDLET"))
+                prompt = " PROMPT";
+
+            std::string oocNameRep;
+            std::string icNameRep;
+
+            if(player) {
+                icNameRep = mxpTag(std::string("player name='") + player->getName() + "'" + prompt) + icName + mxpTag("/player");
+                oocNameRep = mxpTag(std::string("player name='") + player->getName() + "'" + prompt) + oocName + mxpTag("/player");
+            } else {
+                icNameRep = icName;
+                oocNameRep = oocName;
+            }
+            boost::replace_all(toPrint, "*IC-NAME*", icNameRep);
+            boost::replace_all(toPrint, "*OOC-NAME*", oocNameRep);
+
+            if(ply->isStaff() || !player
+                || (player->current_language && ply->isEffected("comprehend-languages"))
+                || ply->languageIsKnown(player->current_language))
+            {
+                boost::replace_all(toPrint, "*TEXT*", text);
+            } else {
+                boost::replace_all(toPrint, "*TEXT*", "<something incomprehensible>");
+            }
+
+            if(player && player->current_language != LCOMMON)
+                toPrint += std::string(" in ") + get_language_adj(player->current_language) + ".";
+
+            *ply << ColorOn << ply->customColorize(chan->color) << toPrint << "\n" << ColorOff;
+        }
+
+        // even if they fail the check, it might still show up on eaves
+        if( chan->eaves && watchingEaves(sock) &&
+            !(chan->type == COM_CLASS && check == static_cast<int>(CreatureClass::DUNGEONMASTER))) {
+            ply->printColor("^E%s", etxt.c_str());
+        }
+    }
+}
+
+static std::vector<TestSocket*> sockets;
+
+static std::vector<std::string> takeAll() {
+    std::vector<std::string> out;
+    for(TestSocket* sock : sockets)
+        out.push_back(sock->take());
+    return(out);
+}
+
+//*********************************************************************
+//                      compare
+//*********************************************************************
+// Sends one message both ways and checks every player got the same bytes,
+// and that the subscriber set is walked in gServer->players order
+
+static void compare(const char* chanName, const Player* speaker, const std::string& extra, unsigned int check) {
+    const channelInfo* chan = getChannelByName(nullptr, chanName);
+    CHECK(chan != nullptr);
+    if(!chan)
+        return;
+    std::string name = speaker ? speaker->getName() : "Discorduser";
+    std::string etxt = fmt::format("{} sent {}: \"is anyone about?\"\n", name, chanName);
+
+    takeAll();
+    scanGlobalComm(speaker, "is anyone about?", extra, check, chan, etxt, name, name);
+    std::vector<std::string> expected = takeAll();
+    sendGlobalComm(speaker, "is anyone about?", extra, check, chan, etxt, name, name);
+    std::vector<std::string> actual = takeAll();
+
+    size_t heard = 0, differ = 0;
+    for(size_t i = 0; i < sockets.size(); i++) {
+        if(!expected[i].empty())
+            heard++;
+        if(expected[i] != actual[i]) {
+            std::cerr << chanName << " to " << sockets[i]->getPlayer()->getName() << ":\n  expected \""
+                      << expected[i] << "\"\n  got      \"" << actual[i] << "\"\n";
+            differ++;
+        }
+    }
+    CHECK(heard > 0);
+    CHECK_EQ(differ, 0UL);
+
+    std::vector<std::string> order;
+    for(ChannelListener* listener : gServer->channels.getListeners(chan))
+        order.push_back(listener->getName());
+    std::vector<std::string> online;
+    for(const auto& [playerName, ply] : gServer->players) {
+        for(ChannelListener* listener : gServer->channels.getListeners(chan)) {
+            if(listener->getPlayer() == ply)
+                online.push_back(playerName);
+        }
+    }
+    CHECK(std::is_sorted(order.begin(), order.end()));
+    CHECK(order == online);
+}
+
+int main() {
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+
+    // Made in a different order from their names, so memory order isn't name order
+    std::vector<Player*> players(TEST_PLAYERS);
+    for(int n = 0; n < TEST_PLAYERS; n++) {
+        int i = (n * 37) % TEST_PLAYERS;
+        auto* sock = new TestSocket(-1);
+        auto* ply = new Player;
+        ply->fd = -1;
+        ply->setName(fmt::format("Chan{}{}", static_cast<char>('a' + (i * 7) % 26), i));
+        ply->setId(fmt::format("P{}", 1000 + i));
+        ply->setLevel(1 + i % 30);
+        ply->setClass(i % 10 == 0 ? CreatureClass::DUNGEONMASTER :
+                      i % 10 == 1 ? CreatureClass::CARETAKER :
+                      i % 3 ? CreatureClass::FIGHTER : CreatureClass::MAGE);
+        ply->setClan(i % 4);
+        if(i % 5 == 0)
+            ply->setFlag(P_IGNORE_GOSSIP);
+        if(i % 6 == 0)
+            ply->setFlag(P_IGNORE_CLASS_SEND);
+        if(i % 10 <= 1 && i % 20 < 10)
+            ply->setFlag(P_EAVESDROPPER);
+        if(i % 4 == 0)
+            ply->learnLanguage(LDWARVEN);
+        ply->learnLanguage(LCOMMON);
+        if(i % 8 == 3)
+            sock->setTermType("Mudlet");
+        ply->setSock(sock);
+        sock->setPlayer(ply);
+        sock->setState(i % 11 == 7 ? CON_DISCONNECTING : CON_PLAYING);
+        gServer->addPlayer(ply);
+        players[i] = ply;
+    }
+    // One socket each, in gServer->players order
+    for(const auto& [playerName, ply] : gServer->players)
+        sockets.push_back(static_cast<TestSocket*>(ply->getSock()));
+
+    Player* fighter = players[2];
+    Player* dwarf = players[4];
+    dwarf->current_language = LDWARVEN;
+    Player* staff = players[1];
+    for(int i = 0; i < TEST_PLAYERS; i += 9)
+        players[i]->addGagging(fighter->getName());
+
+    compare("gossip", fighter, "", 0);
+    compare("gossip", dwarf, "", 0);
+    compare("gossip", staff, "", 0);
+    compare("gossip", nullptr, "", 0);
+    compare("broadcast", fighter, "^Y*** Broadcast ***\n", 0);
+    compare("newbie", fighter, "", 0);
+    compare("cls", fighter, "", static_cast<int>(CreatureClass::FIGHTER));
+    compare("cls", staff, "", static_cast<int>(CreatureClass::DUNGEONMASTER));
+    compare("clansend", dwarf, "", 1);
+    compare("dm", staff, "", 0);
+    compare("*s", staff, "", 0);
+
+    // Flags and connections change while they're online
+    players[5]->clearFlag(P_IGNORE_GOSSIP);
+    players[6]->setFlag(P_IGNORE_GOSSIP);
+    players[8]->getSock()->setState(CON_DISCONNECTING);
+    players[7]->getSock()->setState(CON_PLAYING);
+    players[12]->setClass(CreatureClass::CARETAKER);
+    players[12]->setFlag(P_EAVESDROPPER);
+    compare("gossip", fighter, "", 0);
+    compare("cls", fighter, "", static_cast<int>(CreatureClass::FIGHTER));
+
+    // Someone leaves and someone comes back with a new name
+    gServer->clearPlayer(players[3]);
+    gServer->clearPlayer(players[13]->getName());
+    players[13]->setName("Aardvark");
+    gServer->addPlayer(players[13]);
+    compare("gossip", fighter, "", 0);
+    return(checkResult());
+}
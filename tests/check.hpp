@@ -0,0 +1,52 @@
+/*
+ * check.hpp
+ *   The little there is to a test program: checks that count their failures
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <iostream>     // for cerr
+
+// Each test is its own program, run by ctest; it carries on past a failed
+// check so one run shows everything that's wrong, and main returns
+// checkResult().
+inline int checkFailures = 0;
+
+#define CHECK(cond) do { \
+        if(!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << "\n"; \
+            checkFailures++; \
+        } \
+    } while(0)
+
+#define CHECK_EQ(a, b) do { \
+        auto checkA = (a); \
+        auto checkB = (b); \
+        if(!(checkA == checkB)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #a << " == " << #b \
+                      << " (" << checkA << " vs " << checkB << ")\n"; \
+            checkFailures++; \
+        } \
+    } while(0)
+
+inline int checkResult() {
+    if(checkFailures)
+        std::cerr << checkFailures << " check(s) failed\n";
+    return(checkFailures ? 1 : 0);
+}
+
+#endif /*CHECK_H_*/
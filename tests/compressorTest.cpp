@@ -0,0 +1,193 @@
+/*
+ * compressorTest.cpp
+ *   What CompressStream sends inflates back to exactly what the game wrote
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <zlib.h>               // for inflate, z_stream
+#include <memory>               // for make_shared
+#include <random>               // for mt19937
+#include <string>               // for string
+
+#include "async.hpp"            // for AsyncPool
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "compressor.hpp"       // for CompressStream, CompressProfile
+
+#define TEST_FRAMES         10000
+#define TEST_RESTART_EVERY  1000    // Frames between the stream being finished and started again
+
+// IAC SB COMPRESS2 IAC SE: what the socket sends before each new stream
+static const std::string startSequence = "\xff\xfa\x56\xff\xf0";
+
+static const CompressProfile quiet{6, 10, 4};
+static const CompressProfile busy{6, 15, 8};
+
+// A frame of output the way the game writes it: room text, combat spam,
+// prompts, the odd telnet sequence and now and then a big help page
+static std::string makeFrame(std::mt19937& rng) {
+    static const char* lines[] = {
+        "^gYou see ^Ya golden chalice^g here.^x\r\n",
+        "^rThe goblin^x hits you for ^R12^x damage!\r\n",
+        "^cObvious exits: ^Wnorth, south, east, west^x.\r\n",
+        "Benchbota gossips, \"anyone selling a short sword?\"\r\n",
+        "\xff\xfa\x45\x01HEALTH\x02" "153\xff\xf0",
+        "(153H 20M): ",
+    };
+    std::string frame;
+    int count = rng() % 8;
+    for(int i = 0; i < count; i++)
+        frame += lines[rng() % (sizeof(lines) / sizeof(lines[0]))];
+    if(rng() % 100 == 0) {
+        // Something that doesn't compress at all
+        int size = 1000 + rng() % 20000;
+        for(int i = 0; i < size; i++)
+            frame += static_cast<char>(rng());
+    }
+    return(frame);
+}
+
+// What a client does: raw bytes until the start sequence, then inflate
+// until the stream ends, then raw bytes again
+class Client {
+public:
+    ~Client() {
+        if(inflating)
+            inflateEnd(&zs);
+    }
+
+    void receive(const std::string& bytes) {
+        pending += bytes;
+        while(!pending.empty() && !broken) {
+            if(!inflating) {
+                size_t start = pending.find(startSequence);
+                if(start == std::string::npos) {
+                    // Keep what might be the beginning of one
+                    size_t keep = std::min(pending.size(), startSequence.size() - 1);
+                    text += pending.substr(0, pending.size() - keep);
+                    pending.erase(0, pending.size() - keep);
+                    return;
+                }
+                text += pending.substr(0, start);
+                pending.erase(0, start + startSequence.size());
+                zs = z_stream{};
+                if(inflateInit(&zs) != Z_OK) {
+                    broken = true;
+                    return;
+                }
+                inflating = true;
+                streams++;
+                continue;
+            }
+
+            unsigned char buf[16384];
+            zs.next_in = (Bytef*)pending.data();
+            zs.avail_in = pending.size();
+            int ret;
+            do {
+                zs.next_out = buf;
+                zs.avail_out = sizeof(buf);
+                ret = inflate(&zs, Z_SYNC_FLUSH);
+                if(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                    broken = true;
+                    return;
+                }
+                text.append((char*)buf, sizeof(buf) - zs.avail_out);
+            } while(zs.avail_out == 0 && ret != Z_STREAM_END);
+            pending.erase(0, pending.size() - zs.avail_in);
+
+            if(ret != Z_STREAM_END)
+                return;
+            inflateEnd(&zs);
+            inflating = false;
+        }
+    }
+
+    void flushRaw() {
+        if(!inflating) {
+            text += pending;
+            pending.clear();
+        }
+    }
+
+    std::string text;
+    int streams = 0;
+    bool inflating = false;
+    bool broken = false;
+
+private:
+    std::string pending;
+    z_stream zs{};
+};
+
+//*********************************************************************
+//                      roundTrip
+//*********************************************************************
+// Runs every frame through one stream, taking what's ready after each one
+// the way the main loop does, and checks the client gets it all back
+
+static void roundTrip(AsyncPool* pool) {
+    std::mt19937 rng(1);
+    auto stream = std::make_shared<CompressStream>(pool);
+    Client client;
+    std::string sent;
+    unsigned long compressed = 0;
+
+    sent += "Welcome!\r\n";
+    stream->raw("Welcome!\r\n");
+    stream->raw(startSequence);
+    stream->start(quiet);
+    for(int frame = 0; frame < TEST_FRAMES; frame++) {
+        if(frame && frame % TEST_RESTART_EVERY == 0) {
+            // Switching profiles: end this stream, then start the next one
+            stream->finish();
+            std::string between = "\r\n";
+            sent += between;
+            stream->raw(between);
+            stream->raw(startSequence);
+            stream->start(frame / TEST_RESTART_EVERY % 2 ? busy : quiet);
+        }
+        std::string text = makeFrame(rng);
+        sent += text;
+        compressed += text.size();
+        if(!text.empty())
+            stream->compress(text);
+        client.receive(stream->take());
+    }
+    stream->finish();
+    stream->wait();
+    client.receive(stream->take());
+    client.flushRaw();
+
+    CHECK(!stream->failed());
+    CHECK(!client.broken);
+    CHECK(!client.inflating);
+    CHECK_EQ(client.streams, TEST_FRAMES / TEST_RESTART_EVERY);
+    CHECK_EQ(client.text.size(), sent.size());
+    CHECK(client.text == sent);
+    CHECK_EQ(stream->getBytesIn(), compressed);
+    CHECK_EQ(stream->getMemory(), 0UL);
+}
+
+int main() {
+    // Deflated as it's queued
+    roundTrip(nullptr);
+
+    // Deflated on the pool's threads while the frames keep coming
+    {
+        AsyncPool pool(2);
+        roundTrip(&pool);
+    }
+    return(checkResult());
+}
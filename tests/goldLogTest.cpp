@@ -0,0 +1,130 @@
+/*
+ * goldLogTest.cpp
+ *   Every gold event reaches the sink once, in the order it was posted, even when we fall behind
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <stdlib.h>             // for mkdtemp
+#include <atomic>               // for atomic
+#include <chrono>               // for milliseconds
+#include <filesystem>           // for remove_all
+#include <fstream>              // for ifstream
+#include <iostream>             // for cout
+#include <memory>               // for make_unique
+#include <string>               // for string
+#include <thread>               // for sleep_for
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "goldLog.hpp"          // for GoldLogWriter, FileGoldSink
+
+#define TEST_EVENTS         (GOLDLOG_QUEUE * 4)
+#define TEST_BURST          1000    // Events the game posts between frames
+#define TEST_CONNECT_MS     100     // Long enough for the game to fill the queue
+#define TEST_INSERT_MS      2
+
+// A file sink that can be held down, and that takes its time when it's up
+class TestSink : public FileGoldSink {
+public:
+    TestSink(std::string pPath, std::atomic<bool>& pUp): FileGoldSink(std::move(pPath)), up(pUp) {}
+
+    bool connect() override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_CONNECT_MS));
+        return(up && FileGoldSink::connect());
+    }
+    bool insert(const std::vector<GoldEvent>& batch) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_INSERT_MS));
+        return(up && FileGoldSink::insert(batch));
+    }
+private:
+    std::atomic<bool>& up;
+};
+
+static GoldEvent makeEvent(unsigned long seq) {
+    GoldEvent event;
+    event.player = "Goldtester";
+    event.id = "P" + std::to_string(seq);
+    event.source = "shop";
+    event.room = "misc.3";
+    event.type = "buy";
+    event.gold = seq;
+    event.direction = "out";
+    return(event);
+}
+
+//*********************************************************************
+//                      backpressure
+//*********************************************************************
+// Posts far more than the queue holds, with the sink down for the first
+// part and slow after that, then checks the file the way a DBA would
+
+static void backpressure(const std::string& dir, bool startDown) {
+    std::string path = dir + "/goldlog.txt";
+    std::string journal = dir + "/goldlog.journal";
+    std::filesystem::remove(path);
+
+    std::atomic<bool> up{!startDown};
+    GoldLogWriter::Stats stats{};
+    {
+        GoldLogWriter writer(std::make_unique<TestSink>(path, up), journal);
+        for(unsigned long seq = 0; seq < TEST_EVENTS; seq++) {
+            writer.post(makeEvent(seq));
+            if(seq % TEST_BURST == TEST_BURST - 1)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            // Back up halfway through; it'll be picked up on the way out
+            if(seq == TEST_EVENTS / 2)
+                up = true;
+        }
+        stats = writer.getStats();
+    }
+
+    std::ifstream in(path);
+    std::string line;
+    GoldEvent event;
+    unsigned long rows = 0, outOfOrder = 0, garbled = 0;
+    while(std::getline(in, line)) {
+        if(!event.fromLine(line) || event.id != "P" + std::to_string(event.gold))
+            garbled++;
+        else if(event.gold != rows)
+            outOfOrder++;
+        rows++;
+    }
+
+    std::cout << fmt::format("{:<12} rows {:>6}   spilled {:>6}   journaled {:>6}\n",
+        startDown ? "down, slow" : "slow", rows, stats.spilled, stats.journaled);
+    CHECK(stats.spilled > 0);
+    CHECK_EQ(stats.dropped, 0UL);
+    CHECK_EQ(rows, static_cast<unsigned long>(TEST_EVENTS));
+    CHECK_EQ(outOfOrder, 0UL);
+    CHECK_EQ(garbled, 0UL);
+    CHECK(!std::ifstream(journal).good());
+    CHECK(!std::ifstream(journal + ".spill").good());
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/goldLogTest.XXXXXX";
+    if(!mkdtemp(dirTemplate)) {
+        std::cerr << "Unable to make a temporary directory\n";
+        return(1);
+    }
+    std::string dir = dirTemplate;
+
+    backpressure(dir, false);
+    backpressure(dir, true);
+
+    std::filesystem::remove_all(dir);
+    return(checkResult());
+}
@@ -0,0 +1,231 @@
+/*
+ * keyIndexTest.cpp
+ *   Searching a big container through its key index finds what the plain scan finds
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <cstring>              // for strcpy, strlen
+#include <iostream>             // for cout
+#include <random>               // for mt19937
+#include <string>               // for string
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "config.hpp"           // for Config, gConfig
+#include "keyIndex.hpp"         // for KEYINDEX_MIN
+#include "mudObjects/monsters.hpp"      // for Monster
+#include "mudObjects/objects.hpp"       // for Object
+#include "mudObjects/players.hpp"       // for Player
+#include "mudObjects/uniqueRooms.hpp"   // for UniqueRoom
+#include "proto.hpp"            // for keyTxtCompare, keyTxtNormalize, isMatch
+#include "server.hpp"           // for Server, gServer
+
+#define TEST_KEYS           1000000     // Random key/text pairs for keyTxtCompare
+#define TEST_ITEMS          (KEYINDEX_MIN * 4)
+
+// Pieces keys are made of: plain and accented letters, html entities (whole
+// and broken), color codes and whatever else turns up in names
+static const char* keyParts[] = {
+    "s", "c", "r", "o", "l", "e", "x", "i", "a", "S", "C", "R", "O", "L", "E",
+    "\xe7", "\xc7", "\xe9", "\xc9", "\xf6", "\xff", "&#233;", "&#231;", "&#83;", "&#;", "&#99",
+    "^r", "^x", "^", " ", "'", "-", "1", "2",
+};
+static const char* txtParts[] = {
+    "s", "c", "r", "o", "l", "e", "x", "i", "a", "S", "C", "R", "O", "L", "E",
+    "\xe7", "\xc7", "\xe9", "\xc9", "\xf6", "\xff", " ", "'", "-", "&", "#", ";",
+};
+
+template <size_t N>
+static std::string randomText(std::mt19937& rng, const char* (&parts)[N], int maxParts) {
+    std::string text;
+    int count = rng() % (maxParts + 1);
+    for(int i = 0; i < count; i++)
+        text += parts[rng() % N];
+    return(text);
+}
+
+//*********************************************************************
+//                      compareKeys
+//*********************************************************************
+// keyTxtCompare is true exactly when what was typed, converted, starts the
+// normalized key; that's what lets the index answer with a prefix range
+
+static void compareKeys() {
+    std::mt19937 rng(46);
+    unsigned long matched = 0, differ = 0;
+    for(int i = 0; i < TEST_KEYS; i++) {
+        std::string key = randomText(rng, keyParts, 8);
+        std::string txt;
+        if(rng() % 2) {
+            // Something that ought to match it, typed in any case
+            std::string normalized = keyTxtNormalize(key.c_str());
+            txt = normalized.substr(0, rng() % (normalized.size() + 1));
+            for(char& ch : txt) {
+                if(rng() % 3 == 0)
+                    ch = static_cast<char>(toupper(static_cast<unsigned char>(ch)));
+            }
+        } else {
+            txt = randomText(rng, txtParts, 4);
+        }
+        if(txt.find('\0') != std::string::npos)
+            continue;
+
+        bool compared = keyTxtCompare(key.c_str(), txt.c_str(), static_cast<int>(txt.size()));
+        std::string converted = keyTxtConvert(txt);
+        bool indexed = !txt.empty() && keyTxtNormalize(key.c_str()).compare(0, converted.size(), converted) == 0;
+        if(compared != indexed) {
+            if(differ < 10)
+                std::cerr << "key \"" << key << "\" txt \"" << txt << "\": keyTxtCompare " << compared << "\n";
+            differ++;
+        }
+        if(compared)
+            matched++;
+    }
+    std::cout << fmt::format("keyTxtCompare: {} pairs, {} matched\n", TEST_KEYS, matched);
+    CHECK(matched > TEST_KEYS / 4);
+    CHECK_EQ(differ, 0UL);
+}
+
+//*********************************************************************
+//                      ordinals
+//*********************************************************************
+// "get 3.scroll": the num'th match through the index is the num'th match
+// scanning the whole set in order
+
+static const char* names[] = {
+    "scroll", "scroll of recall", "Scroll of Light", "s\xe7roll", "&#83;croll of fire",
+    "^rred^x scroll", "elixir", "&#233;lixir of life", "Elixir", "ring", "red ring",
+    "sword", "short sword", "rat", "rat king", "Ratcatcher",
+};
+static const char* queries[] = {
+    "s", "sc", "SCR", "scroll", "scrolls", "s\xe7", "s\xc7r", "scroll of", "re", "red", "recall",
+    "e", "el", "elixir", "\xe9lix", "l", "li", "life", "r", "ra", "rat", "ring", "x", "zz", "'",
+};
+
+template <class Set, class Find>
+static unsigned long compareFinds(const Set& set, const Creature* searcher, Find find) {
+    unsigned long differ = 0;
+    for(const char* query : queries) {
+        int total = 0;
+        for(auto* target : set) {
+            if(isMatch(searcher, target, query, false, true))
+                total++;
+        }
+        for(int num = 1; num <= total + 2; num++) {
+            typename Set::value_type expected = nullptr;
+            int seen = 0;
+            for(auto* target : set) {
+                if(isMatch(searcher, target, query, false, true) && ++seen == num) {
+                    expected = target;
+                    break;
+                }
+            }
+            if(find(query, num) != expected)
+                differ++;
+        }
+    }
+    return(differ);
+}
+
+// Keys and a name from the list, so plenty of them share a prefix
+static void setKeys(MudObject* target, char (*key)[20], int i) {
+    strcpy(key[0], names[(i * 3) % (sizeof(names) / sizeof(names[0]))]);
+    strcpy(key[1], i % 4 ? "thing" : "");
+    strcpy(key[2], i % 5 ? "" : "^bblue");
+    target->setName(fmt::format("{} {}", names[i % (sizeof(names) / sizeof(names[0]))], i % 7 ? "" : "of doom"));
+}
+
+static void ordinals() {
+    auto* room = new UniqueRoom;
+    auto* searcher = new Player;
+    searcher->setName("Keysearcher");
+    searcher->setId("P1");
+    room->add(searcher);
+
+    auto* bag = new Object;
+    bag->setName("bottomless bag");
+    std::vector<Object*> objects;
+    std::vector<Monster*> monsters;
+    for(int i = 0; i < TEST_ITEMS; i++) {
+        auto* object = new Object;
+        object->setId(fmt::format("O{}", i));
+        setKeys(object, object->key, i);
+        bag->add(object);
+        objects.push_back(object);
+
+        auto* monster = new Monster;
+        monster->setId(fmt::format("M{}", i));
+        setKeys(monster, monster->key, i + 1);
+        room->add(monster);
+        monsters.push_back(monster);
+
+        auto* player = new Player;
+        player->setId(fmt::format("P{}", 100 + i));
+        player->setName(fmt::format("{}{}", i % 2 ? "Ratty" : "Scrollkeeper", static_cast<char>('a' + i % 26)));
+        room->add(player);
+    }
+
+    auto findObjects = [&]() {
+        return(compareFinds(bag->objects, searcher, [&](const char* q, int num) { return(bag->findObject(searcher, q, num)); }));
+    };
+    auto findMonsters = [&]() {
+        return(compareFinds(room->monsters, searcher, [&](const char* q, int num) { return(room->findMonster(searcher, q, num)); }));
+    };
+    auto findPlayers = [&]() {
+        return(compareFinds(room->players, searcher, [&](const char* q, int num) { return(room->findPlayer(searcher, q, num)); }));
+    };
+
+    CHECK(bag->objects.size() >= KEYINDEX_MIN);
+    CHECK_EQ(findObjects(), 0UL);
+    CHECK_EQ(findMonsters(), 0UL);
+    CHECK_EQ(findPlayers(), 0UL);
+
+    // Keys written in place, things renamed, taken out and put back
+    for(int i = 0; i < TEST_ITEMS; i += 3) {
+        strcpy(objects[i]->key[1], "scrap");
+        objects[i]->keysChanged();
+        monsters[i]->setName("ratling");
+    }
+    for(int i = 1; i < TEST_ITEMS; i += 5) {
+        bag->remove(objects[i]);
+        room->remove(monsters[i]);
+    }
+    for(int i = 1; i < TEST_ITEMS; i += 10) {
+        bag->add(objects[i]);
+        room->add(monsters[i]);
+    }
+    CHECK_EQ(findObjects(), 0UL);
+    CHECK_EQ(findMonsters(), 0UL);
+    CHECK_EQ(findPlayers(), 0UL);
+
+    // Down below the size the index is used for, and back up again
+    for(int i = KEYINDEX_MIN / 2; i < TEST_ITEMS; i++)
+        bag->remove(objects[i]);
+    CHECK_EQ(findObjects(), 0UL);
+    for(int i = KEYINDEX_MIN / 2; i < TEST_ITEMS; i++)
+        bag->add(objects[i]);
+    CHECK_EQ(findObjects(), 0UL);
+}
+
+int main() {
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+
+    compareKeys();
+    ordinals();
+    return(checkResult());
+}
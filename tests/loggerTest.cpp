@@ -0,0 +1,63 @@
+/*
+ * loggerTest.cpp
+ *   Lines come out of the log writer in the order they went in, full ring or not
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <unistd.h>             // for mkdtemp
+#include <filesystem>           // for remove_all
+#include <fstream>              // for ifstream
+#include <string>               // for string, to_string
+#include <thread>               // for thread
+#include <vector>               // for vector
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "logger.hpp"           // for Logger, LOG_RING_SIZE
+
+#define LOGGER_TEST_THREADS     4
+#define LOGGER_TEST_LINES       (LOG_RING_SIZE * 25)    // Per thread; far more than the ring holds
+
+int main() {
+    char dirTemplate[] = "/tmp/loggerTestXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string path = dir + "/flood.txt";
+
+    // Several threads flood one log, so the ring is full most of the time
+    std::vector<std::thread> threads;
+    for(int t = 0; t < LOGGER_TEST_THREADS; t++) {
+        threads.emplace_back([t, &path] {
+            for(int i = 0; i < LOGGER_TEST_LINES; i++)
+                Logger::getInstance()->write(path, std::to_string(t) + " " + std::to_string(i) + "\n");
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+    Logger::getInstance()->stop();
+
+    // Every line is there once, and each thread's lines are in the order it logged them
+    std::vector<int> next(LOGGER_TEST_THREADS, 0);
+    std::ifstream in(path);
+    int t, i, lines = 0, outOfOrder = 0;
+    while(in >> t >> i) {
+        lines++;
+        if(t < 0 || t >= LOGGER_TEST_THREADS || i != next[t]++)
+            outOfOrder++;
+    }
+    CHECK_EQ(lines, LOGGER_TEST_THREADS * LOGGER_TEST_LINES);
+    CHECK_EQ(outOfOrder, 0);
+
+    std::filesystem::remove_all(dir);
+    return(checkResult());
+}
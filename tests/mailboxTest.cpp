@@ -0,0 +1,120 @@
+/*
+ * mailboxTest.cpp
+ *   Producers flood a Mailbox while the game loop drains it; built with ThreadSanitizer
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <atomic>               // for atomic
+#include <string>               // for string, to_string
+#include <thread>               // for thread, yield
+#include <vector>               // for vector
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "mailbox.hpp"          // for Mailbox, GameEvent
+
+#define TEST_PRODUCERS      8
+#define TEST_POSTS          100000  // By each producer
+
+struct Post {
+    int producer;
+    long seq;
+    std::string text;       // Written by the producer, read by the consumer
+};
+
+//*********************************************************************
+//                      flood
+//*********************************************************************
+// Every post arrives once, and each producer's posts arrive in the order
+// it made them; the consumer drains a frame's worth at a time as they come
+
+static void flood() {
+    Mailbox<Post> mailbox;
+    std::atomic<int> running{TEST_PRODUCERS};
+    std::vector<std::thread> producers;
+    for(int p = 0; p < TEST_PRODUCERS; p++) {
+        producers.emplace_back([&mailbox, &running, p] {
+            for(long i = 0; i < TEST_POSTS; i++)
+                mailbox.post(Post{p, i, std::to_string(p) + ":" + std::to_string(i)});
+            running--;
+        });
+    }
+
+    std::vector<long> next(TEST_PRODUCERS, 0);
+    long received = 0, outOfOrder = 0, garbled = 0;
+    Post post;
+    bool drained = false;
+    while(!drained) {
+        // Checked before popping: once it's zero, everything posted can be seen
+        drained = running == 0;
+        for(int n = 0; n < MAILBOX_FRAME_MAX && mailbox.pop(post); n++) {
+            received++;
+            if(post.seq != next[post.producer])
+                outOfOrder++;
+            next[post.producer] = post.seq + 1;
+            if(post.text != std::to_string(post.producer) + ":" + std::to_string(post.seq))
+                garbled++;
+            drained = false;
+        }
+        std::this_thread::yield();
+    }
+    for(std::thread& producer : producers)
+        producer.join();
+
+    CHECK_EQ(received, static_cast<long>(TEST_PRODUCERS) * TEST_POSTS);
+    CHECK_EQ(outOfOrder, 0L);
+    CHECK_EQ(garbled, 0L);
+    CHECK_EQ(mailbox.getPosted(), static_cast<unsigned long>(TEST_PRODUCERS) * TEST_POSTS);
+    CHECK(!mailbox.pop(post));
+}
+
+//*********************************************************************
+//                      callbacks
+//*********************************************************************
+// GameCallbacks posted from other threads run on the game loop and may touch
+// game state without a lock; the counter here is deliberately not atomic
+
+static void callbacks() {
+    Mailbox<GameEvent> mailbox;
+    long ran = 0;
+    std::vector<std::thread> producers;
+    for(int p = 0; p < TEST_PRODUCERS; p++) {
+        producers.emplace_back([&mailbox, &ran] {
+            for(long i = 0; i < TEST_POSTS / 10; i++)
+                mailbox.post(GameCallback([&ran] { ran++; }));
+        });
+    }
+
+    long expected = static_cast<long>(TEST_PRODUCERS) * (TEST_POSTS / 10);
+    GameEvent event;
+    while(ran < expected) {
+        if(mailbox.pop(event))
+            std::get<GameCallback>(event)();
+        else
+            std::this_thread::yield();
+    }
+    for(std::thread& producer : producers)
+        producer.join();
+    CHECK_EQ(ran, expected);
+
+    // Whatever is still in the mailbox when it goes away is freed with it
+    for(int i = 0; i < 1000; i++)
+        mailbox.post(DiscordMessage{1, "Benchbota", "hello", "hello", "benchbota"});
+}
+
+int main() {
+    flood();
+    callbacks();
+    return(checkResult());
+}
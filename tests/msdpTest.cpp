@@ -0,0 +1,178 @@
+/*
+ * msdpTest.cpp
+ *   MSDP sends nothing for a player standing still, and only what changed in a fight
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <arpa/telnet.h>        // for IAC
+#include <fcntl.h>              // for fcntl, O_NONBLOCK
+#include <sys/socket.h>         // for socketpair
+#include <unistd.h>             // for read
+#include <chrono>               // for steady_clock
+#include <ctime>                // for time
+#include <iostream>             // for cout
+#include <map>                  // for map
+#include <set>                  // for set
+#include <string>               // for string
+#include <thread>               // for sleep_for
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "config.hpp"           // for Config, gConfig
+#include "login.hpp"            // for CON_PLAYING
+#include "mudObjects/monsters.hpp"      // for Monster
+#include "mudObjects/players.hpp"       // for Player
+#include "socket.hpp"           // for Socket, MSDP_VAR, MSDP_VAL
+
+#define TEST_FRAME_MS       100     // A game frame
+#define TEST_SETTLE_FRAMES  15      // Long enough for every variable's timer to come round
+#define TEST_PHASE_FRAMES   30
+
+// What a client asking for the usual status bar would report
+static const char* reported[] = {
+    "HEALTH", "HEALTH_MAX", "MANA", "MANA_MAX", "EXPERIENCE", "EXPERIENCE_TNL",
+    "WIMPY", "MONEY", "ARMOR", "TARGET", "TARGET_ID", "TARGET_HEALTH", nullptr
+};
+
+// A socket the test can report variables on, with MSDP turned on
+class TestSocket : public Socket {
+public:
+    using Socket::Socket;
+    using Socket::msdpReport;
+    void enableMsdp() { opts.msdp = true; }
+};
+
+struct Phase {
+    Socket::MsdpStats stats{};
+    std::map<std::string, std::string> sent;    // Last value on the wire for each variable
+    std::set<std::string> names;
+};
+
+// Everything the server wrote since last time, split into MSDP pairs
+static void readPairs(int fd, Phase& phase) {
+    static std::string wire;
+    char buf[4096];
+    ssize_t n;
+    while((n = read(fd, buf, sizeof(buf))) > 0)
+        wire.append(buf, n);
+
+    size_t pos;
+    while((pos = wire.find(static_cast<char>(MSDP_VAR))) != std::string::npos) {
+        size_t val = wire.find(static_cast<char>(MSDP_VAL), pos);
+        size_t end = val == std::string::npos ? val : wire.find(static_cast<char>(IAC), val);
+        if(end == std::string::npos)
+            break;
+        std::string name = wire.substr(pos + 1, val - pos - 1);
+        phase.sent[name] = wire.substr(val + 1, end - val - 1);
+        phase.names.insert(name);
+        wire.erase(0, end);
+    }
+}
+
+// Runs frames the way the server does, each doing whatever round does first
+template <class Round>
+static Phase runFrames(TestSocket& sock, int peer, int frames, Round round) {
+    Phase phase;
+    Socket::MsdpStats before = sock.getMsdpStats();
+    for(int i = 0; i < frames; i++) {
+        round(i);
+        sock.msdpSendChanges(time(nullptr));
+        readPairs(peer, phase);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_FRAME_MS));
+    }
+    const Socket::MsdpStats& after = sock.getMsdpStats();
+    phase.stats.checked = after.checked - before.checked;
+    phase.stats.computed = after.computed - before.computed;
+    phase.stats.sent = after.sent - before.sent;
+    phase.stats.bytes = after.bytes - before.bytes;
+    return(phase);
+}
+
+static void report(const char* name, const Phase& phase) {
+    std::cout << fmt::format("{:<10} checked {:>5}   worked out {:>4}   sent {:>4}   bytes {:>6}\n",
+        name, phase.stats.checked, phase.stats.computed, phase.stats.sent, phase.stats.bytes);
+}
+
+int main() {
+    gConfig = Config::getInstance();
+    gConfig->initMsdp();
+
+    int fds[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        std::cerr << "Unable to make a socket pair\n";
+        return(1);
+    }
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    auto* sock = new TestSocket(fds[0]);
+    auto* player = new Player;
+    player->fd = -1;
+    player->setName("Msdptester");
+    player->setLevel(5);
+    player->setExperience(5000);
+    player->hp.setInitial(200);
+    player->hp.restore();
+    player->setSock(sock);
+    sock->setPlayer(player);
+    sock->setState(CON_PLAYING);
+    sock->enableMsdp();
+    for(int i = 0; reported[i]; i++)
+        CHECK(sock->msdpReport(reported[i]) != nullptr);
+
+    auto* rat = new Monster;
+    rat->setName("field rat");
+    rat->hp.setInitial(1000);
+    rat->hp.restore();
+    player->addTarget(rat);
+
+    auto nothing = [](int) {};
+    // Everything is sent once, then a player standing still costs nothing
+    Phase settle = runFrames(*sock, fds[1], TEST_SETTLE_FRAMES, nothing);
+    CHECK_EQ(settle.names.size(), sizeof(reported) / sizeof(reported[0]) - 1);
+    Phase idle = runFrames(*sock, fds[1], TEST_PHASE_FRAMES, nothing);
+    CHECK_EQ(idle.stats.computed, 0UL);
+    CHECK_EQ(idle.stats.bytes, 0UL);
+
+    // Trading blows: only the two health bars move
+    Phase fight = runFrames(*sock, fds[1], TEST_PHASE_FRAMES, [&](int i) {
+        rat->hp.decrease(7);
+        if(i % 2)
+            player->hp.decrease(3);
+    });
+    CHECK(fight.stats.bytes > 0);
+    CHECK(fight.stats.computed < fight.stats.checked / 2);
+    for(const std::string& name : fight.names)
+        CHECK(name == "HEALTH" || name == "TARGET_HEALTH");
+
+    // Experience lost, as when dying, is sent too
+    Phase death = runFrames(*sock, fds[1], TEST_SETTLE_FRAMES, [&](int i) {
+        if(i == 0)
+            player->subExperience(500);
+    });
+    CHECK(death.names.count("EXPERIENCE") == 1);
+    CHECK_EQ(death.sent["EXPERIENCE"], std::to_string(player->getExperience()));
+
+    // Whatever was sent last is what the player has now
+    Phase after = runFrames(*sock, fds[1], TEST_SETTLE_FRAMES, nothing);
+    std::string health = after.sent.count("HEALTH") ? after.sent["HEALTH"] : fight.sent["HEALTH"];
+    CHECK_EQ(health, std::to_string(player->hp.getCur()));
+
+    report("settle", settle);
+    report("idle", idle);
+    report("fighting", fight);
+    report("death", death);
+    return(checkResult());
+}
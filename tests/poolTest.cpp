@@ -0,0 +1,133 @@
+/*
+ * poolTest.cpp
+ *   A million monsters spawned and killed, from the pool or (with "system") the system allocator
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <algorithm>            // for max
+#include <chrono>               // for steady_clock
+#include <cstring>              // for strcmp, strlen
+#include <fstream>              // for ifstream
+#include <iostream>             // for cout
+#include <string>               // for string, getline, stol
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "config.hpp"           // for Config, gConfig
+#include "mudObjects/monsters.hpp"      // for Monster
+#include "pool.hpp"             // for TypePool, PoolStats, POOL_CHUNK_BYTES
+#include "server.hpp"           // for Server, gServer
+
+#define TEST_CYCLES         1000000
+#define TEST_ALIVE          1000    // Monsters in the world at any one time
+#define TEST_STRIDE         7919    // Kills out of the order they spawned in
+
+// Resident memory in kB, now or at its highest, from /proc
+static long getRss(const char* field) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.starts_with(field))
+            return(std::stol(line.substr(strlen(field))));
+    }
+    return(0);
+}
+
+static PoolStats getMonsterStats() {
+    for(const PoolStats& stats : TypePool::getAllStats()) {
+        if(!strcmp(stats.name, "Monster"))
+            return(stats);
+    }
+    return(PoolStats{});
+}
+
+static double nsPer(std::chrono::steady_clock::time_point start, long count) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return(elapsed.count() / count);
+}
+
+//*********************************************************************
+//                      spawnKill
+//*********************************************************************
+// A world's worth of monsters, each one killed replaced by a new one, out
+// of order the way they die in the game. Allocation alone is timed the same
+// way, through Monster's operator new and delete without building them.
+
+static void spawnKill() {
+    long rssBefore = getRss("VmRSS:");
+
+    std::vector<Monster*> world;
+    for(int i = 0; i < TEST_ALIVE; i++)
+        world.push_back(new Monster());
+    auto start = std::chrono::steady_clock::now();
+    for(long i = 0; i < TEST_CYCLES; i++) {
+        Monster*& victim = world[(i * TEST_STRIDE) % TEST_ALIVE];
+        delete victim;
+        victim = new Monster();
+    }
+    double spawnNs = nsPer(start, TEST_CYCLES);
+    long rssAlive = getRss("VmRSS:");
+    PoolStats alive = getMonsterStats();
+    for(Monster* monster : world)
+        delete monster;
+
+    std::vector<void*> blocks;
+    for(int i = 0; i < TEST_ALIVE; i++)
+        blocks.push_back(Monster::operator new(sizeof(Monster)));
+    start = std::chrono::steady_clock::now();
+    for(long i = 0; i < TEST_CYCLES; i++) {
+        void*& block = blocks[(i * TEST_STRIDE) % TEST_ALIVE];
+        Monster::operator delete(block, sizeof(Monster));
+        block = Monster::operator new(sizeof(Monster));
+    }
+    double allocNs = nsPer(start, TEST_CYCLES);
+    for(void* block : blocks)
+        Monster::operator delete(block, sizeof(Monster));
+
+    PoolStats done = getMonsterStats();
+    const char* allocator = done.systemAlloc ? "system" : "pool";
+    std::cout << fmt::format("{:<8} {} monsters of {} bytes: spawn+kill {:.0f} ns, allocate+free {:.0f} ns\n",
+        allocator, TEST_CYCLES, sizeof(Monster), spawnNs, allocNs);
+    std::cout << fmt::format("{:<8} RSS {} kB with {} alive ({} kB more than before), peak {} kB; pool holds {} kB\n",
+        allocator, rssAlive, TEST_ALIVE, rssAlive - rssBefore, getRss("VmHWM:"), done.reserved / 1024);
+
+    // Every monster was counted, and none are left
+    CHECK_EQ(alive.live, static_cast<unsigned long>(TEST_ALIVE));
+    CHECK_EQ(done.live, 0UL);
+    CHECK(done.peak >= TEST_ALIVE);
+    CHECK(done.allocs >= 2UL * (TEST_ALIVE + TEST_CYCLES));
+    if(done.systemAlloc) {
+        CHECK_EQ(done.reserved, 0UL);
+    } else {
+        // Blocks are reused: no more chunks than the most ever alive needed
+        size_t perChunk = std::max<size_t>(1, POOL_CHUNK_BYTES / done.blockSize);
+        CHECK(done.reserved <= (done.peak / perChunk + 1) * perChunk * done.blockSize);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Before the first monster makes its pool
+    bool system = argc > 1 && !strcmp(argv[1], "system");
+    TypePool::setSystemAlloc(system);
+
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+
+    spawnKill();
+    CHECK_EQ(getMonsterStats().systemAlloc, system);
+    return(checkResult());
+}
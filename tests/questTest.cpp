@@ -0,0 +1,289 @@
+/*
+ * questTest.cpp
+ *   Quests finish, and say so, the same through the quest index as they did checking every objective
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <libxml/parser.h>      // for xmlReadMemory
+#include <libxml/tree.h>        // for xmlNodeDump
+#include <cstring>              // for strlen
+#include <iostream>             // for cout
+#include <map>                  // for map
+#include <random>               // for mt19937
+#include <string>               // for string
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "config.hpp"           // for Config, gConfig
+#include "global.hpp"           // for ObjectType
+#include "login.hpp"            // for CON_PLAYING
+#include "mudObjects/monsters.hpp"      // for Monster
+#include "mudObjects/objects.hpp"       // for Object
+#include "mudObjects/players.hpp"       // for Player
+#include "mudObjects/uniqueRooms.hpp"   // for UniqueRoom
+#include "quests.hpp"           // for QuestInfo, QuestCompletion, QuestIndex
+#include "server.hpp"           // for Server, gServer
+#include "socket.hpp"           // for Socket
+
+#define TEST_SCENARIOS      20
+#define TEST_EVENTS         400     // In each scenario
+
+// Kill, fetch and visit quests, alone and mixed, sharing monsters, objects and rooms
+static const char* questXml = R"(<Quests>
+  <Quest Num="1"><Name>Rat Problem</Name>
+    <Requirements>
+      <Monster><Area>test</Area><Id>1</Id><ReqAmt>3</ReqAmt></Monster>
+      <Monster><Area>test</Area><Id>2</Id><ReqAmt>1</ReqAmt></Monster>
+    </Requirements></Quest>
+  <Quest Num="2"><Name>Bread Run</Name>
+    <Requirements>
+      <Object><Area>test</Area><Id>1</Id><ReqAmt>2</ReqAmt></Object>
+      <Room><Area>test</Area><Id>3</Id></Room>
+    </Requirements></Quest>
+  <Quest Num="3"><Name>Grand Tour</Name>
+    <Requirements>
+      <Room><Area>test</Area><Id>2</Id></Room>
+      <Room><Area>test</Area><Id>3</Id></Room>
+      <Room><Area>test</Area><Id>4</Id></Room>
+    </Requirements></Quest>
+  <Quest Num="4"><Name>A Bit of Everything</Name>
+    <Requirements>
+      <Monster><Area>test</Area><Id>1</Id><ReqAmt>2</ReqAmt></Monster>
+      <Object><Area>test</Area><Id>2</Id><ReqAmt>1</ReqAmt></Object>
+      <Object><Area>test</Area><Id>1</Id><ReqAmt>3</ReqAmt></Object>
+      <Room><Area>test</Area><Id>4</Id></Room>
+    </Requirements></Quest>
+  <Quest Num="5"><Name>Hoarder</Name>
+    <Requirements>
+      <Object><Area>test</Area><Id>3</Id><ReqAmt>5</ReqAmt></Object>
+    </Requirements></Quest>
+  <Quest Num="6"><Name>Out of Reach</Name>
+    <Requirements>
+      <Monster><Area>test</Area><Id>9</Id><ReqAmt>1</ReqAmt></Monster>
+      <Object><Area>test</Area><Id>9</Id><ReqAmt>1</ReqAmt></Object>
+    </Requirements></Quest>
+  <Quest Num="7"><Name>Errand</Name></Quest>
+</Quests>)";
+
+// A socket whose output the test can take
+class TestSocket : public Socket {
+public:
+    using Socket::Socket;
+    std::string take() {
+        std::string text;
+        text.swap(output);
+        return(text);
+    }
+};
+
+// Two players who go through exactly the same things: one the way every
+// quest used to check every objective, the other through the quest index
+struct Twin {
+    Player* player;
+    TestSocket* sock;
+    std::vector<Object*> carried;   // Same order for both
+    Object* bag;
+};
+
+static Twin makeTwin(const std::string& name) {
+    Twin twin{};
+    twin.sock = new TestSocket(-1);
+    twin.player = new Player;
+    twin.player->fd = -1;
+    twin.player->setName(name);
+    twin.player->setSock(twin.sock);
+    twin.sock->setPlayer(twin.player);
+    twin.sock->setState(CON_PLAYING);
+    twin.bag = new Object;
+    twin.bag->setName("sack");
+    twin.bag->setType(ObjectType::CONTAINER);
+    twin.bag->setShotsMax(20);
+    twin.player->add(twin.bag);
+    return(twin);
+}
+
+// Every quest's progress, as it would be saved
+static std::string questState(Player* player) {
+    std::string state;
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr root = xmlNewDocNode(doc, nullptr, BAD_CAST "Quests", nullptr);
+    xmlDocSetRootElement(doc, root);
+    for(const auto& [id, quest] : player->questsInProgress) {
+        quest->save(root);
+        state += fmt::format("{}:{}{}{} ", id, quest->hasRequiredMobs(), quest->hasRequiredItems(), quest->hasRequiredRooms());
+    }
+    xmlBufferPtr buf = xmlBufferCreate();
+    xmlNodeDump(buf, doc, root, 0, 0);
+    state += reinterpret_cast<const char*>(xmlBufferContent(buf));
+    xmlBufferFree(buf);
+    xmlFreeDoc(doc);
+    return(state);
+}
+
+static Monster* makeMonster(int id) {
+    auto* monster = new Monster;
+    monster->info.setArea("test");
+    monster->info.id = id;
+    monster->setName(id == 1 ? "field rat" : id == 2 ? "rat king" : "stray dog");
+    return(monster);
+}
+
+static Object* makeObject(int id, bool broken) {
+    auto* object = new Object;
+    object->info.setArea("test");
+    object->info.id = id;
+    object->setName(id == 1 ? "loaf of bread" : id == 2 ? "silver key" : id == 3 ? "pebble" : "rock");
+    object->setShotsMax(1);
+    object->setShotsCur(broken ? 0 : 1);
+    return(object);
+}
+
+//*********************************************************************
+//                      scenario
+//*********************************************************************
+// A player out adventuring with a handful of quests: killing, picking
+// things up, losing and breaking them, stashing them in a bag, walking
+// around, and taking on and abandoning quests as they go
+
+static void scenario(const std::vector<QuestInfo*>& quests, int seed, unsigned long& events, unsigned long& lines) {
+    std::mt19937 rng(seed);
+    Twin scan = makeTwin("Questscan");
+    Twin indexed = makeTwin("Questindex");
+    Twin* twins[] = {&scan, &indexed};
+
+    UniqueRoom rooms[5];
+    for(int i = 0; i < 5; i++) {
+        rooms[i].info.setArea("test");
+        rooms[i].info.id = i;
+        rooms[i].setName(fmt::format("Test Room {}", i));
+    }
+
+    for(int e = 0; e < TEST_EVENTS; e++) {
+        int action = rng() % 100;
+        int id = rng() % 4 + (rng() % 20 == 0 ? 5 : 0);
+        bool broken = rng() % 6 == 0;
+        int pick = static_cast<int>(rng() % 1000);
+        QuestInfo* quest = quests[rng() % quests.size()];
+
+        for(Twin* twin : twins) {
+            Player* player = twin->player;
+            bool useIndex = twin == &indexed;
+
+            if(action < 25) {
+                // A kill
+                Monster* monster = makeMonster(id);
+                if(useIndex) {
+                    player->updateMobKills(monster);
+                } else {
+                    for(const auto& [questId, completion] : player->questsInProgress)
+                        completion->updateMobKills(monster);
+                }
+                delete monster;
+            } else if(action < 55) {
+                // Something picked up
+                Object* object = makeObject(id, broken);
+                player->add(object);
+                twin->carried.push_back(object);
+                if(useIndex) {
+                    player->updateItems(object);
+                } else {
+                    for(const auto& [questId, completion] : player->questsInProgress)
+                        completion->updateItems(object);
+                }
+            } else if(action < 70) {
+                // Walking into a room
+                UniqueRoom* room = &rooms[id % 5];
+                if(useIndex) {
+                    player->updateRooms(room);
+                } else {
+                    for(const auto& [questId, completion] : player->questsInProgress)
+                        completion->updateRooms(room);
+                }
+            } else if(action < 78) {
+                // Dropped or sold
+                if(!twin->carried.empty()) {
+                    Object* object = twin->carried[pick % twin->carried.size()];
+                    object->getParent()->remove(object);
+                    twin->carried.erase(twin->carried.begin() + pick % twin->carried.size());
+                    delete object;
+                }
+            } else if(action < 84) {
+                // Put in the sack, where it still counts
+                if(!twin->carried.empty()) {
+                    Object* object = twin->carried[pick % twin->carried.size()];
+                    if(object->getParent() == player) {
+                        player->remove(object);
+                        twin->bag->add(object);
+                    }
+                }
+            } else if(action < 88) {
+                // Used up
+                if(!twin->carried.empty())
+                    twin->carried[pick % twin->carried.size()]->setShotsCur(0);
+            } else if(action < 95) {
+                // A new quest
+                if(!player->questsInProgress.count(quest->getId()))
+                    player->questsInProgress[quest->getId()] = new QuestCompletion(quest, player);
+            } else if(action < 99) {
+                // Abandoned
+                auto it = player->questsInProgress.find(quest->getId());
+                if(it != player->questsInProgress.end()) {
+                    delete it->second;
+                    player->questsInProgress.erase(it);
+                }
+            } else if(useIndex) {
+                // The quests were reloaded by staff
+                QuestIndex::questsReloaded();
+            }
+        }
+
+        std::string scanOut = scan.sock->take();
+        std::string indexedOut = indexed.sock->take();
+        if(scanOut != indexedOut)
+            std::cerr << fmt::format("Seed {} event {}:\n  scan    \"{}\"\n  indexed \"{}\"\n", seed, e, scanOut, indexedOut);
+        CHECK(scanOut == indexedOut);
+        CHECK(questState(scan.player) == questState(indexed.player));
+        events++;
+        if(!scanOut.empty())
+            lines++;
+    }
+}
+
+int main() {
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+
+    xmlDocPtr doc = xmlReadMemory(questXml, static_cast<int>(strlen(questXml)), "quests.xml", nullptr, XML_PARSE_NOBLANKS);
+    CHECK(doc != nullptr);
+    if(!doc)
+        return(checkResult());
+    std::vector<QuestInfo*> quests;
+    for(xmlNodePtr node = xmlDocGetRootElement(doc)->children; node; node = node->next) {
+        if(node->type == XML_ELEMENT_NODE)
+            quests.push_back(new QuestInfo(node));
+    }
+    xmlFreeDoc(doc);
+    CHECK_EQ(quests.size(), 7UL);
+
+    unsigned long events = 0, lines = 0;
+    for(int seed = 1; seed <= TEST_SCENARIOS; seed++)
+        scenario(quests, seed, events, lines);
+
+    std::cout << fmt::format("{} events, {} with quest messages\n", events, lines);
+    CHECK(lines > events / 10);
+    return(checkResult());
+}
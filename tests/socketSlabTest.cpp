@@ -0,0 +1,167 @@
+/*
+ * socketSlabTest.cpp
+ *   Players connect and disconnect over and over; a handle never finds a socket that's gone. Built with AddressSanitizer
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <sanitizer/asan_interface.h>   // for __asan_address_is_poisoned
+#include <sys/socket.h>         // for socketpair
+#include <unistd.h>             // for read, close
+#include <filesystem>           // for directory_iterator
+#include <iostream>             // for cout
+#include <random>               // for mt19937
+#include <set>                  // for set
+#include <vector>               // for vector
+
+#include <fmt/format.h>         // for format
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "config.hpp"           // for Config, gConfig
+#include "server.hpp"           // for Server, gServer
+#include "socket.hpp"           // for Socket
+#include "socketSlab.hpp"       // for SocketSlab, SocketHandle, SOCKETSLAB_CHUNK
+
+#define TEST_CONNECTS       100000
+#define TEST_ONLINE         (SOCKETSLAB_CHUNK * 5)  // Most ever connected at once
+#define TEST_GONE           1024    // Old handles kept to try again
+#define TEST_CHECK_EVERY    16      // Cycles between looking at every old handle
+
+struct Connection {
+    SocketHandle handle;
+    Socket* sock;
+    int peer;               // The player's end of the connection
+};
+
+static long countFds() {
+    long count = 0;
+    for([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator("/proc/self/fd"))
+        count++;
+    return(count);
+}
+
+//*********************************************************************
+//                      soak
+//*********************************************************************
+// Connects and disconnects, one at a time and a frame's worth at once, so
+// slots are reused over and over. Every handle to a socket that's gone must
+// find nothing, its slot must be poisoned until it's used again, and the
+// player's end of the connection must see it close.
+
+static void soak() {
+    std::mt19937 rng(49);
+    long fdsBefore = countFds();
+    unsigned long connects = 0, reused = 0;
+    unsigned long stale = 0, lost = 0, unpoisoned = 0, notClosed = 0, misordered = 0;
+    std::set<Socket*> everUsed;
+    std::vector<Connection> online;     // In the order they connected
+    std::vector<Connection> gone;
+    size_t nextGone = 0;
+
+    // Every socket says goodbye on the way out
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    {
+        SocketSlab slab;
+        for(int cycle = 0; connects < TEST_CONNECTS; cycle++) {
+            // Busier and quieter stretches, so the slab grows and shrinks
+            size_t target = (cycle / 5000) % 2 ? TEST_ONLINE : TEST_ONLINE / 4;
+            if(online.empty() || (online.size() < target && rng() % 2)) {
+                int fds[2];
+                if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                    CHECK(false);
+                    break;
+                }
+                Socket& sock = slab.emplace_back(fds[0]);
+                if(!everUsed.insert(&sock).second)
+                    reused++;
+                online.push_back(Connection{sock.getHandle(), &sock, fds[1]});
+                connects++;
+            } else {
+                // Usually one; now and then a crowd, the way cleanUp finds them
+                std::set<Socket*> leaving;
+                int count = rng() % 10 ? 1 : 1 + rng() % 20;
+                for(int i = 0; i < count; i++)
+                    leaving.insert(online[rng() % online.size()].sock);
+                slab.remove_if([&](Socket& sock) { return(leaving.count(&sock) > 0); });
+
+                std::vector<Connection> stayed;
+                for(const Connection& conn : online) {
+                    if(!leaving.count(conn.sock)) {
+                        stayed.push_back(conn);
+                        continue;
+                    }
+                    char buf;
+                    if(read(conn.peer, &buf, 1) != 0)
+                        notClosed++;
+                    close(conn.peer);
+                    if(!__asan_address_is_poisoned(conn.sock))
+                        unpoisoned++;
+                    if(gone.size() < TEST_GONE)
+                        gone.push_back(conn);
+                    else
+                        gone[nextGone++ % TEST_GONE] = conn;
+                }
+                online.swap(stayed);
+            }
+
+            // Everyone still here is found, and in the order they came
+            size_t pos = 0;
+            for(Socket& sock : slab) {
+                if(pos >= online.size() || &sock != online[pos].sock)
+                    misordered++;
+                pos++;
+            }
+            if(pos != online.size() || slab.size() != online.size())
+                misordered++;
+            for(const Connection& conn : online) {
+                if(slab.get(conn.handle) != conn.sock || conn.sock->getHandle() != conn.handle)
+                    lost++;
+            }
+            if(cycle % TEST_CHECK_EVERY == 0) {
+                for(const Connection& conn : gone) {
+                    if(slab.get(conn.handle))
+                        stale++;
+                }
+            }
+        }
+
+        slab.clear();
+        for(const Connection& conn : online) {
+            char buf;
+            if(read(conn.peer, &buf, 1) != 0)
+                notClosed++;
+            close(conn.peer);
+        }
+    }
+    std::cout.rdbuf(out);
+    std::cout.clear();
+
+    std::cout << fmt::format("{} connects, {} into a slot used before\n", connects, reused);
+    CHECK(reused > connects / 2);
+    CHECK_EQ(stale, 0UL);
+    CHECK_EQ(lost, 0UL);
+    CHECK_EQ(misordered, 0UL);
+    CHECK_EQ(unpoisoned, 0UL);
+    CHECK_EQ(notClosed, 0UL);
+    CHECK_EQ(Socket::getNumSockets(), 0);
+    CHECK_EQ(countFds(), fdsBefore);
+}
+
+int main() {
+    gConfig = Config::getInstance();
+    gServer = Server::getInstance();
+
+    soak();
+    return(checkResult());
+}
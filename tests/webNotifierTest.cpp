@@ -0,0 +1,384 @@
+/*
+ * webNotifierTest.cpp
+ *   WebNotifier against a stub webserver on loopback, and https urls handed to wget
+ *   ____            _
+ *  |  _ \ ___  __ _| |_ __ ___  ___
+ *  | |_) / _ \/ _` | | '_ ` _ \/ __|
+ *  |  _ <  __/ (_| | | | | | | \__ \
+ *  |_| \_\___|\__,_|_|_| |_| |_|___/
+ *
+ * Permission to use, modify and distribute is granted via the
+ *  GNU Affero General Public License v3 or later
+ *
+ *  Copyright (C) 2007-2021 Jason Mitchell, Randi Mitchell
+ *     Contributions by Tim Callahan, Jonathan Hseu
+ *  Based on Mordor (C) Brooke Paul, Brett J. Vickers, John P. Freeman
+ *
+ */
+
+#include <arpa/inet.h>          // for htonl, ntohs
+#include <netinet/in.h>         // for sockaddr_in, INADDR_LOOPBACK
+#include <poll.h>               // for poll, pollfd
+#include <sys/socket.h>         // for socket, bind, listen, accept
+#include <sys/stat.h>           // for chmod
+#include <unistd.h>             // for mkdtemp, close
+#include <atomic>               // for atomic
+#include <chrono>               // for steady_clock
+#include <cstdlib>              // for getenv, setenv
+#include <filesystem>           // for remove_all
+#include <fstream>              // for ofstream, ifstream
+#include <functional>           // for function
+#include <mutex>                // for mutex, lock_guard
+#include <string>               // for string, getline, to_string
+#include <thread>               // for thread, sleep_for
+#include <vector>               // for vector
+
+#include "check.hpp"            // for CHECK, CHECK_EQ
+#include "webNotifier.hpp"      // for WebNotifier
+
+typedef std::chrono::steady_clock Clock;
+
+//*********************************************************************
+//                      StubServer
+//*********************************************************************
+// A webserver on 127.0.0.1 that answers each request the way the test
+// tells it to, one connection at a time, and remembers what it was asked
+
+enum class Reply {
+    Length,         // 200 with a Content-Length body
+    Chunked,        // 200 with a chunked body and a trailer
+    Error,          // 500 with a Content-Length body
+    HangUp,         // Closes the connection without a word
+    Partial,        // Starts a response, then closes the connection
+    LengthClose,    // 200, then closes the connection without saying so
+};
+
+struct Request {
+    std::string path;
+    int connection;
+    Clock::time_point at;
+};
+
+class StubServer {
+public:
+    // How to answer the nth request, and how long to think about it first
+    explicit StubServer(std::function<Reply(int)> pReply, std::function<int(int)> pDelay = nullptr):
+        reply(std::move(pReply)), delay(std::move(pDelay))
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        CHECK(bind(listenFd, (sockaddr*)&addr, len) == 0);
+        CHECK(listen(listenFd, 4) == 0);
+        CHECK(getsockname(listenFd, (sockaddr*)&addr, &len) == 0);
+        port = ntohs(addr.sin_port);
+        thread = std::thread(&StubServer::serve, this);
+    }
+    ~StubServer() {
+        stopping = true;
+        thread.join();
+        close(listenFd);
+    }
+
+    [[nodiscard]] std::string url(const std::string& path) const {
+        return("http://127.0.0.1:" + std::to_string(port) + path);
+    }
+    std::vector<Request> getRequests() {
+        std::lock_guard<std::mutex> guard(lock);
+        return(requests);
+    }
+    int getConnections() {
+        std::lock_guard<std::mutex> guard(lock);
+        return(connections);
+    }
+
+private:
+    void serve() {
+        while(!stopping) {
+            pollfd pfd{listenFd, POLLIN, 0};
+            if(poll(&pfd, 1, 20) != 1)
+                continue;
+            int fd = accept(listenFd, nullptr, nullptr);
+            if(fd == -1)
+                continue;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                connections++;
+            }
+            handle(fd);
+            close(fd);
+        }
+    }
+
+    // Answers requests on one connection until it's closed, by either side
+    void handle(int fd) {
+        std::string buf;
+        while(!stopping) {
+            std::string::size_type end = buf.find("\r\n\r\n");
+            if(end == std::string::npos) {
+                pollfd pfd{fd, POLLIN, 0};
+                if(poll(&pfd, 1, 20) != 1)
+                    continue;
+                char chunk[4096];
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if(n <= 0)
+                    return;
+                buf.append(chunk, n);
+                continue;
+            }
+            std::string head = buf.substr(0, end);
+            buf.erase(0, end + 4);
+
+            int index;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                index = static_cast<int>(requests.size());
+                std::string::size_type start = head.find(' ') + 1;
+                requests.push_back(Request{head.substr(start, head.find(' ', start) - start), connections, Clock::now()});
+            }
+            if(delay)
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay(index)));
+
+            std::string body = "ok " + std::to_string(index);
+            switch(reply(index)) {
+                case Reply::Length:
+                case Reply::LengthClose:
+                    sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: "
+                        + std::to_string(body.length()) + "\r\n\r\n" + body);
+                    if(reply(index) == Reply::LengthClose)
+                        return;
+                    break;
+                case Reply::Chunked:
+                    sendAll(fd, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "3\r\nok \r\n" + std::to_string(std::to_string(index).length()) + "\r\n" + std::to_string(index)
+                        + "\r\n0\r\nX-Trailer: yes\r\n\r\n");
+                    break;
+                case Reply::Error:
+                    sendAll(fd, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 4\r\n\r\nsigh");
+                    break;
+                case Reply::HangUp:
+                    return;
+                case Reply::Partial:
+                    sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Le");
+                    return;
+            }
+        }
+    }
+
+    static void sendAll(int fd, const std::string& data) {
+        size_t done = 0;
+        while(done < data.length()) {
+            ssize_t n = send(fd, data.data() + done, data.length() - done, MSG_NOSIGNAL);
+            if(n <= 0)
+                return;
+            done += n;
+        }
+    }
+
+    std::function<Reply(int)> reply;
+    std::function<int(int)> delay;
+    int listenFd = -1;
+    int port = 0;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+    std::mutex lock;
+    std::vector<Request> requests;
+    int connections = 0;
+};
+
+static long msBetween(const Request& first, const Request& second) {
+    return(std::chrono::duration_cast<std::chrono::milliseconds>(second.at - first.at).count());
+}
+
+// Counts its runs in a file next to it and exits with the status it was given
+static void writeFakeWget(const std::string& dir, int exitStatus) {
+    std::string path = dir + "/wget";
+    std::ofstream out(path);
+    out << "#!/bin/sh\n"
+        << "echo \"$@\" >> " << dir << "/runs\n"
+        << "exit " << exitStatus << "\n";
+    out.close();
+    chmod(path.c_str(), 0755);
+    std::filesystem::remove(dir + "/runs");
+}
+
+static int countRuns(const std::string& dir) {
+    std::ifstream in(dir + "/runs");
+    std::string line;
+    int runs = 0;
+    while(std::getline(in, line))
+        runs++;
+    return(runs);
+}
+
+// Until the notifier is done with everything, or we give up on it
+static WebNotifier::Stats waitForQueue(WebNotifier& notifier, unsigned long finished) {
+    auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    WebNotifier::Stats stats;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stats = notifier.getStats();
+    } while(stats.sent + stats.failed < finished && std::chrono::steady_clock::now() < giveUp);
+    return(stats);
+}
+
+//*********************************************************************
+//                      keepAlive
+//*********************************************************************
+// One connection carries them all, whichever way each response is framed
+
+static void keepAlive() {
+    StubServer server([](int index) { return(index % 2 ? Reply::Chunked : Reply::Length); });
+    WebNotifier notifier;
+    for(int i = 0; i < 6; i++)
+        CHECK(notifier.notify(server.url("/mud.php?type=login&n=" + std::to_string(i)), "RealmsTest"));
+    WebNotifier::Stats stats = waitForQueue(notifier, 6);
+    CHECK_EQ(stats.sent, 6UL);
+    CHECK_EQ(stats.failed, 0UL);
+    CHECK_EQ(stats.retried, 0UL);
+    CHECK_EQ(stats.connects, 1UL);
+    CHECK_EQ(server.getConnections(), 1);
+
+    std::vector<Request> requests = server.getRequests();
+    CHECK_EQ(requests.size(), 6UL);
+    for(size_t i = 0; i < requests.size(); i++)
+        CHECK_EQ(requests[i].path, "/mud.php?type=login&n=" + std::to_string(i));
+}
+
+//*********************************************************************
+//                      burst
+//*********************************************************************
+// While the webserver is slow on the first one, the same url queued again
+// and again is sent once; past the queue's depth, the rest are dropped
+
+static void burst() {
+    StubServer server([](int) { return(Reply::Length); }, [](int index) { return(index ? 0 : 300); });
+    WebNotifier notifier(4);
+    CHECK(notifier.notify(server.url("/mud.php?type=slow"), ""));
+    auto giveUp = Clock::now() + std::chrono::seconds(5);
+    while(server.getRequests().empty() && Clock::now() < giveUp)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    for(int i = 0; i < 10; i++)
+        CHECK(notifier.notify(server.url("/mud.php?type=recent"), ""));
+    for(int i = 0; i < 3; i++)
+        CHECK(notifier.notify(server.url("/mud.php?type=post&n=" + std::to_string(i)), ""));
+    CHECK(!notifier.notify(server.url("/mud.php?type=overflow"), ""));
+    CHECK(notifier.notify(server.url("/mud.php?type=recent"), ""));
+
+    WebNotifier::Stats stats = waitForQueue(notifier, 5);
+    CHECK_EQ(stats.sent, 5UL);
+    CHECK_EQ(stats.coalesced, 10UL);
+    CHECK_EQ(stats.dropped, 1UL);
+    CHECK_EQ(stats.peakDepth, 4UL);
+    CHECK_EQ(server.getRequests().size(), 5UL);
+}
+
+//*********************************************************************
+//                      failures
+//*********************************************************************
+// A webserver that answers with an error, or hangs up, is tried again
+// after a backoff, then given up on
+
+static void failures(Reply how) {
+    StubServer server([how](int) { return(how); });
+    WebNotifier notifier(WEB_NOTIFY_MAX_DEPTH, 3);
+    CHECK(notifier.notify(server.url("/mud.php?type=fail"), ""));
+    WebNotifier::Stats stats = waitForQueue(notifier, 1);
+    CHECK_EQ(stats.sent, 0UL);
+    CHECK_EQ(stats.failed, 1UL);
+    CHECK_EQ(stats.retried, 2UL);
+
+    // Backing off 1s, then 2s
+    std::vector<Request> requests = server.getRequests();
+    CHECK_EQ(requests.size(), 3UL);
+    if(requests.size() == 3) {
+        CHECK(msBetween(requests[0], requests[1]) >= 900);
+        CHECK(msBetween(requests[1], requests[2]) >= 1900);
+    }
+}
+
+//*********************************************************************
+//                      resend
+//*********************************************************************
+// A kept-alive connection the webserver closed while it was idle is
+// replaced at once; one that died after it started answering is not, since
+// the webserver may already have done what was asked
+
+static void resend() {
+    {
+        StubServer server([](int index) { return(index ? Reply::Length : Reply::LengthClose); });
+        WebNotifier notifier;
+        CHECK(notifier.notify(server.url("/mud.php?type=first"), ""));
+        waitForQueue(notifier, 1);
+        CHECK(notifier.notify(server.url("/mud.php?type=second"), ""));
+        WebNotifier::Stats stats = waitForQueue(notifier, 2);
+        CHECK_EQ(stats.sent, 2UL);
+        CHECK_EQ(stats.retried, 0UL);
+        CHECK_EQ(stats.connects, 2UL);
+        CHECK_EQ(server.getRequests().size(), 2UL);
+    }
+    {
+        StubServer server([](int index) { return(index == 1 ? Reply::Partial : Reply::Length); });
+        WebNotifier notifier;
+        CHECK(notifier.notify(server.url("/mud.php?type=first"), ""));
+        waitForQueue(notifier, 1);
+        CHECK(notifier.notify(server.url("/mud.php?type=forum"), ""));
+        WebNotifier::Stats stats = waitForQueue(notifier, 2);
+        CHECK_EQ(stats.sent, 2UL);
+        CHECK_EQ(stats.retried, 1UL);
+        std::vector<Request> requests = server.getRequests();
+        CHECK_EQ(requests.size(), 3UL);
+        if(requests.size() == 3)
+            CHECK(msBetween(requests[1], requests[2]) >= 900);
+    }
+}
+
+//*********************************************************************
+//                      https
+//*********************************************************************
+
+static void https() {
+    char dirTemplate[] = "/tmp/webNotifierTestXXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string path = dir + ":" + (getenv("PATH") ? getenv("PATH") : "/bin:/usr/bin");
+    setenv("PATH", path.c_str(), 1);
+
+    // One successful request is one wget, not one per retry
+    writeFakeWget(dir, 0);
+    {
+        WebNotifier notifier(WEB_NOTIFY_MAX_DEPTH, 2);
+        CHECK(notifier.notify("https://webserver.invalid/notify?event=login", "RealmsTest"));
+        WebNotifier::Stats stats = waitForQueue(notifier, 1);
+        CHECK_EQ(stats.sent, 1UL);
+        CHECK_EQ(stats.failed, 0UL);
+        CHECK_EQ(stats.retried, 0UL);
+    }
+    CHECK_EQ(countRuns(dir), 1);
+
+    // And a wget that fails is tried again, as many times as we're allowed
+    writeFakeWget(dir, 4);
+    {
+        WebNotifier notifier(WEB_NOTIFY_MAX_DEPTH, 2);
+        CHECK(notifier.notify("https://webserver.invalid/notify?event=logout", ""));
+        WebNotifier::Stats stats = waitForQueue(notifier, 1);
+        CHECK_EQ(stats.sent, 0UL);
+        CHECK_EQ(stats.failed, 1UL);
+        CHECK_EQ(stats.retried, 1UL);
+    }
+    CHECK_EQ(countRuns(dir), 2);
+
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    keepAlive();
+    burst();
+    failures(Reply::Error);
+    failures(Reply::HangUp);
+    resend();
+    https();
+    return(checkResult());
+}
@@ -127,6 +127,20 @@ void Config::loadGeneral(xmlNodePtr rootNode) {
         else if(NODE_NAME(curNode, "Reviewer")) xml::copyToString(reviewer, curNode);
         else if(NODE_NAME(curNode, "ShopNumObjects")) xml::copyToNum(shopNumObjects, curNode);
         else if(NODE_NAME(curNode, "ShopNumLines")) xml::copyToNum(shopNumLines, curNode);
+        else if(NODE_NAME(curNode, "TickRate")) xml::copyToNum(tickRate, curNode);
+        else if(NODE_NAME(curNode, "CommandRate")) xml::copyToNum(commandRate, curNode);
+        else if(NODE_NAME(curNode, "CommandBurst")) xml::copyToNum(commandBurst, curNode);
+        else if(NODE_NAME(curNode, "StaffCommandRate")) xml::copyToNum(staffCommandRate, curNode);
+        else if(NODE_NAME(curNode, "StaffCommandBurst")) xml::copyToNum(staffCommandBurst, curNode);
+        else if(NODE_NAME(curNode, "MccpLevel")) xml::copyToNum(mccpLevel, curNode);
+        else if(NODE_NAME(curNode, "MccpWindow")) xml::copyToNum(mccpWindow, curNode);
+        else if(NODE_NAME(curNode, "MccpMemLevel")) xml::copyToNum(mccpMemLevel, curNode);
+        else if(NODE_NAME(curNode, "MccpBusyLevel")) xml::copyToNum(mccpBusyLevel, curNode);
+        else if(NODE_NAME(curNode, "MccpBusyWindow")) xml::copyToNum(mccpBusyWindow, curNode);
+        else if(NODE_NAME(curNode, "MccpBusyMemLevel")) xml::copyToNum(mccpBusyMemLevel, curNode);
+        else if(NODE_NAME(curNode, "MccpBusyAfter")) xml::copyToNum(mccpBusyAfter, curNode);
+        else if(NODE_NAME(curNode, "MccpIdle")) xml::copyToNum(mccpIdle, curNode);
+        else if(NODE_NAME(curNode, "MccpThread")) xml::copyToBool(mccpThread, curNode);
         else if(NODE_NAME(curNode, "CustomColors")) xml::copyToCString(customColors, curNode);
         else if(NODE_NAME(curNode, "MaxDouble")) xml::copyToNum(maxDouble, curNode);
         else if(!bHavePort && NODE_NAME(curNode, "Port")) xml::copyToNum(portNum, curNode);
@@ -227,6 +241,20 @@ bool Config::saveConfig() const {
 
     xml::newBoolChild(curNode, "AprilFools", doAprilFools);
     xml::saveNonZeroNum(curNode, "FlashPolicyPort", flashPolicyPort);
+    xml::saveNonZeroNum(curNode, "TickRate", tickRate);
+    xml::saveNonZeroNum(curNode, "CommandRate", commandRate);
+    xml::saveNonZeroNum(curNode, "CommandBurst", commandBurst);
+    xml::saveNonZeroNum(curNode, "StaffCommandRate", staffCommandRate);
+    xml::saveNonZeroNum(curNode, "StaffCommandBurst", staffCommandBurst);
+    xml::saveNonZeroNum(curNode, "MccpLevel", mccpLevel);
+    xml::saveNonZeroNum(curNode, "MccpWindow", mccpWindow);
+    xml::saveNonZeroNum(curNode, "MccpMemLevel", mccpMemLevel);
+    xml::saveNonZeroNum(curNode, "MccpBusyLevel", mccpBusyLevel);
+    xml::saveNonZeroNum(curNode, "MccpBusyWindow", mccpBusyWindow);
+    xml::saveNonZeroNum(curNode, "MccpBusyMemLevel", mccpBusyMemLevel);
+    xml::saveNonZeroNum(curNode, "MccpBusyAfter", mccpBusyAfter);
+    xml::saveNonZeroNum(curNode, "MccpIdle", mccpIdle);
+    xml::newBoolChild(curNode, "MccpThread", mccpThread);
     xml::newBoolChild(curNode, "AutoShutdown", autoShutdown);
     xml::newBoolChild(curNode, "CharCreationDisabled", charCreationDisabled);
     xml::newBoolChild(curNode, "CheckDouble", checkDouble);
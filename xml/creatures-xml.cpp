@@ -413,8 +413,7 @@ void Creature::loadSkills(xmlNodePtr rootNode) {
     while(curNode) {
         if(NODE_NAME(curNode, "Skill")) {
             try {
-                auto *skill = new Skill(curNode);
-                skills.insert(SkillMap::value_type(skill->getName(), skill));
+                insertSkill(new Skill(curNode));
             } catch(...) {
                 std::clog << "Error loading skill for " << getName() << std::endl;
             }
@@ -39,6 +39,8 @@ void Effects::load(xmlNodePtr rootNode, MudObject* pParent) {
                 auto* newEffect = new EffectInfo(curNode);
                 newEffect->setParent(pParent);
                 effectList.push_back(newEffect);
+                addEffectBits(newEffect);
+                newEffect->schedule();
             } catch(std::runtime_error &e) {
                 std::clog << "Error adding effect: " << e.what() << std::endl;
             }
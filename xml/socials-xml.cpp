@@ -65,6 +65,7 @@ bool Config::loadSocials() {
     }
     xmlFreeDoc(xmlDoc);
     xmlCleanupParser();
+    indexCommands();
     return(true);
 }
 
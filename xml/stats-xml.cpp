@@ -17,7 +17,6 @@
  */
 
 #include <boost/lexical_cast/bad_lexical_cast.hpp>  // for bad_lexical_cast
-#include <map>                                      // for operator==, _Rb_t...
 #include <ostream>                                  // for basic_ostream::op...
 #include <stats.hpp>                                // for StatModifier, Stat
 #include <string>                                   // for allocator, string
@@ -33,7 +32,7 @@
 
 bool Stat::load(xmlNodePtr curNode, std::string_view statName) {
     xmlNodePtr childNode = curNode->children;
-    name = statName;
+    setName(statName);
     while(childNode) {
         if(NODE_NAME(childNode, "Current")) xml::copyToNum(cur, childNode);
         else if(NODE_NAME(childNode, "Max")) xml::copyToNum(max, childNode);
@@ -49,10 +48,10 @@ bool Stat::loadModifiers(xmlNodePtr curNode) {
     while(childNode) {
         if(NODE_NAME(childNode, "StatModifier")) {
             auto* mod = new StatModifier(childNode);
-            if(mod->getName().empty()) {
+            if(mod->getName().empty() || getModifier(mod->getId())) {
                 delete mod;
             } else {
-                modifiers.insert(ModifierMap::value_type(mod->getName(), mod));
+                modifiers.push_back(mod);
             }
             childNode = childNode->next;
         }
@@ -69,6 +68,7 @@ StatModifier::StatModifier(xmlNodePtr curNode) {
 
         childNode = childNode->next;
     }
+    id = getModifierId(name);
 }
 
 //*********************************************************************
@@ -81,8 +81,8 @@ void Stat::save(xmlNodePtr parentNode, const char* statName) const {
 
     xml::newNumChild(curNode, "Initial", initial);
     xmlNodePtr modNode = xml::newStringChild(curNode, "Modifiers");
-    for(ModifierMap::value_type p: modifiers) {
-        p.second->save(modNode);
+    for(StatModifier* mod : getSortedModifiers()) {
+        mod->save(modNode);
     }
 }
 